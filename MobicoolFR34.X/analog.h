@@ -1,7 +1,13 @@
 #ifndef ANALOG_H
 #define	ANALOG_H
 
-void AnalogUpdate(void);
+#include <stdbool.h>
+#include <stdint.h>
+
+void AnalogInitialize(void);
+bool AnalogUpdate(void); // Returns true when a new set of readings was published
+void AnalogSuspend(void); // Stop pacing conversions and power the ADC down
+void AnalogResume(void);  // Start a fresh acquisition round
 int16_t AnalogGetTemperature10(void);
 uint16_t AnalogGetVoltage(void);
 uint16_t AnalogGetFanCurrent(void);
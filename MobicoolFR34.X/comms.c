@@ -1,113 +1,278 @@
 #include "comms.h"
 #include "analog.h"
+#include "energy.h"
+#include "history.h"
+#include "events.h"
+#include "effmap.h"
+#include "cycles.h"
+#include "settings.h"
+#include "crc8.h"
+#include "scheduler.h"
+#include "mcc_generated_files/mcc.h"
+#include "mcc_generated_files/tmr0.h"
+#include "mcc_generated_files/pin_manager.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 // ── Timing ────────────────────────────────────────────────────────────────
-// 1 MHz instruction clock, TMR0 1:4 prescaler → 4 µs / tick
-// 9600 baud → 104.17 µs / bit → 26 ticks / bit
-#define BIT_TIME          26
-#define HALF_BIT_TIME     13
-// Turnaround guard: PIC waits this many bit-times before responding,
+// TMR0 counts instruction cycles through its 1:4 prescaler, so a tick is
+// 4 µs at 4 MHz and 0.5 µs at 32 MHz.  9600 baud at 4 MHz is 26 ticks a
+// bit; the slowest profile at 32 MHz, 208, still fits the 8-bit timer.
+#define TICK_CYCLES       4
+#define BIT_TICKS(baud)   ((uint8_t)((_XTAL_FREQ / 4 / TICK_CYCLES + (baud) / 2) / (baud)))
+// Turnaround guard: PIC waits at least this long before responding,
 // giving the ESP32 time to switch from TX to INPUT_PULLUP (~300 µs).
-#define TURNAROUND_BITS   4   // 4 × 104 µs = 416 µs
+#define TURNAROUND_US     400
+#define GUARD_BITS(baud)  ((uint8_t)((TURNAROUND_US * (uint32_t)(baud) + 999999UL) / 1000000UL))
+
+// TMR0 is reloaded additively inside the bit interrupt so the ticks already
+// spent on interrupt latency are kept.  The extra tick covers the prescaler
+// clear and the 2-cycle increment inhibit that every TMR0 write costs.
+#define BIT_RELOAD(ticks) ((uint8_t)(256 - (ticks) + 1))
+// From the IOC edge to the first TMR0 write takes roughly 12 cycles (3 ticks)
+// of vectoring and dispatch; the first sample lands mid start bit.
+#define IOC_LATENCY       3
+#define START_RELOAD(ticks) ((uint8_t)(256 - (ticks) / 2 + IOC_LATENCY))
+
+// A profile is offered when a bit lasts COMMS_MIN_BIT_CYCLES or more
+#define BAUD_BIT(baud, n) ((_XTAL_FREQ / 4 / (baud) >= COMMS_MIN_BIT_CYCLES) ? (1U << (n)) : 0U)
+#define BAUD_MASK         ((uint8_t)(BAUD_BIT(9600, COMMS_BAUD_9600) | BAUD_BIT(19200, COMMS_BAUD_19200) | \
+                                     BAUD_BIT(38400, COMMS_BAUD_38400) | BAUD_BIT(57600, COMMS_BAUD_57600)))
+
+typedef struct {
+    uint8_t bit_reload;
+    uint8_t start_reload;
+    uint8_t guard_bits;
+} baud_profile_t;
+
+#define PROFILE(baud) { BIT_RELOAD(BIT_TICKS(baud)), START_RELOAD(BIT_TICKS(baud)), GUARD_BITS(baud) }
+static const baud_profile_t s_profiles[COMMS_BAUD_COUNT] = {
+    PROFILE(9600), PROFILE(19200), PROFILE(38400), PROFILE(57600)
+};
+
+// Comms_Process() calls without a valid frame before a faster profile is
+// given up for 9600
+#define BAUD_FALLBACK     (COMMS_BAUD_FALLBACK_MS / SCHED_TICK_MS)
+
+// Frame receive timeout in Comms_Process() calls (one per scheduler tick)
+#define FRAME_TIMEOUT     5
+
+// ── Buffers ───────────────────────────────────────────────────────────────
+// The ring takes a v2 frame that arrives while a long task holds up
+// Comms_Process() for most of a second tick
+#define RX_RING_SIZE      32  // power of two
+#define RX_RING_MASK      (RX_RING_SIZE - 1)
+#define TX_BUF_SIZE       (COMMS_MAX_RESPONSE + 5)  // v2: [SYNC][SEQ][FLAGS][LEN] + payload + [CRC8]
 
 // ── State ─────────────────────────────────────────────────────────────────
 static int16_t targetTemperature  = 50;   // Default 5.0 °C (tenths)
 static uint8_t compressorPower    = 0;    // Default 0 % (auto)
 static uint8_t compressorMaxPower = 100;  // Default 100 %
 static uint8_t powerMode          = 1;    // Default PMODE_NORMAL
-
-// ── Timer0 initialisation ─────────────────────────────────────────────────
-// Same configuration as the former comms code — TMR0 is shared for bit timing.
-static void Timer0_Initialize(void) {
-    OPTION_REGbits.TMR0CS = 0;      // Internal clock (FOSC/4)
-    OPTION_REGbits.PSA    = 0;      // Prescaler assigned to TMR0
-    OPTION_REGbits.PS     = 0b001;  // 1:4 prescaler
-    TMR0 = 0;
-}
-
-// ── CRC8 (simple XOR of all bytes) ────────────────────────────────────────
-static uint8_t crc8(const uint8_t *buf, uint8_t len) {
-    uint8_t crc = 0;
-    while (len--) crc ^= *buf++;
-    return crc;
-}
-
-// ── Open-drain TX helpers ─────────────────────────────────────────────────
+static comms_perf_handler_t perfHandler = NULL;
+
+// Line state, owned by the IOC / TMR0 interrupts
+typedef enum {
+    LINK_IDLE,      // waiting for a start bit edge
+    LINK_RX,        // sampling a byte
+    LINK_GUARD,     // turnaround guard before a response
+    LINK_TX         // shifting out the response
+} link_state_t;
+
+static volatile link_state_t s_link = LINK_IDLE;
+static uint8_t s_bitn;          // bit position within the current byte
+static uint8_t s_shift;         // byte being received / sent
+
+// Active link speed, changed only while the line is idle
+static uint8_t s_bit_reload;
+static uint8_t s_start_reload;
+static uint8_t s_guard_bits;
+static uint8_t s_baud;          // COMMS_BAUD_* in use
+static uint8_t s_baud_next;     // Profile to switch to after the response
+static uint16_t s_baud_quiet;   // Comms_Process() calls since the last good frame
+
+static uint8_t s_rxring[RX_RING_SIZE];
+static volatile uint8_t s_rxhead;   // written by ISR
+static uint8_t s_rxtail;            // written by Comms_Process
+
+static uint8_t s_txbuf[TX_BUF_SIZE];
+static uint8_t s_txlen;
+static uint8_t s_txpos;
+
+// Frame parser, owned by Comms_Process
+typedef enum {
+    FRAME_SYNC,
+    FRAME_SEQ,      // v2 only
+    FRAME_CMD,
+    FRAME_LEN,
+    FRAME_PAYLOAD,
+    FRAME_CRC
+} frame_state_t;
+
+static frame_state_t s_frame = FRAME_SYNC;
+static uint8_t s_cmd;
+static uint8_t s_len;
+static uint8_t s_pos;
+static uint8_t s_crc;
+static uint8_t s_payload[COMMS_MAX_PAYLOAD];
+static uint8_t s_idle;
+static bool s_v2;               // Frame being parsed / answered is v2
+static uint8_t s_seq;
+static uint8_t s_flags;         // v2 FLAGS for the response being built
+
+// Last v2 exchange, for answering a retry from s_txbuf
+static bool s_replay;
+static uint8_t s_lastseq;
+static uint8_t s_lastcmd;
+
+// ── Line interrupts ───────────────────────────────────────────────────────
 // LATA0 is permanently 0 (set at init).  Direction controls the line level:
 //   TRISA0 = 0 → output drives 0 (pull low)
 //   TRISA0 = 1 → input/hi-Z, pullup holds line high
 
-// Transmit one byte (8N1).  Leaves TRISA0=1 (hi-Z) after stop bit.
-static void comms_tx_byte(uint8_t data) {
-    uint8_t t = (uint8_t)TMR0;
-
-    // Start bit (pull low)
-    COMMS_TRIS = 0;
-    t += BIT_TIME;
-    while ((uint8_t)TMR0 != t);
-
-    // 8 data bits, LSB first
-    for (uint8_t i = 0; i < 8; i++) {
-        COMMS_TRIS = (data & 0x01) ? 1 : 0;
-        data >>= 1;
-        t += BIT_TIME;
-        while ((uint8_t)TMR0 != t);
-    }
+static void comms_set_baud(uint8_t profile) {
+    const baud_profile_t* p = &s_profiles[profile];
+    s_bit_reload = p->bit_reload;
+    s_start_reload = p->start_reload;
+    s_guard_bits = p->guard_bits;
+    s_baud = profile;
+    s_baud_next = profile;
+    s_baud_quiet = 0;
+}
 
-    // Stop bit (release → high)
+// Back to listening: bit timer off, falling-edge detector armed.
+static void comms_listen(void) {
+    INTCONbits.TMR0IE = 0;
     COMMS_TRIS = 1;
-    t += BIT_TIME;
-    while ((uint8_t)TMR0 != t);
+    IOCAFbits.IOCAF0 = 0;
+    IOCANbits.IOCAN0 = 1;
+    s_link = LINK_IDLE;
 }
 
-// ── RX helper ─────────────────────────────────────────────────────────────
-// Block-waits for a start bit up to `timeout_ticks` TMR0 ticks, then
-// reads a full 8N1 byte.  Returns false on timeout or framing error.
-static bool comms_rx_byte(uint8_t *data, uint8_t timeout_ticks) {
-    uint8_t t0 = (uint8_t)TMR0;
+// Falling edge on RA0: potential start bit.  Hand over to the bit timer.
+static void comms_edge_isr(void) {
+    TMR0 = s_start_reload;
+    IOCANbits.IOCAN0 = 0;
+    INTCONbits.TMR0IF = 0;
+    INTCONbits.TMR0IE = 1;
+    s_bitn = 0;
+    s_link = LINK_RX;
+}
 
-    // Wait for falling edge (start bit)
-    while (COMMS_PIN != 0) {
-        if ((uint8_t)((uint8_t)TMR0 - t0) >= timeout_ticks) return false;
+static void comms_rx_bit(void) {
+    uint8_t level = COMMS_PIN;
+
+    if (s_bitn == 0) {
+        // Centre of start bit
+        if (level) { comms_listen(); return; }  // glitch — not a real start bit
+    } else if (s_bitn <= 8) {
+        s_shift >>= 1;
+        if (level) s_shift |= 0x80;
+    } else {
+        // Centre of stop bit; drop the byte on a framing error or full ring
+        uint8_t next = (s_rxhead + 1) & RX_RING_MASK;
+        if (level && next != s_rxtail) {
+            s_rxring[s_rxhead] = s_shift;
+            s_rxhead = next;
+        }
+        comms_listen();
+        return;
     }
+    s_bitn++;
+}
 
-    // Sample at centre of start bit
-    uint8_t t = (uint8_t)TMR0 + HALF_BIT_TIME;
-    while ((uint8_t)TMR0 != t);
-    if (COMMS_PIN != 0) return false; // glitch — not a real start bit
+// One call per bit period: drive the level for bit s_bitn of s_txbuf[s_txpos].
+// Bit 0 is the start bit, 1-8 are data LSB first, 9 is the stop bit.
+static void comms_tx_bit(void) {
+    if (s_bitn == 0) {
+        if (s_txpos == s_txlen) {                       // last stop bit done
+            if (s_baud_next != s_baud) comms_set_baud(s_baud_next);
+            comms_listen();
+            return;
+        }
+        s_shift = s_txbuf[s_txpos];
+        COMMS_TRIS = 0;
+    } else if (s_bitn <= 8) {
+        COMMS_TRIS = (s_shift & 0x01) ? 1 : 0;
+        s_shift >>= 1;
+    } else {
+        COMMS_TRIS = 1;
+        s_txpos++;
+        s_bitn = 0;
+        return;
+    }
+    s_bitn++;
+}
 
-    // Advance to centre of first data bit
-    t += BIT_TIME;
+static void comms_bit_isr(void) {
+    TMR0 += s_bit_reload;
 
-    uint8_t d = 0;
-    for (uint8_t i = 0; i < 8; i++) {
-        while ((uint8_t)TMR0 != t);
-        d >>= 1;
-        if (COMMS_PIN) d |= 0x80;
-        t += BIT_TIME;
+    switch (s_link) {
+        case LINK_RX:
+            comms_rx_bit();
+            break;
+        case LINK_GUARD:
+            if (--s_bitn == 0) s_link = LINK_TX;
+            break;
+        case LINK_TX:
+            comms_tx_bit();
+            break;
+        default:
+            INTCONbits.TMR0IE = 0;
+            break;
     }
+}
 
-    // Verify stop bit
-    while ((uint8_t)TMR0 != t);
-    if (COMMS_PIN == 0) return false; // framing error
-
-    *data = d;
-    return true;
+// Start sending s_txbuf[0..len) after the turnaround guard.  The edge detector
+// stays off until the last stop bit so the PIC never hears its own reply.
+static void comms_tx_start(uint8_t len) {
+    IOCANbits.IOCAN0 = 0;
+    s_txlen = len;
+    s_txpos = 0;
+    s_bitn = s_guard_bits;
+    s_link = LINK_GUARD;
+    TMR0 = s_bit_reload;
+    INTCONbits.TMR0IF = 0;
+    INTCONbits.TMR0IE = 1;
 }
 
 // ── Response helpers ──────────────────────────────────────────────────────
+// v1 frames check with XOR, v2 frames with CRC-8
+static uint8_t comms_crc(uint8_t crc, uint8_t b) {
+    return s_v2 ? Crc8(crc, b) : (uint8_t)(crc ^ b);
+}
+
+static uint8_t comms_frame_crc(const uint8_t *buf, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) crc = comms_crc(crc, *buf++);
+    return crc;
+}
+
 static void comms_respond(const uint8_t *payload, uint8_t len) {
-    // Frame: [LEN] [PAYLOAD...] [CRC8]
-    uint8_t crc = len;
-    comms_tx_byte(len);
+    // v1 frame: [LEN] [PAYLOAD...] [CRC8]
+    // v2 frame: [SYNC] [SEQ] [FLAGS] [LEN] [PAYLOAD...] [CRC8]
+    uint8_t n = 0;
+    if (s_v2) {
+        s_txbuf[n++] = COMMS_SYNC_V2;
+        s_txbuf[n++] = s_seq;
+        s_txbuf[n++] = Events_Pending() ? (uint8_t)(s_flags | COMMS_FLAG_EVENT) : s_flags;
+    }
+    s_txbuf[n++] = len;
     for (uint8_t i = 0; i < len; i++) {
-        crc ^= payload[i];
-        comms_tx_byte(payload[i]);
+        s_txbuf[n++] = payload[i];
     }
-    comms_tx_byte(crc);
-    // Ensure pin left as input (hi-Z) — already done by comms_tx_byte stop bit
-    COMMS_TRIS = 1;
+    s_txbuf[n] = comms_frame_crc(s_txbuf, n);
+    s_replay = s_v2;
+    comms_tx_start(n + 1);
+}
+
+// Send the stored v2 response again, marked as such
+static void comms_replay(void) {
+    s_txbuf[2] |= COMMS_FLAG_DUP;
+    s_txbuf[2] &= (uint8_t)~COMMS_FLAG_EVENT;
+    if (Events_Pending()) s_txbuf[2] |= COMMS_FLAG_EVENT;
+    s_txbuf[s_txlen - 1] = comms_frame_crc(s_txbuf, s_txlen - 1);
+    comms_tx_start(s_txlen);
 }
 
 static void comms_respond_ack(void) {
@@ -117,117 +282,413 @@ static void comms_respond_ack(void) {
 
 static void comms_respond_nak(void) {
     uint8_t nak = COMMS_NAK;
+    s_flags |= COMMS_FLAG_ERR;
     comms_respond(&nak, 1);
 }
 
+// ── Settings ──────────────────────────────────────────────────────────────
+// A setting is named by its single-setting command, which is also its tag in
+// a COMMS_CMD_SET item.  Returns the value size, 0 for anything else.
+static uint8_t setting_size(uint8_t tag) {
+    switch (tag) {
+        case COMMS_CMD_SET_TEMP:  return 2;
+        case COMMS_CMD_SET_POWER:
+        case COMMS_CMD_SET_PMAX:
+        case COMMS_CMD_SET_PMODE: return 1;
+        default:                  return 0;
+    }
+}
+
+static bool setting_valid(uint8_t tag, const uint8_t *value, uint8_t len) {
+    uint8_t size = setting_size(tag);
+    if (size == 0 || len < size) return false;
+    switch (tag) {
+        case COMMS_CMD_SET_TEMP: {
+            int16_t temp = (int16_t)((uint16_t)value[0] | ((uint16_t)value[1] << 8));
+            return temp >= MIN_TEMP * 10 && temp <= MAX_TEMP * 10;
+        }
+        case COMMS_CMD_SET_POWER:
+        case COMMS_CMD_SET_PMAX:  return value[0] <= 100;
+        case COMMS_CMD_SET_PMODE: return value[0] <= 2;
+        default:                  return false;
+    }
+}
+
+static void setting_apply(uint8_t tag, const uint8_t *value) {
+    switch (tag) {
+        case COMMS_CMD_SET_TEMP:
+            targetTemperature = (int16_t)((uint16_t)value[0] | ((uint16_t)value[1] << 8));
+            break;
+        case COMMS_CMD_SET_POWER:
+            compressorPower = value[0];     // Checked against the PMAX in effect
+            break;
+        case COMMS_CMD_SET_PMAX:
+            compressorMaxPower = value[0];
+            if (compressorPower > compressorMaxPower)
+                compressorPower = compressorMaxPower;
+            break;
+        case COMMS_CMD_SET_PMODE:
+            powerMode = value[0];
+            break;
+    }
+}
+
+// Walk the TLV items of a SET payload; with apply false only check them.
+// A POWER item may not exceed the PMAX the whole payload leaves in effect,
+// wherever the two stand in it.
+static bool settings_walk(const uint8_t *payload, uint8_t len, bool apply) {
+    uint8_t pmax = compressorMaxPower;
+    uint8_t power = 0;
+    uint8_t pos = 0;
+    while (pos < len) {
+        if (len - pos < 2) return false;
+        uint8_t tag = payload[pos];
+        uint8_t size = payload[pos + 1];
+        const uint8_t *value = &payload[pos + 2];
+        pos += 2;
+        if (size > len - pos || size != setting_size(tag)) return false;
+        if (!setting_valid(tag, value, size)) return false;
+        if (tag == COMMS_CMD_SET_PMAX) pmax = value[0];
+        if (tag == COMMS_CMD_SET_POWER && value[0] > power) power = value[0];
+        if (apply) setting_apply(tag, value);
+        pos += size;
+    }
+    return power <= pmax;
+}
+
+// GET response payload, see comms.h
+#define TELEMETRY_SIZE 11
+static void telemetry(uint8_t *resp) {
+    int16_t  temp = AnalogGetTemperature10();
+    int16_t  setp = targetTemperature;
+    uint16_t volt = AnalogGetVoltage();
+    uint16_t fanc = AnalogGetFanCurrent();
+    resp[0]  = (uint8_t)(temp);
+    resp[1]  = (uint8_t)((uint16_t)temp >> 8);
+    resp[2]  = (uint8_t)(setp);
+    resp[3]  = (uint8_t)((uint16_t)setp >> 8);
+    resp[4]  = (uint8_t)(volt);
+    resp[5]  = (uint8_t)(volt >> 8);
+    resp[6]  = (uint8_t)(fanc);
+    resp[7]  = (uint8_t)(fanc >> 8);
+    resp[8]  = compressorPower;
+    resp[9]  = compressorMaxPower;
+    resp[10] = powerMode;
+}
+
+// ── Delta telemetry ───────────────────────────────────────────────────────
+// Field n of the GET payload starts at s_field_at[n] and ends at s_field_at[n + 1]
+static const uint8_t s_field_at[COMMS_DELTA_FIELDS + 1] = { 0, 2, 4, 6, 8, 9, 10, 11 };
+
+static uint8_t s_delta_base[TELEMETRY_SIZE];    // Snapshot s_delta_base_id
+static uint8_t s_delta_sent[TELEMETRY_SIZE];    // The base plus the fields sent as s_delta_id
+static uint8_t s_delta_base_id;
+static uint8_t s_delta_id;
+static uint16_t s_deadband[COMMS_DELTA_FIELDS] = {
+    COMMS_DELTA_TEMP_DB, 0, COMMS_DELTA_VOLT_DB * 10, COMMS_DELTA_FAN_DB * 10, 0, 0, 0
+};
+
+static bool field_moved(uint8_t n, const uint8_t *now, const uint8_t *was) {
+    uint8_t at = s_field_at[n];
+    if (s_field_at[n + 1] - at == 1) return now[at] != was[at];
+    uint16_t d = (uint16_t)((now[at] | now[at + 1] << 8) - (was[at] | was[at + 1] << 8));
+    if (d & 0x8000) d = (uint16_t)-d;
+    return d != 0 && d >= s_deadband[n];
+}
+
+// Build a GET_DELTA response in resp; returns its length
+static uint8_t delta(uint8_t ack, uint8_t *resp) {
+    uint8_t now[TELEMETRY_SIZE];
+    telemetry(now);
+
+    bool full = ack == 0;
+    if (ack == s_delta_id && ack != 0) {
+        for (uint8_t i = 0; i < TELEMETRY_SIZE; i++) s_delta_base[i] = s_delta_sent[i];
+        s_delta_base_id = ack;
+    } else if (ack != s_delta_base_id) {
+        full = true;
+    }
+    if (full) s_delta_base_id = 0;  // Nothing the master holds is known any more
+
+    if (++s_delta_id == 0) s_delta_id = 1;
+    uint8_t map = 0;
+    uint8_t n = 2;
+    for (uint8_t f = 0; f < COMMS_DELTA_FIELDS; f++) {
+        uint8_t at = s_field_at[f];
+        uint8_t end = s_field_at[f + 1];
+        if (full || field_moved(f, now, s_delta_base)) {
+            map |= (uint8_t)(1 << f);
+            for (; at < end; at++) resp[n++] = s_delta_sent[at] = now[at];
+        } else {
+            for (; at < end; at++) s_delta_sent[at] = s_delta_base[at];
+        }
+    }
+    resp[0] = s_delta_id;
+    resp[1] = map;
+    return n;
+}
+
 // ── Command dispatcher ────────────────────────────────────────────────────
 static void comms_handle(uint8_t cmd, const uint8_t *payload, uint8_t len) {
     switch (cmd) {
 
         case COMMS_CMD_GET: {
-            int16_t  temp = AnalogGetTemperature10();
-            int16_t  setp = targetTemperature;
-            uint16_t volt = AnalogGetVoltage();
-            uint16_t fanc = AnalogGetFanCurrent();
-            uint8_t resp[11] = {
-                (uint8_t)(temp),         (uint8_t)((uint16_t)temp >> 8),
-                (uint8_t)(setp),         (uint8_t)((uint16_t)setp >> 8),
-                (uint8_t)(volt),         (uint8_t)(volt >> 8),
-                (uint8_t)(fanc),         (uint8_t)(fanc >> 8),
-                compressorPower,
-                compressorMaxPower,
-                powerMode
-            };
+            uint8_t resp[TELEMETRY_SIZE];
+            telemetry(resp);
             comms_respond(resp, sizeof(resp));
             break;
         }
 
-        case COMMS_CMD_SET_TEMP: {
-            if (len < 2) { comms_respond_nak(); break; }
-            int16_t t = (int16_t)((uint16_t)payload[0] | ((uint16_t)payload[1] << 8));
-            targetTemperature = t;
+        case COMMS_CMD_SET_TEMP:
+        case COMMS_CMD_SET_POWER:
+        case COMMS_CMD_SET_PMAX:
+        case COMMS_CMD_SET_PMODE: {
+            if (!setting_valid(cmd, payload, len) ||
+                (cmd == COMMS_CMD_SET_POWER && payload[0] > compressorMaxPower)) {
+                comms_respond_nak();
+                break;
+            }
+            setting_apply(cmd, payload);
             comms_respond_ack();
             break;
         }
 
-        case COMMS_CMD_SET_POWER: {
-            if (len < 1 || payload[0] > 100) { comms_respond_nak(); break; }
-            Comms_SetCompressorPower(payload[0]);
-            comms_respond_ack();
+        case COMMS_CMD_SET: {
+            if (!settings_walk(payload, len, false)) { comms_respond_nak(); break; }
+            settings_walk(payload, len, true);
+            uint8_t resp[TELEMETRY_SIZE];
+            telemetry(resp);
+            comms_respond(resp, sizeof(resp));
             break;
         }
 
-        case COMMS_CMD_SET_PMAX: {
-            if (len < 1 || payload[0] > 100) { comms_respond_nak(); break; }
-            compressorMaxPower = payload[0];
-            if (compressorPower > compressorMaxPower)
-                compressorPower = compressorMaxPower;
-            comms_respond_ack();
+        case COMMS_CMD_VERSION: {
+            uint8_t resp[3] = { COMMS_PROTOCOL_VERSION, COMMS_MAX_PAYLOAD, COMMS_MAX_RESPONSE };
+            comms_respond(resp, sizeof(resp));
             break;
         }
 
-        case COMMS_CMD_SET_PMODE: {
-            if (len < 1 || payload[0] > 2) { comms_respond_nak(); break; }
-            powerMode = payload[0];
+        case COMMS_CMD_GET_DELTA: {
+            if (len != 1 && len != 4) { comms_respond_nak(); break; }
+            if (len == 4) {
+                s_deadband[0] = payload[1];
+                s_deadband[2] = payload[2] * 10U;
+                s_deadband[3] = payload[3] * 10U;
+            }
+            uint8_t resp[2 + TELEMETRY_SIZE];
+            comms_respond(resp, delta(payload[0], resp));
+            break;
+        }
+
+        case COMMS_CMD_GET_EVENTS: {
+            event_t ev[COMMS_EVENTS_PER_RESPONSE];
+            uint8_t resp[2 + 2 * COMMS_EVENTS_PER_RESPONSE];
+            uint8_t n = Events_Drain(ev, COMMS_EVENTS_PER_RESPONSE);
+            resp[0] = Events_Count();
+            resp[1] = Events_TakeLost();
+            for (uint8_t i = 0; i < n; i++) {
+                resp[2 + 2 * i] = ev[i].type;
+                resp[3 + 2 * i] = ev[i].arg;
+            }
+            comms_respond(resp, (uint8_t)(2 + 2 * n));
+            break;
+        }
+
+        case COMMS_CMD_SET_BAUD: {
+            if (len == 0) {
+                uint8_t mask = BAUD_MASK;
+                comms_respond(&mask, 1);
+                break;
+            }
+            if (payload[0] >= COMMS_BAUD_COUNT || !(BAUD_MASK & (1U << payload[0]))) {
+                comms_respond_nak();
+                break;
+            }
+            s_baud_next = payload[0];   // taken up once the ACK is out
             comms_respond_ack();
             break;
         }
 
+        case COMMS_CMD_GET_PERF: {
+            uint8_t page[COMMS_MAX_RESPONSE];
+            uint8_t n = (len >= 1 && perfHandler) ? perfHandler(payload[0], page) : 0;
+            if (n == 0) { comms_respond_nak(); break; }
+            comms_respond(page, n);
+            break;
+        }
+
+        case COMMS_CMD_GET_ENERGY: {
+            const energy_counters_t* e = Energy_Get();
+            const uint32_t counters[4] = { e->comp_wh, e->total_wh, e->run_seconds, e->starts };
+            uint8_t resp[16];
+            for (uint8_t i = 0; i < 4; i++) {
+                uint32_t v = counters[i];
+                for (uint8_t k = 0; k < 4; k++) {
+                    resp[4 * i + k] = (uint8_t)v;
+                    v >>= 8;
+                }
+            }
+            comms_respond(resp, sizeof(resp));
+            break;
+        }
+
+#if HISTORY_ENABLE
+        case COMMS_CMD_GET_HISTORY: {
+            uint8_t page[HISTORY_PAGE_SIZE];
+            uint8_t n = len >= 1 ? History_GetPage(payload[0], page) : 0;
+            if (n == 0) { comms_respond_nak(); break; }
+            comms_respond(page, n);
+            break;
+        }
+#endif
+
+#if CYCLES_ENABLE
+        case COMMS_CMD_GET_CYCLES: {
+            uint8_t resp[CYCLES_STATUS_SIZE];
+            comms_respond(resp, Cycles_GetStatus(resp));
+            break;
+        }
+#endif
+
+#if EFFMAP_ENABLE
+        case COMMS_CMD_EFFMAP: {
+            uint8_t op = len >= 1 ? payload[0] : 0xFF;
+            if (op == COMMS_EFFMAP_STATUS) {
+                uint8_t resp[EFFMAP_STATUS_SIZE];
+                comms_respond(resp, EffMap_GetStatus(resp));
+            } else if (op == COMMS_EFFMAP_MAP) {
+                comms_respond((const uint8_t*)EffMap_Get(), sizeof(effmap_t));
+            } else if (op == COMMS_EFFMAP_START && EffMap_Start()) {
+                comms_respond_ack();
+            } else if (op == COMMS_EFFMAP_ABORT) {
+                EffMap_Abort();
+                comms_respond_ack();
+            } else if (op == COMMS_EFFMAP_CLEAR) {
+                EffMap_Clear();
+                comms_respond_ack();
+            } else {
+                comms_respond_nak();
+            }
+            break;
+        }
+#endif
+
         default:
-            break; // unknown command — no response (ESP32 will time out)
+            // Unknown command: v1 stays silent (the master times out), v2 says so
+            if (s_v2) comms_respond_nak();
+            break;
     }
 }
 
-// ── Public API ────────────────────────────────────────────────────────────
-void Comms_Initialize(void) {
-    Timer0_Initialize();
-    ANSELAbits.ANSA0 = 0; // RA0 is set analog by MCC default; switch to digital
-    COMMS_LAT  = 0;    // always drive 0; direction controls the level
-    COMMS_TRIS = 1;    // start as input (hi-Z, line held high by pullup)
+// ── Frame parser ──────────────────────────────────────────────────────────
+// Fed one received byte at a time.  The frame CRC (XOR for v1, CRC-8 for
+// v2) is accumulated over SYNC through PAYLOAD as the bytes arrive.
+static void comms_frame_done(void) {
+    s_baud_quiet = 0;
+    if (s_v2 && s_replay && s_seq == s_lastseq && s_cmd == s_lastcmd) {
+        comms_replay();
+        return;
+    }
+    s_flags = 0;
+    comms_handle(s_cmd, s_payload, s_len);
+    s_lastseq = s_seq;
+    s_lastcmd = s_cmd;
 }
 
-// Call from main loop every iteration.  Non-blocking when line is idle.
-void Comms_Process(void) {
-    // Quick idle check — avoids any overhead when no master is talking
-    if (COMMS_PIN == 1) return;
+static void comms_parse(uint8_t b) {
+    switch (s_frame) {
+        case FRAME_SYNC:
+            if (b == COMMS_SYNC) {
+                s_v2 = false;
+                s_frame = FRAME_CMD;
+            } else if (b == COMMS_SYNC_V2) {
+                s_v2 = true;
+                s_frame = FRAME_SEQ;
+            } else {
+                return;
+            }
+            s_crc = comms_crc(0, b);
+            return;
+
+        case FRAME_SEQ:
+            s_seq = b;
+            s_frame = FRAME_CMD;
+            break;
 
-    // Potential start bit on line — try to receive SYNC byte
-    uint8_t b;
-    if (!comms_rx_byte(&b, 255)) return;
-    if (b != COMMS_SYNC) return;
+        case FRAME_CMD:
+            s_cmd = b;
+            s_frame = FRAME_LEN;
+            break;
 
-    // Receive CMD
-    uint8_t cmd;
-    if (!comms_rx_byte(&cmd, 255)) return;
+        case FRAME_LEN:
+            if (b > (s_v2 ? COMMS_MAX_PAYLOAD : COMMS_V1_MAX_PAYLOAD)) { s_frame = FRAME_SYNC; return; }
+            s_len = b;
+            s_pos = 0;
+            s_frame = b ? FRAME_PAYLOAD : FRAME_CRC;
+            break;
 
-    // Receive LEN
-    uint8_t len;
-    if (!comms_rx_byte(&len, 255)) return;
-    if (len > COMMS_MAX_PAYLOAD) return;
+        case FRAME_PAYLOAD:
+            s_payload[s_pos++] = b;
+            if (s_pos == s_len) s_frame = FRAME_CRC;
+            break;
 
-    // Receive PAYLOAD
-    uint8_t payload[COMMS_MAX_PAYLOAD];
-    for (uint8_t i = 0; i < len; i++) {
-        if (!comms_rx_byte(&payload[i], 255)) return;
+        case FRAME_CRC:
+            s_frame = FRAME_SYNC;
+            if (b == s_crc) comms_frame_done();
+            return;
     }
+    s_crc = comms_crc(s_crc, b);
+}
 
-    // Receive CRC
-    uint8_t rx_crc;
-    if (!comms_rx_byte(&rx_crc, 255)) return;
+// ── Public API ────────────────────────────────────────────────────────────
+void Comms_Initialize(void) {
+    ANSELAbits.ANSA0 = 0; // RA0 is set analog by MCC default; switch to digital
+    COMMS_LAT  = 0;    // always drive 0; direction controls the level
+    TMR0_SetInterruptHandler(comms_bit_isr);
+    IOCAF0_SetInterruptHandler(comms_edge_isr);
+    comms_set_baud(COMMS_BAUD_9600);
+    comms_listen();    // start as input (hi-Z, line held high by pullup)
+}
 
-    // Validate CRC: XOR of SYNC + CMD + LEN + PAYLOAD
-    uint8_t frame[3 + COMMS_MAX_PAYLOAD];
-    frame[0] = COMMS_SYNC;
-    frame[1] = cmd;
-    frame[2] = len;
-    for (uint8_t i = 0; i < len; i++) frame[3 + i] = payload[i];
-    if (crc8(frame, 3 + len) != rx_crc) return;
+// Call once per scheduler tick.  Never blocks: bytes are gathered by the
+// IOC / TMR0 interrupts and a reply is shifted out the same way.
+void Comms_Process(void) {
+    // A response is still on the wire — the request has been consumed
+    if (s_link == LINK_GUARD || s_link == LINK_TX) return;
+
+    // A master that lost a faster link starts over at 9600
+    if (s_baud != COMMS_BAUD_9600 && ++s_baud_quiet >= BAUD_FALLBACK) {
+        INTCONbits.IOCIE = 0;
+        if (s_link == LINK_IDLE) comms_set_baud(COMMS_BAUD_9600);
+        INTCONbits.IOCIE = 1;
+    }
 
-    // Turnaround guard: wait for ESP32 to switch from TX to INPUT_PULLUP
-    uint8_t t = (uint8_t)TMR0 + (uint8_t)(TURNAROUND_BITS * BIT_TIME);
-    while ((uint8_t)TMR0 != t);
+    if (s_rxtail == s_rxhead) {
+        // Drop a half-received frame once the master has gone quiet
+        if (s_frame != FRAME_SYNC && ++s_idle >= FRAME_TIMEOUT)
+            s_frame = FRAME_SYNC;
+        return;
+    }
+    s_idle = 0;
+
+    while (s_rxtail != s_rxhead) {
+        uint8_t b = s_rxring[s_rxtail];
+        s_rxtail = (s_rxtail + 1) & RX_RING_MASK;
+        comms_parse(b);
+        // A handled frame has started a response; anything after it is stale
+        if (s_link != LINK_IDLE && s_link != LINK_RX) {
+            s_rxtail = s_rxhead;
+            break;
+        }
+    }
+}
+
+bool Comms_Idle(void) {
+    return s_link == LINK_IDLE && s_rxtail == s_rxhead && s_frame == FRAME_SYNC;
+}
 
-    comms_handle(cmd, payload, len);
+void Comms_SetPerfHandler(comms_perf_handler_t handler) {
+    perfHandler = handler;
 }
 
 int16_t Comms_GetTargetTemperature(void)          { return targetTemperature; }
@@ -2,33 +2,106 @@
 #define COMMS_H
 
 #include <xc.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 // ── Single-wire half-duplex protocol ──────────────────────────────────────
 //
-// Physical layer: open-drain bit-bang UART, 9600 8N1, RA0 (ICSPDAT) only.
+// Physical layer: open-drain bit-bang UART, 8N1, RA0 (ICSPDAT) only.  The
+//   link starts at 9600 baud; see COMMS_CMD_SET_BAUD for going faster.
 //   RA0 is PIC pin 19, available on the J2 ICSP header — no soldering required.
 //   TX: LATAbits.LATA0 stays 0.  TRISA0=0 → pull low (bit=0).
 //                                 TRISA0=1 → hi-Z, pullup → high (bit=1).
 //   RX: TRISA0=1, sample PORTAbits.RA0.
 //   Line idles HIGH via ESP32 INPUT_PULLUP (~45 kΩ).  No external resistor.
 //
-// Protocol (ESP32 always initiates, PIC responds only):
+// Timing is interrupt driven: an IOC falling edge on RA0 arms TMR0 to sample
+// the start bit at its centre, TMR0 then paces each following bit.  Received
+// bytes go to a ring buffer that Comms_Process() parses once per scheduler
+// tick; a valid frame is answered by the same TMR0 interrupt after the
+// turnaround guard.  TMR0 belongs to this module.
+//
+// Protocol (ESP32 always initiates, PIC responds only).  Every request is
+// answered in the version it was sent in; the sync byte tells them apart.
+//
+// v1:
 //   Request:  [SYNC=0xAA] [CMD] [LEN] [PAYLOAD×LEN] [CRC8]
 //   Response: [LEN] [PAYLOAD×LEN] [CRC8]
-//   CRC8: XOR of all preceding bytes in the frame.
+//   CRC8: XOR of all preceding bytes in the frame.  LEN ≤ COMMS_V1_MAX_PAYLOAD.
+//
+// v2:
+//   Request:  [SYNC=0xA5] [SEQ] [CMD] [LEN] [PAYLOAD×LEN] [CRC8]
+//   Response: [SYNC=0xA5] [SEQ] [FLAGS] [LEN] [PAYLOAD×LEN] [CRC8]
+//   CRC8: polynomial 0x07 (crc8.h) over all preceding bytes, SYNC included.
+//   LEN ≤ COMMS_MAX_PAYLOAD.  The response echoes SEQ.  A request with the
+//   same SEQ and CMD as the one just answered is a retry: the stored response
+//   is sent again with COMMS_FLAG_DUP set and the command is not re-applied.
+//   Unknown commands and malformed payloads are answered with a NAK payload
+//   and COMMS_FLAG_ERR instead of silence.
+//
+// The master finds out whether v2 is there by sending COMMS_CMD_VERSION as
+// a v2 frame and falling back to v1 when nothing comes back.
+//
+// Link speed: COMMS_CMD_SET_BAUD without a payload returns the mask of
+// COMMS_BAUD_* profiles this build can bit-bang, which depends on
+// _XTAL_FREQ (at least COMMS_MIN_BIT_CYCLES instruction cycles per bit).
+// The default 4 MHz build can only do 9600, so it answers with just that
+// profile and the link stays there; XTAL_FREQ in the Makefile picks a
+// faster clock.
+// With a profile as payload the PIC answers ACK at the current speed and
+// switches once the ACK's last stop bit is out.  It returns to 9600 by
+// itself after COMMS_BAUD_FALLBACK_MS without a valid frame, so a master
+// that lost the link only has to wait and start over at 9600.
 
 #define COMMS_SYNC          0xAA
+#define COMMS_SYNC_V2       0xA5
 #define COMMS_ACK           0x06
 #define COMMS_NAK           0x15
-#define COMMS_MAX_PAYLOAD   4
+#define COMMS_V1_MAX_PAYLOAD 4
+#define COMMS_MAX_PAYLOAD   32
+
+// v2 response FLAGS
+#define COMMS_FLAG_ERR      0x01  // Request rejected, payload is a NAK
+#define COMMS_FLAG_DUP      0x02  // Retried SEQ, this is the stored response
+#define COMMS_FLAG_EVENT    0x04  // Events are queued, see COMMS_CMD_GET_EVENTS
 
 // Commands
-#define COMMS_CMD_GET       0x01  // No payload → 10-byte telemetry response
-#define COMMS_CMD_SET_TEMP  0x02  // Payload: int16 LE (tenths °C) → ACK/NAK
-#define COMMS_CMD_SET_POWER 0x03  // Payload: uint8 0-100 % → ACK/NAK
+#define COMMS_CMD_GET       0x01  // No payload → 11-byte telemetry response
+#define COMMS_CMD_SET_TEMP  0x02  // Payload: int16 LE (tenths °C, MIN_TEMP-MAX_TEMP) → ACK/NAK
+#define COMMS_CMD_SET_POWER 0x03  // Payload: uint8 0-PMAX % → ACK/NAK
 #define COMMS_CMD_SET_PMAX  0x04  // Payload: uint8 0-100 % → ACK/NAK
 #define COMMS_CMD_SET_PMODE 0x05  // Payload: uint8 (0=ECO 1=NORMAL 2=HI) → ACK/NAK
+#define COMMS_CMD_GET_PERF  0x06  // Payload: uint8 page → page data, NAK for an unknown page
+#define COMMS_CMD_GET_ENERGY 0x07 // No payload → 16-byte energy counters
+#define COMMS_CMD_GET_HISTORY 0x08 // Payload: uint8 page → 28-byte history page, NAK past the end
+#define COMMS_CMD_VERSION   0x09  // No payload → [protocol version] [max request LEN] [max response LEN]
+#define COMMS_CMD_SET       0x0A  // Payload: TLV settings → GET response, or NAK and nothing applied
+#define COMMS_CMD_SET_BAUD  0x0B  // No payload → uint8 profile mask; payload: uint8 profile → ACK/NAK, then switch
+#define COMMS_CMD_GET_DELTA 0x0C  // Payload: [ACK] or [ACK] [deadbands×3] → changed GET fields
+#define COMMS_CMD_GET_EVENTS 0x0D // No payload → queued events, oldest first
+#define COMMS_CMD_EFFMAP    0x0E  // Payload: uint8 op (COMMS_EFFMAP_*) → status, map or ACK/NAK
+#define COMMS_CMD_GET_CYCLES 0x0F // No payload → 12-byte compressor cycle statistics
+
+#define COMMS_PROTOCOL_VERSION 2
+
+// Link speed profiles, bit n of the SET_BAUD mask.  57600 is as fast as the
+// 32 MHz build gets; at the default 4 MHz only 9600 is offered.
+#define COMMS_BAUD_9600     0
+#define COMMS_BAUD_19200    1
+#define COMMS_BAUD_38400    2
+#define COMMS_BAUD_57600    3
+#define COMMS_BAUD_COUNT    4
+
+#define COMMS_MIN_BIT_CYCLES  100   // Bit interrupt plus other ISRs' jitter must fit half a bit
+#define COMMS_BAUD_FALLBACK_MS 3000
+
+// SET payload: any number of [TAG] [LEN] [VALUE×LEN] items.  A tag is the
+// single-setting command the item stands for, with that command's payload
+// as its value (COMMS_CMD_SET_TEMP, _SET_POWER, _SET_PMAX, _SET_PMODE).
+// Every item is checked before any is applied, so either all of them take
+// effect or none; the response is the fresh GET telemetry.  A POWER item is
+// checked against the PMAX in effect after the whole payload, whichever
+// comes first.
 
 // GET response payload layout (11 bytes, all little-endian)
 //   [0-1] current temp  int16 tenths °C
@@ -39,6 +112,94 @@
 //   [9]   comp pmax     uint8  0-100 %
 //  [10]   power mode    uint8  0=ECO 1=NORMAL 2=HI
 
+// GET_DELTA: the GET fields that moved since the snapshot the master holds.
+//   Request:  [0] ACK, the ID of the last delta the master applied, or 0 for
+//                 a full snapshot
+//             [1-3] optional deadbands, kept until changed: temperature
+//                 (0.1 °C), voltage (10 mV), fan current (10 mA)
+//   Response: [0] ID of this delta (never 0)  [1] field bitmap
+//             [2..] each field whose bit is set, in GET order and encoding:
+//                 bit 0 temp, 1 setpoint, 2 voltage, 3 fan current,
+//                 4 comp power, 5 comp pmax, 6 power mode
+// Temperature, voltage and fan current are sent once they are a deadband
+// or more away from the master's copy, everything else on any change.  An
+// ACK other than the last ID sent or the one before it, as after a reset on
+// either side, gets every field.
+#define COMMS_DELTA_FIELDS  7
+#define COMMS_DELTA_TEMP_DB 1     // Default deadbands
+#define COMMS_DELTA_VOLT_DB 5
+#define COMMS_DELTA_FAN_DB  2
+
+// GET_EVENTS response payload layout (events.h)
+//   [0]   events still queued after this response
+//   [1]   events lost to a full queue since the last GET_EVENTS
+//   [2..] up to COMMS_EVENTS_PER_RESPONSE × [TYPE] [ARG], oldest first
+// COMMS_FLAG_EVENT in the FLAGS of any v2 response says there is something
+// to fetch; a lost GET_EVENTS response is recovered by retrying its SEQ.
+#define COMMS_EVENTS_PER_RESPONSE ((COMMS_MAX_RESPONSE - 2) / 2)
+
+// EFFMAP ops (effmap.h)
+//   STATUS → [0] 1 = sweeping  [1] speeds measured  [2] speeds to measure
+//            (each speed twice, up and down)  [3] speed index now
+//            [4] entries in the stored map
+//   START  → ACK, or NAK while a sweep runs; the sweep takes over the
+//            compressor once it is out of its lockout, and stops early if the
+//            cooler is switched off, the battery runs low or the cabinet gets
+//            2 °C below the setpoint
+//   ABORT  → ACK; the map is left as it was
+//   MAP    → [0] speed index of the first entry  [1] entries  [2..15] cooling
+//            per watt for each index, (0.01 °C/min) × 64 / W, 0 = none
+//   CLEAR  → ACK; the speed controller goes back to its own choice
+#define COMMS_EFFMAP_STATUS 0
+#define COMMS_EFFMAP_START  1
+#define COMMS_EFFMAP_ABORT  2
+#define COMMS_EFFMAP_MAP    3
+#define COMMS_EFFMAP_CLEAR  4
+
+// GET_ENERGY response payload layout (16 bytes, all uint32 little-endian)
+//   [0-3]   compressor energy  Wh
+//   [4-7]   total energy       Wh (compressor and fan)
+//   [8-11]  compressor run time s
+//  [12-15]  compressor starts
+
+// GET_CYCLES response payload layout (12 bytes, see cycles.h)
+//   [0-1]   last on-cycle  uint16 s
+//   [2-3]   last off-cycle uint16 s
+//   [4-5]   on- or off-cycle under way so far, uint16 s
+//   [6]     bit 0 compressor running, bit 1 the cycle counts towards the rate
+//   [7]     starts in the last hour
+//   [8]     target starts per hour
+//   [9]     restart offset of the power mode, 0.1 °C
+//  [10]     speed indexes taken off the run ceiling
+//  [11]     how far runs go on below the setpoint, 0.1 °C
+
+// GET_HISTORY page payload layout (28 bytes, see history.h)
+//   [0-1]   number of the newest entry, uint16 (entries recorded since reset)
+//   [2]     entries held, up to HISTORY_ENTRIES
+//   [3-27]  5 entries of 5 bytes, from entry page × 5 back from the newest
+//           towards older ones: temp avg (int8 0.5 °C), temp span (max above
+//           avg in bits 7-4, min below in bits 3-0, 0.5 °C), duty (%),
+//           power (W), voltage (0.2 V); entries past the oldest are all zero
+
+// GET_PERF pages (times in µs, all little-endian)
+//   page 0   loop summary, 10 bytes:
+//              [0] task count  [1] probe count
+//              [2-9] busy time per scheduler pass: last, min, avg, max (uint16)
+//   page 1   loop histogram, 16 bytes: 8 × uint16 pass counts, bucket n < 256 << n µs
+//   page 2.. one per task in table order, then one per probe, 9 bytes:
+//              [0-7] run time: last, min, avg, max (uint16)  [8] deadline misses
+//   Probes: 0 = TM1620B_Update()
+//           1 = IRMCF183 command queued to first reply byte, [8] commands
+//               not answered cleanly (saturating)
+#define COMMS_PERF_LOOP     0
+#define COMMS_PERF_HIST     1
+#define COMMS_PERF_TASKS    2
+#define COMMS_MAX_RESPONSE  COMMS_MAX_PAYLOAD  // Longest response payload
+
+// Fills `buf` (COMMS_MAX_RESPONSE bytes) with a GET_PERF page and returns its
+// length, or 0 if there is no such page
+typedef uint8_t (*comms_perf_handler_t)(uint8_t page, uint8_t* buf);
+
 // Pin definitions — RA0 (ICSPDAT, PIC pin 19, J2 header) open-drain bidirectional
 #define COMMS_PIN           PORTAbits.RA0
 #define COMMS_TRIS          TRISAbits.TRISA0
@@ -46,6 +207,8 @@
 
 void    Comms_Initialize(void);
 void    Comms_Process(void);
+bool    Comms_Idle(void);      // Nothing on the wire, queued or half parsed
+void    Comms_SetPerfHandler(comms_perf_handler_t handler);
 
 int16_t Comms_GetTargetTemperature(void);
 void    Comms_SetTargetTemperature(int16_t temp);
@@ -0,0 +1,10 @@
+#ifndef CRC8_H
+#define CRC8_H
+
+#include <stdint.h>
+
+// CRC-8, polynomial 0x07 (x^8 + x^2 + x + 1), MSB first, no final XOR.
+// Used by the EEPROM journals and by protocol v2 frames on the ESP32 link.
+uint8_t Crc8(uint8_t crc, uint8_t data);
+
+#endif /* CRC8_H */
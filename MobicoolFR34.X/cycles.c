@@ -0,0 +1,129 @@
+#include "cycles.h"
+#include "settings.h"
+
+// Comfort bounds of the restart offset, how far the run speed may be
+// trimmed once the offset is at its widest, and how far below the setpoint
+// a run may then go on
+typedef struct {
+    uint8_t min;    // 0.1 °C
+    uint8_t start;
+    uint8_t max;
+    uint8_t trim;   // Speed indexes
+    uint8_t under;  // 0.1 °C
+} cycles_band_t;
+
+static const cycles_band_t bands[] = { // Indexed by pmode_t
+    { 15, TEMP_HYSTERESIS_ECO, 30, 3, 5 },      // PMODE_ECO: its cap is 3 over the minimum speed
+    { 5, TEMP_HYSTERESIS_DEFAULT, 15, 11, 5 },  // PMODE_NORMAL: 11 under its cap is the minimum
+    { 5, TEMP_HYSTERESIS_DEFAULT, 10, 0, 0 },   // PMODE_HI: full speed, TEMP_OVERSHOOT_HI
+};
+#define NUM_BANDS (sizeof(bands) / sizeof(bands[0]))
+
+static uint8_t s_restart[NUM_BANDS];    // Offset in use per mode, 0.1 °C
+static uint8_t s_trim[NUM_BANDS];
+static uint8_t s_under[NUM_BANDS];      // 0.1 °C
+
+static bool s_running;
+static uint16_t s_phase;        // Seconds in the current on- or off-cycle
+static uint16_t s_on, s_off;    // Last complete ones
+static uint8_t s_pmode;         // Mode of the cycle being timed
+static uint8_t s_pmode_now;
+static bool s_clean;            // The thermostat has had this cycle to itself
+static bool s_on_clean;         // ...and s_on was part of it
+
+static uint8_t s_starts[CYCLES_BUCKETS];
+static uint8_t s_bucket;
+static uint16_t s_bucket_s;
+
+static uint8_t band(uint8_t pmode) {
+    return pmode < NUM_BANDS ? pmode : (uint8_t)(NUM_BANDS - 1);
+}
+
+void Cycles_Initialize(void) {
+    for (uint8_t i = 0; i < NUM_BANDS; i++) {
+        s_restart[i] = bands[i].start;
+        s_trim[i] = 0;
+        s_under[i] = 0;
+    }
+    for (uint8_t i = 0; i < CYCLES_BUCKETS; i++) s_starts[i] = 0;
+    s_bucket = 0;
+    s_bucket_s = 0;
+    s_running = false;
+    s_phase = s_on = s_off = 0;
+    s_pmode = s_pmode_now = 0;
+    s_clean = s_on_clean = false;   // The first off-cycle has no start
+}
+
+// One start-to-start cycle of on + off seconds, in mode b
+static void adapt(uint8_t b, uint16_t on, uint16_t off) {
+    const cycles_band_t* r = &bands[b];
+    uint32_t period = (uint32_t)on + off;
+
+    if (period < CYCLES_TARGET_S - CYCLES_SLACK_S) {
+        if (s_restart[b] + CYCLES_STEP10 <= r->max) s_restart[b] += CYCLES_STEP10;
+        else if (s_trim[b] < r->trim) s_trim[b]++;
+        else if (s_under[b] + CYCLES_STEP10 <= r->under) s_under[b] += CYCLES_STEP10;
+    } else if (period > CYCLES_TARGET_S + CYCLES_SLACK_S) {
+        if (s_under[b] >= CYCLES_STEP10) s_under[b] -= CYCLES_STEP10;
+        else if (s_trim[b] > 0) s_trim[b]--;
+        else if (s_restart[b] >= r->min + CYCLES_STEP10) s_restart[b] -= CYCLES_STEP10;
+    }
+}
+
+void Cycles_Tick(bool running, bool control, uint8_t pmode) {
+    if (++s_bucket_s == CYCLES_BUCKET_S) {
+        s_bucket_s = 0;
+        if (++s_bucket == CYCLES_BUCKETS) s_bucket = 0;
+        s_starts[s_bucket] = 0;
+    }
+
+    if (running != s_running) {
+        s_running = running;
+        if (running) {
+            if (s_starts[s_bucket] < 255) s_starts[s_bucket]++;
+            s_off = s_phase;
+            if (s_clean && s_on_clean) adapt(band(s_pmode), s_on, s_off);
+            s_clean = true;
+            s_on_clean = false;
+            s_pmode = pmode;
+        } else {
+            s_on = s_phase;
+            s_on_clean = s_clean;
+        }
+        s_phase = 0;
+    }
+    if (s_phase < 0xFFFF) s_phase++;
+    if (!control || pmode != s_pmode) s_clean = false;
+    s_pmode_now = pmode;
+}
+
+int16_t Cycles_GetRestart10(uint8_t pmode) {
+    return s_restart[band(pmode)];
+}
+
+uint8_t Cycles_GetSpeedTrim(uint8_t pmode) {
+    return s_trim[band(pmode)];
+}
+
+int16_t Cycles_GetUndershoot10(uint8_t pmode) {
+    return s_under[band(pmode)];
+}
+
+uint8_t Cycles_GetStatus(uint8_t* buf) {
+    uint8_t starts = 0;
+    for (uint8_t i = 0; i < CYCLES_BUCKETS; i++) starts += s_starts[i];
+
+    buf[0] = (uint8_t)s_on;
+    buf[1] = (uint8_t)(s_on >> 8);
+    buf[2] = (uint8_t)s_off;
+    buf[3] = (uint8_t)(s_off >> 8);
+    buf[4] = (uint8_t)s_phase;
+    buf[5] = (uint8_t)(s_phase >> 8);
+    buf[6] = (uint8_t)((s_running ? 0x01 : 0) | (s_clean && (s_running || s_on_clean) ? 0x02 : 0));
+    buf[7] = starts;
+    buf[8] = CYCLES_TARGET_PER_H;
+    buf[9] = s_restart[band(s_pmode_now)];
+    buf[10] = s_trim[band(s_pmode_now)];
+    buf[11] = s_under[band(s_pmode_now)];
+    return CYCLES_STATUS_SIZE;
+}
@@ -0,0 +1,71 @@
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Compressor cycle rate ─────────────────────────────────────────────────
+//
+// Times each on- and off-cycle of the compressor and counts the starts over
+// the last hour.  Every start that closes a cycle the thermostat had to
+// itself (switched on, no sweep, one power mode throughout) nudges the
+// restart offset of that mode by CYCLES_STEP10 towards CYCLES_TARGET_PER_H:
+// wider when the cycle was shorter than the target band, narrower when it
+// was longer.  Once the offset is at the widest the mode allows, a short
+// cycle takes one speed index off the run ceiling instead, as far down as
+// the minimum speed, so the next run cools more slowly and lasts longer.
+// Short cycles at the minimum speed then let the runs go on further below
+// the setpoint, as PMODE_HI does with TEMP_OVERSHOOT_HI; long cycles give
+// that back first, then the speed.  The first steps off the ceiling only
+// matter once it comes down to the speeds the controller settles on.  The
+// offsets start from TEMP_HYSTERESIS_DEFAULT/_ECO and are not kept over a
+// reset.
+
+// 0 leaves the module out of the build (Makefile FEATURES): the offsets
+// stay at their defaults, and GET_CYCLES gets the answer of an unknown
+// command
+#ifndef CYCLES_ENABLE
+#define CYCLES_ENABLE       1
+#endif
+
+#define CYCLES_TARGET_PER_H 3
+#define CYCLES_TARGET_S     (3600 / CYCLES_TARGET_PER_H)
+#define CYCLES_SLACK_S      (CYCLES_TARGET_S / 4)   // Either side of the target, left alone
+#define CYCLES_STEP10       1       // 0.1 °C per cycle
+#define CYCLES_BUCKET_S     600     // Starts per hour are counted in 10 min buckets
+#define CYCLES_BUCKETS      6
+
+// COMMS_CMD_GET_CYCLES response, all little-endian:
+//   [0-1] last on-cycle, s  [2-3] last off-cycle, s  [4-5] the on- or
+//   off-cycle under way so far, s (uint16, saturating, 0 = none seen yet)
+//   [6] bit 0 running, bit 1 this cycle will count  [7] starts in the last
+//   hour  [8] target starts per hour  [9] restart offset of the mode now,
+//   0.1 °C  [10] speed indexes taken off its run ceiling  [11] how far its
+//   runs go on below the setpoint, 0.1 °C
+#define CYCLES_STATUS_SIZE  12
+
+#if CYCLES_ENABLE
+void Cycles_Initialize(void);
+
+// Once per second.  control: the thermostat decides when the compressor
+// runs, in the given pmode_t
+void Cycles_Tick(bool running, bool control, uint8_t pmode);
+
+// Restart offset above the setpoint for a pmode_t, 0.1 °C
+int16_t Cycles_GetRestart10(uint8_t pmode);
+
+// Speed indexes to take off the run ceiling of a pmode_t
+uint8_t Cycles_GetSpeedTrim(uint8_t pmode);
+
+// How far below the setpoint a run of a pmode_t goes on, 0.1 °C
+int16_t Cycles_GetUndershoot10(uint8_t pmode);
+
+uint8_t Cycles_GetStatus(uint8_t* buf);
+#else
+#define Cycles_Initialize()
+#define Cycles_Tick(running, control, pmode)
+#define Cycles_GetSpeedTrim(pmode)      0
+#define Cycles_GetUndershoot10(pmode)   0
+#endif
+
+#endif /* CYCLES_H */
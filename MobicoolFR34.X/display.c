@@ -1,11 +1,14 @@
 #include "display.h"
 #include "tm1620b.h"
 #include "settings.h"
+#include "scheduler.h"
 #include "mcc_generated_files/pin_manager.h"
 #include "mcc_generated_files/mcc.h"
 #include <stddef.h>
 #include <xc.h>
 
+static sched_stat_t s_panelstat; // TM1620B_Update() cost
+
 void Display_Initialize(void) {
     IO_LightEna_SetHigh();
     TM1620B_SetBrightness(true, DISPLAY_DEFAULT_BRIGHT);
@@ -34,8 +37,18 @@ void Display_TimerTick(display_context_t* ctx) {
     ctx->flashtimer++;
 }
 
-void Display_HandleKeyPress(display_context_t* ctx, uint8_t pressed_keys) {
-    if (pressed_keys) {
+void Display_Splash(display_context_t* ctx) {
+    // Ends with the idle timeout, brought forward
+    ctx->state = DISP_SPLASH;
+    ctx->idletimer = 10 - DISPLAY_SPLASH_TIME;
+}
+
+void Display_HandleKeyPress(display_context_t* ctx, const key_event_t* ev) {
+    // Presses change the state, presses and repeats the value being set
+    uint8_t pressed_keys = ev->kind == KEY_EV_PRESS ? ev->key : 0;
+    uint8_t step_keys = (ev->kind == KEY_EV_PRESS || ev->kind == KEY_EV_REPEAT) ? ev->key : 0;
+
+    if (step_keys) {
         ctx->flashtimer = 0; // restart flash timer on every keypress
         ctx->idletimer = 0;
         ctx->dimtimer = 0;
@@ -67,17 +80,17 @@ void Display_HandleKeyPress(display_context_t* ctx, uint8_t pressed_keys) {
     }
     
     // Handle setting adjustments
-    if (pressed_keys & KEY_MINUS && ctx->state == DISP_SET_TEMP && ctx->newtemp > MIN_TEMP) ctx->newtemp--;
-    if (pressed_keys & KEY_PLUS && ctx->state == DISP_SET_TEMP && ctx->newtemp < MAX_TEMP) ctx->newtemp++;
+    if (step_keys & KEY_MINUS && ctx->state == DISP_SET_TEMP && ctx->newtemp > MIN_TEMP) ctx->newtemp--;
+    if (step_keys & KEY_PLUS && ctx->state == DISP_SET_TEMP && ctx->newtemp < MAX_TEMP) ctx->newtemp++;
     
     if (ctx->state == DISP_SET_PMODE) {
-        if (pressed_keys & KEY_MINUS && ctx->newpmode > PMODE_ECO) ctx->newpmode--;
-        if (pressed_keys & KEY_PLUS && ctx->newpmode < PMODE_HI) ctx->newpmode++;
+        if (step_keys & KEY_MINUS && ctx->newpmode > PMODE_ECO) ctx->newpmode--;
+        if (step_keys & KEY_PLUS && ctx->newpmode < PMODE_HI) ctx->newpmode++;
     }
     
     if (ctx->state == DISP_SET_BATTMON) {
-        if (pressed_keys & KEY_MINUS && ctx->newbattmon > BMON_DIS) ctx->newbattmon--;
-        if (pressed_keys & KEY_PLUS && ctx->newbattmon < BMON_HIGH) ctx->newbattmon++;
+        if (step_keys & KEY_MINUS && ctx->newbattmon > BMON_DIS) ctx->newbattmon--;
+        if (step_keys & KEY_PLUS && ctx->newbattmon < BMON_HIGH) ctx->newbattmon++;
     }
 }
 
@@ -230,9 +243,22 @@ void Display_Update(display_context_t* ctx, uint8_t pressed_keys) {
             }
             break;
         }
+        case DISP_SPLASH:
+            buf[1] = c_U;
+            buf[2] = c_E;
+            buf[3] = c_o;
+            buf[4] = c_S;
+            break;
         default:
             break;
     }
     
+    sched_stamp_t start;
+    Scheduler_Stamp(&start);
     TM1620B_Update(buf);
+    Scheduler_StatAdd(&s_panelstat, Scheduler_Elapsed(&start));
+}
+
+const sched_stat_t* Display_GetPanelStat(void) {
+    return &s_panelstat;
 }
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "settings.h"
+#include "scheduler.h"
+#include "keys.h"
 
 // Display states
 typedef enum {
@@ -23,6 +25,8 @@ typedef enum {
     DISP_FANCURRENT,   // Fan current
     DISP_TEMPRATE,     // Temperature rate of change
     DISP_STATUS_END,
+
+    DISP_SPLASH,       // Power-up banner
 } display_state_t;
 
 extern uint8_t FormatDigits(uint8_t* buf, int16_t value, uint8_t decimals);
@@ -72,6 +76,7 @@ typedef struct {
 // Display brightness levels
 #define DISPLAY_DEFAULT_BRIGHT (4)
 #define DISPLAY_DIM_BRIGHT (0)
+#define DISPLAY_SPLASH_TIME (2) // Seconds
 
 // Initialize display module
 void Display_Initialize(void);
@@ -82,10 +87,17 @@ void Display_Update(display_context_t* ctx, uint8_t pressed_keys);
 // Timer-based display updates (dimming, idle timeout)
 void Display_TimerTick(display_context_t* ctx);
 
-// Handle key press events
-void Display_HandleKeyPress(display_context_t* ctx, uint8_t pressed_keys);
+// Show the splash for DISPLAY_SPLASH_TIME, then the idle screen
+void Display_Splash(display_context_t* ctx);
+
+// Handle a key event (keys.h): presses move between screens, presses and
+// repeats of +/- step the value being set
+void Display_HandleKeyPress(display_context_t* ctx, const key_event_t* ev);
 
 // Get LED status
 uint8_t Display_GetLEDs(display_context_t* ctx);
 
+// Time spent bit-banging the panel in TM1620B_Update()
+const sched_stat_t* Display_GetPanelStat(void);
+
 #endif /* DISPLAY_H */
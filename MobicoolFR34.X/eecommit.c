@@ -0,0 +1,74 @@
+#include "eecommit.h"
+#include "scheduler.h"
+#include "ring.h"
+#include "mcc_generated_files/mcc.h"
+
+#if EECOMMIT_QUEUE_SIZE & RING_MASK(EECOMMIT_QUEUE_SIZE)
+#error "EECOMMIT_QUEUE_SIZE must be a power of two"
+#endif
+
+static uint8_t s_addr[EECOMMIT_QUEUE_SIZE];
+static uint8_t s_data[EECOMMIT_QUEUE_SIZE];
+static volatile uint8_t s_head;     // Next free entry, written by EECommit_Write()
+static volatile uint8_t s_tail;     // Next entry to program, written by the ISR
+static volatile bool s_writing;     // A byte is being programmed
+
+// Start programming the next byte that differs from what the cell holds.
+// Runs from the EEIF interrupt, or with EEIE off when the queue was idle.
+static void start_next(void) {
+    while (s_tail != s_head) {
+        uint8_t i = s_tail;
+        s_tail = RING_NEXT(i, EECOMMIT_QUEUE_SIZE);
+        if (DATAEE_ReadByte(s_addr[i]) != s_data[i]) {
+            DATAEE_StartWrite(s_addr[i], s_data[i]);
+            s_writing = true;
+            return;
+        }
+    }
+    s_writing = false;
+}
+
+void EECommit_Initialize(void) {
+    s_head = 0;
+    s_tail = 0;
+    s_writing = false;
+    DATAEE_SetInterruptHandler(start_next);
+    PIR2bits.EEIF = 0;
+    PIE2bits.EEIE = 1;
+}
+
+bool EECommit_Write(uint8_t addr, const void* data, uint8_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+
+    PIE2bits.EEIE = 0; // The ISR is the only other user of the queue
+    uint8_t head = s_head;
+    uint8_t room = RING_ROOM(head, s_tail, EECOMMIT_QUEUE_SIZE);
+    if (len > room) {
+        PIE2bits.EEIE = 1;
+        return false;
+    }
+    while (len--) {
+        s_addr[head] = addr++;
+        s_data[head] = *p++;
+        head = RING_NEXT(head, EECOMMIT_QUEUE_SIZE);
+    }
+    s_head = head;
+    if (!s_writing) start_next();
+    PIE2bits.EEIE = 1;
+    return true;
+}
+
+bool EECommit_Busy(void) {
+    return s_writing || s_tail != s_head;
+}
+
+void EECommit_Flush(void) {
+    while (EECommit_Busy()) {
+        SCHEDULER_IDLE();
+    }
+}
+
+uint8_t EECommit_Read(uint8_t addr) {
+    EECommit_Flush();
+    return DATAEE_ReadByte(addr);
+}
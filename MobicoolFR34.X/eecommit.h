@@ -0,0 +1,37 @@
+#ifndef EECOMMIT_H
+#define EECOMMIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Deferred data EEPROM writes ───────────────────────────────────────────
+//
+// A data EEPROM byte takes about 4 ms to program, and DATAEE_WriteByte()
+// spins for all of it with interrupts off.  Writers here only queue
+// (address, data) pairs; the first write is started right away and every
+// following one from the EEIF interrupt when the previous one has finished,
+// so the main loop never waits on the EEPROM.
+//
+// Bytes are programmed in the order they were queued, so a record whose
+// commit byte is queued last is never seen complete before the rest of it.
+// A byte whose cell already holds the value is skipped without a write.
+
+#define EECOMMIT_QUEUE_SIZE 32  // Power of two; holds EECOMMIT_QUEUE_SIZE - 1 bytes
+
+// Hook the EEIF interrupt; call once after SYSTEM_Initialize()
+void EECommit_Initialize(void);
+
+// Queue len bytes for addr onwards.  All or nothing: false, with nothing
+// queued, if the queue does not have room for all of them.
+bool EECommit_Write(uint8_t addr, const void* data, uint8_t len);
+
+// True while bytes are queued or a write is in progress
+bool EECommit_Busy(void);
+
+// Wait until every queued byte has been written
+void EECommit_Flush(void);
+
+// Read one byte, after any queued writes have landed
+uint8_t EECommit_Read(uint8_t addr);
+
+#endif /* EECOMMIT_H */
@@ -0,0 +1,150 @@
+#include "effmap.h"
+#include "settings.h"
+#include "journal.h"
+#include "eecommit.h"
+#include "irmcf183.h"
+
+static journal_t s_journal = {
+    EE_EFFMAP_BASE, EE_EFFMAP_SLOTS, sizeof(effmap_t), 0x4D
+};
+static effmap_t s_map;
+
+// Sweep state
+static bool s_sweeping;
+static uint8_t s_first, s_count;
+static uint8_t s_step;          // Speeds done, up then down
+static uint8_t s_seconds;       // Into the current speed
+static int32_t s_sum_x;         // Temperature, tenths
+static int32_t s_sum_tx;        // Temperature × seconds into the measurement
+static uint16_t s_sum_w;        // Compressor power, W
+static int16_t s_cool[EFFMAP_ENTRIES];  // Per index, up and down added
+static uint16_t s_watts[EFFMAP_ENTRIES];
+
+// Least-squares slope over EFFMAP_MEASURE_S samples one second apart:
+// (N Σtx - Σt Σx) / (N Σt² - (Σt)²), with t = 0 .. N-1
+#define LS_N        ((int32_t)EFFMAP_MEASURE_S)
+#define LS_SUM_T    (LS_N * (LS_N - 1) / 2)
+#define LS_DEN      (LS_N * LS_N * (LS_N * LS_N - 1) / 12)
+#define LS_PER_MIN  (LS_DEN / 600)  // Tenths per second to hundredths per minute
+
+static bool map_sane(const effmap_t* map) {
+    return map->count <= EFFMAP_ENTRIES;
+}
+
+void EffMap_Initialize(void) {
+    if (!Journal_Load(&s_journal, &s_map) || !map_sane(&s_map)) {
+        s_map.count = 0;
+    }
+    s_sweeping = false;
+}
+
+const effmap_t* EffMap_Get(void) {
+    return &s_map;
+}
+
+static void save(void) {
+    if (!Journal_Append(&s_journal, &s_map)) {
+        EECommit_Flush();
+        Journal_Append(&s_journal, &s_map);
+    }
+}
+
+void EffMap_Clear(void) {
+    s_map.count = 0;
+    save();
+}
+
+uint8_t EffMap_Prefer(uint8_t idx, uint8_t max) {
+    if (s_map.count == 0 || idx < s_map.first) return idx;
+    uint8_t k = (uint8_t)(idx - s_map.first);
+    if (k >= s_map.count) return idx;
+
+    uint8_t best = k;
+    for (uint8_t n = 1; n <= EFFMAP_WINDOW; n++) {
+        if (k + n >= s_map.count || idx + n > max) break;
+        if (s_map.eff[k + n] > s_map.eff[best]) best = (uint8_t)(k + n);
+    }
+    return (uint8_t)(s_map.first + best);
+}
+
+// ── Sweep ─────────────────────────────────────────────────────────────────
+static uint8_t sweep_index(void) {
+    uint8_t k = s_step < s_count ? s_step : (uint8_t)(2 * s_count - 1 - s_step);
+    return (uint8_t)(s_first + k);
+}
+
+bool EffMap_Start(void) {
+    if (s_sweeping) return false;
+    s_first = Compressor_GetMinSpeedIdx();
+    s_count = (uint8_t)(Compressor_GetMaxSpeedIdx() - s_first + 1);
+    if (s_count > EFFMAP_ENTRIES) s_count = EFFMAP_ENTRIES;
+    for (uint8_t i = 0; i < EFFMAP_ENTRIES; i++) {
+        s_cool[i] = 0;
+        s_watts[i] = 0;
+    }
+    s_step = 0;
+    s_seconds = 0;
+    s_sweeping = true;
+    return true;
+}
+
+void EffMap_Abort(void) {
+    s_sweeping = false;
+}
+
+bool EffMap_Sweeping(void) {
+    return s_sweeping;
+}
+
+static void finish(void) {
+    s_map.first = s_first;
+    s_map.count = s_count;
+    for (uint8_t i = 0; i < s_count; i++) {
+        int32_t eff = 0;
+        if (s_cool[i] > 0 && s_watts[i] > 0) {
+            eff = (int32_t)s_cool[i] * EFFMAP_SCALE / s_watts[i];
+            if (eff > 255) eff = 255;
+        }
+        s_map.eff[i] = (uint8_t)eff;
+    }
+    for (uint8_t i = s_count; i < EFFMAP_ENTRIES; i++) s_map.eff[i] = 0;
+    save();
+    s_sweeping = false;
+}
+
+uint8_t EffMap_Tick(int16_t temp10, uint8_t comp_watts) {
+    if (!s_sweeping) return 0;
+
+    if (s_seconds >= EFFMAP_SETTLE_S) {
+        int16_t t = (int16_t)(s_seconds - EFFMAP_SETTLE_S);
+        s_sum_x += temp10;
+        s_sum_tx += (int32_t)t * temp10;
+        s_sum_w += comp_watts;
+    } else if (s_seconds == 0) {
+        s_sum_x = 0;
+        s_sum_tx = 0;
+        s_sum_w = 0;
+    }
+
+    if (++s_seconds == EFFMAP_SETTLE_S + EFFMAP_MEASURE_S) {
+        uint8_t k = (uint8_t)(sweep_index() - s_first);
+        int32_t num = LS_N * s_sum_tx - LS_SUM_T * s_sum_x;
+        s_cool[k] += (int16_t)(-num / LS_PER_MIN);
+        s_watts[k] += (uint16_t)((s_sum_w + EFFMAP_MEASURE_S / 2) / EFFMAP_MEASURE_S);
+        s_seconds = 0;
+        if (++s_step == 2 * s_count) {
+            finish();
+            return 0;
+        }
+    }
+    return sweep_index();
+}
+
+uint8_t EffMap_GetStatus(uint8_t* buf) {
+    buf[0] = s_sweeping;
+    buf[1] = s_sweeping ? s_step : 0;
+    buf[2] = s_sweeping ? (uint8_t)(2 * s_count) : 0;
+    buf[3] = s_sweeping ? sweep_index() : 0;
+    buf[4] = s_map.count;
+    return EFFMAP_STATUS_SIZE;
+}
@@ -0,0 +1,74 @@
+#ifndef EFFMAP_H
+#define EFFMAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Speed efficiency map ──────────────────────────────────────────────────
+//
+// The IRMCF183 speeds are not equally efficient, and where the sweet spot
+// lies differs from unit to unit.  A service sweep (COMMS_CMD_EFFMAP) runs
+// each supported speed from the minimum up, then back down, for
+// EFFMAP_SETTLE_S + EFFMAP_MEASURE_S.  It records the compressor power and
+// the cabinet cooling rate (least-squares slope of the temperature) and
+// keeps cooling per watt for each index in an EEPROM journal.  Every index is
+// measured once on the way up and once on the way down, so the cabinet
+// losses changing as it cools cancel to first order.
+//
+// With a map, the speed controller runs up to EFFMAP_WINDOW indexes faster
+// than asked when such an index is more efficient.  Cooling grows with
+// speed, so the faster index still meets the cooling the controller asked
+// for, and the thermostat stops it sooner.
+
+// 0 leaves the map out of the build (Makefile FEATURES): the speed
+// controller runs at the index it asks for, and COMMS_CMD_EFFMAP gets the
+// answer of an unknown command.  Its EEPROM journal stays reserved.
+#ifndef EFFMAP_ENABLE
+#define EFFMAP_ENABLE       1
+#endif
+
+#define EFFMAP_ENTRIES      14      // Speed indexes from the minimum up
+#define EFFMAP_SETTLE_S     60
+#define EFFMAP_MEASURE_S    120
+#define EFFMAP_SCALE        64      // eff = cooling (0.01 °C/min) × EFFMAP_SCALE / W
+#define EFFMAP_WINDOW       2
+#define EFFMAP_UNDERSHOOT10 20      // Sweep stops 2.0 °C below the setpoint
+
+typedef struct {
+    uint8_t first;                  // Speed index of eff[0]
+    uint8_t count;                  // Entries in the map, 0 = none
+    uint8_t eff[EFFMAP_ENTRIES];    // 0 = no measurable cooling
+} effmap_t;
+
+// COMMS_CMD_EFFMAP status: [0] 1 = sweeping  [1] speeds measured (up and
+// down count separately)  [2] speeds to measure  [3] speed index now
+// [4] entries in the stored map
+#define EFFMAP_STATUS_SIZE  5
+
+#if EFFMAP_ENABLE
+void EffMap_Initialize(void);       // After Settings_Initialize(), which owns the layout
+const effmap_t* EffMap_Get(void);
+void EffMap_Clear(void);            // Forget the map, in EEPROM too
+
+// Speed index to run instead of idx, at most max
+uint8_t EffMap_Prefer(uint8_t idx, uint8_t max);
+
+bool EffMap_Start(void);            // False while a sweep is already running
+void EffMap_Abort(void);
+bool EffMap_Sweeping(void);
+
+// Once per second while sweeping, with the compressor running at the index
+// returned by the previous call; returns the index to run at next.  The
+// map is stored when the last speed is done and EffMap_Sweeping() goes false.
+uint8_t EffMap_Tick(int16_t temp10, uint8_t comp_watts);
+
+uint8_t EffMap_GetStatus(uint8_t* buf);
+#else
+#define EffMap_Initialize()
+#define EffMap_Prefer(idx, max)     (idx)
+#define EffMap_Abort()
+#define EffMap_Sweeping()           false
+#define EffMap_Tick(temp10, comp_watts) 0
+#endif
+
+#endif /* EFFMAP_H */
@@ -0,0 +1,87 @@
+#include "energy.h"
+#include "settings.h"
+#include "journal.h"
+#include "eecommit.h"
+
+// Checkpoints are appended to the energy journal, EE_ENERGY_SLOTS records
+// in a ring, so an hourly checkpoint wears each cell once every seven hours
+static journal_t s_journal = {
+    EE_ENERGY_BASE, EE_ENERGY_SLOTS, sizeof(energy_counters_t), 0x45
+};
+
+#define MJ_PER_WH       3600000UL
+#define J_PER_WH        3600
+
+static energy_counters_t s_counters;
+static uint16_t s_comp_j;       // Compressor energy not yet a whole Wh
+static uint32_t s_total_mj;     // Total energy not yet a whole Wh
+static uint16_t s_seconds;      // Since the last checkpoint
+static bool s_dirty;
+static bool s_armed;            // Supply seen above ENERGY_REARM_MV
+
+void Energy_Initialize(void) {
+    if (!Journal_Load(&s_journal, &s_counters)) {
+        uint8_t* p = (uint8_t*)&s_counters;
+        for (uint8_t i = 0; i < sizeof(energy_counters_t); i++) p[i] = 0;
+    }
+    s_comp_j = 0;
+    s_total_mj = 0;
+    s_seconds = 0;
+    s_dirty = false;
+    s_armed = false;
+}
+
+void Energy_Tick(bool running, uint8_t comp_watts, uint16_t voltage, uint16_t fancurrent) {
+    // mV × mA = µW, so this is the fan's energy over one second in mJ
+    s_total_mj += ((uint32_t)voltage * fancurrent) / 1000;
+    if (running) {
+        s_counters.run_seconds++;
+        s_comp_j += comp_watts;
+        s_total_mj += comp_watts * 1000UL;
+        s_dirty = true;
+    }
+    if (s_comp_j >= J_PER_WH) {
+        s_comp_j -= J_PER_WH;
+        s_counters.comp_wh++;
+    }
+    if (s_total_mj >= MJ_PER_WH) {
+        s_total_mj -= MJ_PER_WH;
+        s_counters.total_wh++;
+        s_dirty = true;
+    }
+
+    if (++s_seconds >= ENERGY_CHECKPOINT_S) {
+        Energy_Checkpoint();
+    }
+}
+
+void Energy_CountStart(void) {
+    s_counters.starts++;
+    s_dirty = true;
+}
+
+bool Energy_CheckSupply(uint16_t voltage) {
+    if (voltage > ENERGY_REARM_MV) {
+        s_armed = true;
+    } else if (voltage < ENERGY_BROWNOUT_MV && s_armed) {
+        s_armed = false;
+        Energy_Checkpoint();
+        return true;
+    }
+    return false;
+}
+
+void Energy_Checkpoint(void) {
+    if (s_dirty) {
+        if (!Journal_Append(&s_journal, &s_counters)) {
+            s_seconds = ENERGY_CHECKPOINT_S; // Queue full, Energy_Tick() tries again
+            return;
+        }
+        s_dirty = false;
+    }
+    s_seconds = 0;
+}
+
+const energy_counters_t* Energy_Get(void) {
+    return &s_counters;
+}
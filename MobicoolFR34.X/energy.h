@@ -0,0 +1,43 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Energy metering ───────────────────────────────────────────────────────
+//
+// Integrates the measured loads once per second: the compressor power from
+// AnalogGetCompPower() and the fan (supply voltage × fan current).  The
+// counters live in RAM and are checkpointed to EEPROM every
+// ENERGY_CHECKPOINT_S and when the supply collapses below ENERGY_BROWNOUT_MV.
+
+#define ENERGY_CHECKPOINT_S     3600    // Seconds between EEPROM checkpoints
+#define ENERGY_BROWNOUT_MV      8000    // Supply level treated as power going away
+#define ENERGY_REARM_MV         9000    // ...and back again
+
+typedef struct {
+    uint32_t comp_wh;       // Compressor energy, Wh
+    uint32_t total_wh;      // Compressor and fan energy, Wh
+    uint32_t run_seconds;   // Compressor run time
+    uint32_t starts;        // Compressor starts
+} energy_counters_t;
+
+// Load the last checkpoint, or start from zero when there is none
+void Energy_Initialize(void);
+
+// Once per second
+void Energy_Tick(bool running, uint8_t comp_watts, uint16_t voltage, uint16_t fancurrent);
+
+void Energy_CountStart(void);
+
+// Brown-out warning: checkpoint once when the supply drops below
+// ENERGY_BROWNOUT_MV; true when that happened, so other state can be saved
+bool Energy_CheckSupply(uint16_t voltage);
+
+// Queue the counters for EEPROM if they changed since the last checkpoint.
+// If the commit queue is full the checkpoint is retried every Energy_Tick().
+void Energy_Checkpoint(void);
+
+const energy_counters_t* Energy_Get(void);
+
+#endif /* ENERGY_H */
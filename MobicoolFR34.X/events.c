@@ -0,0 +1,51 @@
+#include "events.h"
+#include "ring.h"
+
+#if EVENTS_QUEUE_SIZE & RING_MASK(EVENTS_QUEUE_SIZE)
+#error "EVENTS_QUEUE_SIZE must be a power of two"
+#endif
+
+static event_t s_queue[EVENTS_QUEUE_SIZE];
+static uint8_t s_head;      // Next free slot
+static uint8_t s_count;
+static uint8_t s_lost;
+
+void Events_Initialize(void) {
+    s_head = 0;
+    s_count = 0;
+    s_lost = 0;
+}
+
+void Events_Post(event_type_t type, uint8_t arg) {
+    s_queue[s_head].type = (uint8_t)type;
+    s_queue[s_head].arg = arg;
+    s_head = RING_NEXT(s_head, EVENTS_QUEUE_SIZE);
+    if (s_count < EVENTS_QUEUE_SIZE) {
+        s_count++;
+    } else if (s_lost < 255) {
+        s_lost++;   // The oldest one was just overwritten
+    }
+}
+
+bool Events_Pending(void) {
+    return s_count != 0 || s_lost != 0;
+}
+
+uint8_t Events_Count(void) {
+    return s_count;
+}
+
+uint8_t Events_Drain(event_t* out, uint8_t max) {
+    uint8_t n = 0;
+    while (s_count && n < max) {
+        out[n++] = s_queue[RING_OLDEST(s_head, s_count, EVENTS_QUEUE_SIZE)];
+        s_count--;
+    }
+    return n;
+}
+
+uint8_t Events_TakeLost(void) {
+    uint8_t lost = s_lost;
+    s_lost = 0;
+    return lost;
+}
@@ -0,0 +1,43 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Event queue ───────────────────────────────────────────────────────────
+//
+// Things the companion should hear about before its next telemetry poll
+// would show them, or that telemetry does not show at all.  While the FIFO
+// holds any, every v2 response carries COMMS_FLAG_EVENT and
+// COMMS_CMD_GET_EVENTS drains it.  When it is full the oldest event makes
+// way and the loss is counted.
+
+#define EVENTS_QUEUE_SIZE   8   // power of two
+
+typedef enum {
+    EVENT_SETPOINT = 1,     // Set on the keypad; arg: new setpoint, whole °C (int8)
+    EVENT_POWER,            // Switched on or off on the keypad; arg: 1 = on
+    EVENT_BATTLOW,          // Battery cut-out; arg: 1 = tripped, 0 = cleared
+    EVENT_COMPRESSOR,       // Compressor state machine; arg: 0 lockout, 1 off, 2 starting, 3 running
+    EVENT_KEYS,             // Keys went down; arg: KEY_* bitmap
+    EVENT_MOTOR,            // IRMCF183 command link; arg: comp_link_t, 0 = OK
+    EVENT_SUPPLY_R          // Supply resistance estimate moved; arg: 10 mOhm
+} event_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t arg;
+} event_t;
+
+void Events_Initialize(void);
+void Events_Post(event_type_t type, uint8_t arg);
+bool Events_Pending(void);     // Events queued, or lost since the last drain
+uint8_t Events_Count(void);
+
+// Move up to max events, oldest first, into out; returns how many
+uint8_t Events_Drain(event_t* out, uint8_t max);
+
+// Events pushed out of a full queue since the last call (saturates at 255)
+uint8_t Events_TakeLost(void);
+
+#endif /* EVENTS_H */
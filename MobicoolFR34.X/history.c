@@ -0,0 +1,91 @@
+#include "history.h"
+#include <stddef.h>
+
+static history_entry_t s_ring[HISTORY_ENTRIES];
+static uint8_t s_next;          // Slot the next entry goes to
+static uint8_t s_held;          // Valid entries in the ring
+static uint16_t s_number;       // Entries recorded since reset
+
+// Accumulated over the current period
+static uint16_t s_seconds;
+static int16_t s_temp_min, s_temp_max;
+static int32_t s_temp_sum;
+static uint16_t s_running;
+static uint32_t s_power_sum;
+static uint32_t s_voltage_sum;
+
+// Tenths of a degree to half degrees, rounded to nearest
+static int8_t half_degrees(int16_t temp10) {
+    return (int8_t)(temp10 < 0 ? (temp10 - 2) / 5 : (temp10 + 2) / 5);
+}
+
+// Half degrees between two readings, as a nibble of temp_span
+static uint8_t span_nibble(int16_t high10, int16_t low10) {
+    int16_t d = half_degrees(high10) - half_degrees(low10);
+    return d > 15 ? 15 : (uint8_t)d;
+}
+
+static void period_start(void) {
+    s_seconds = 0;
+    s_temp_sum = 0;
+    s_running = 0;
+    s_power_sum = 0;
+    s_voltage_sum = 0;
+}
+
+void History_Initialize(void) {
+    s_next = 0;
+    s_held = 0;
+    s_number = 0;
+    period_start();
+}
+
+void History_Tick(int16_t temp10, bool running, uint8_t comp_watts, uint16_t voltage) {
+    if (s_seconds == 0 || temp10 < s_temp_min) s_temp_min = temp10;
+    if (s_seconds == 0 || temp10 > s_temp_max) s_temp_max = temp10;
+    s_temp_sum += temp10;
+    if (running) {
+        s_running++;
+        s_power_sum += comp_watts;
+    }
+    s_voltage_sum += voltage;
+    if (++s_seconds < HISTORY_PERIOD_S) return;
+
+    history_entry_t* e = &s_ring[s_next];
+    int16_t avg = (int16_t)(s_temp_sum / HISTORY_PERIOD_S);
+    e->temp_avg = half_degrees(avg);
+    e->temp_span = (uint8_t)(span_nibble(s_temp_max, avg) << 4 | span_nibble(avg, s_temp_min));
+    e->duty = (uint8_t)((s_running * 100U + HISTORY_PERIOD_S / 2) / HISTORY_PERIOD_S);
+    e->power = (uint8_t)((s_power_sum + HISTORY_PERIOD_S / 2) / HISTORY_PERIOD_S);
+    uint32_t mv = s_voltage_sum / HISTORY_PERIOD_S;
+    e->voltage = mv >= 255UL * 200 ? 255 : (uint8_t)((mv + 100) / 200);
+
+    if (++s_next == HISTORY_ENTRIES) s_next = 0;
+    if (s_held < HISTORY_ENTRIES) s_held++;
+    s_number++;
+    period_start();
+}
+
+uint8_t History_GetPage(uint8_t page, uint8_t* buf) {
+    uint8_t first = (uint8_t)(page * HISTORY_PAGE_ENTRIES);
+    if (page != 0 && (page >= HISTORY_ENTRIES || first >= s_held)) return 0;
+
+    buf[0] = (uint8_t)s_number;
+    buf[1] = (uint8_t)(s_number >> 8);
+    buf[2] = s_held;
+    uint8_t* p = &buf[3];
+    for (uint8_t i = 0; i < HISTORY_PAGE_ENTRIES; i++) {
+        uint8_t back = (uint8_t)(first + i);
+        const uint8_t* src = NULL;
+        if (back < s_held) {
+            // s_next - 1 is the newest entry
+            uint8_t slot = (uint8_t)(s_next + HISTORY_ENTRIES - 1 - back);
+            if (slot >= HISTORY_ENTRIES) slot -= HISTORY_ENTRIES;
+            src = (const uint8_t*)&s_ring[slot];
+        }
+        for (uint8_t k = 0; k < sizeof(history_entry_t); k++) {
+            *p++ = src ? src[k] : 0;
+        }
+    }
+    return (uint8_t)HISTORY_PAGE_SIZE;
+}
@@ -0,0 +1,56 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Telemetry history ─────────────────────────────────────────────────────
+//
+// One aggregate per HISTORY_PERIOD_S of the once-per-second readings, kept
+// in a RAM ring of the last HISTORY_ENTRIES periods, so the companion can
+// fetch what it missed while it was away (COMMS_CMD_GET_HISTORY).  The
+// PIC16F1829 has no High-Endurance Flash, and 10k-cycle program flash or
+// the EEPROM journals are no place for a five-minute log, so the ring does
+// not survive a reset.  48 entries of 5 bytes cover the last 4 hours.
+
+// 0 leaves the history out of the build (Makefile FEATURES): GET_HISTORY
+// then gets the answer of an unknown command
+#ifndef HISTORY_ENABLE
+#define HISTORY_ENABLE      1
+#endif
+
+#define HISTORY_PERIOD_S    300
+#define HISTORY_ENTRIES     48
+
+typedef struct {
+    int8_t  temp_avg;   // Cabinet temperature, 0.5 °C
+    uint8_t temp_span;  // Max above (bits 7-4) and min below (bits 3-0) the
+                        // average, 0.5 °C, 15 for that much or more
+    uint8_t duty;       // Compressor running, % of the period
+    uint8_t power;      // Compressor power averaged over the period, W
+    uint8_t voltage;    // Supply voltage, 0.2 V
+} history_entry_t;
+
+// GET_HISTORY page: [0-1] number of the newest entry (entries recorded since
+// reset, uint16 LE)  [2] entries held  [3..] HISTORY_PAGE_ENTRIES entries,
+// newest first from entry page × HISTORY_PAGE_ENTRIES back, each
+// history_entry_t as above; slots past the oldest entry are zero.  A page
+// is as many entries as fit COMMS_MAX_RESPONSE.
+#define HISTORY_PAGE_ENTRIES 5
+#define HISTORY_PAGE_SIZE   (3 + HISTORY_PAGE_ENTRIES * sizeof(history_entry_t))
+
+#if HISTORY_ENABLE
+void History_Initialize(void);
+
+// Once per second
+void History_Tick(int16_t temp10, bool running, uint8_t comp_watts, uint16_t voltage);
+
+// Fill buf (HISTORY_PAGE_SIZE bytes) with a page; returns its length, or 0
+// past the oldest entry.  Page 0 is always there, if only to say it is empty.
+uint8_t History_GetPage(uint8_t page, uint8_t* buf);
+#else
+#define History_Initialize()
+#define History_Tick(temp10, running, comp_watts, voltage)
+#endif
+
+#endif /* HISTORY_H */
@@ -23,34 +23,161 @@ static const uint8_t s_supported_speeds[] = { 3, 6, 9, 17, 19, 22, 25, 33, 35, 3
                                               49, 51, 54, 57, 65, 67, 70, 73, 81, 83 };
 #define NUM_SPEEDS (sizeof(s_supported_speeds) / sizeof(s_supported_speeds[0]))
 
+#define IRMC_SYNC       0xE1
+#define IRMC_FRAME_LEN  8
+
+static const uint8_t s_header[] = { IRMC_SYNC, 0xEB, 0x90 };
+
 static bool s_compressor_on = false;
 
-static void UART_Xmit(uint8_t* buf, uint8_t len) {
-    uint8_t chksum = 0;
-    for (uint8_t i = 0; i < len; i++) {
-        chksum += buf[i];
-        while (!EUSART_is_tx_ready());
-        EUSART_Write(buf[i]);
+// Last command handed to the EUSART, and what to send next
+static uint8_t s_sent_on, s_sent_speed;
+static uint8_t s_want_on, s_want_speed;
+static bool s_resend;
+static uint8_t s_keepalive;
+
+// Outcome of the command in flight
+static bool s_pending;
+static sched_stamp_t s_sent_at;
+static volatile bool s_waiting;     // Reply timing armed, cleared by the first byte
+static volatile bool s_in_time;
+static volatile uint16_t s_latency;
+static bool s_acked, s_garbled;
+
+// Reply parser
+static uint8_t s_rx[IRMC_FRAME_LEN];
+static uint8_t s_rxlen;
+
+static comp_link_t s_link = COMP_LINK_OK;
+static uint8_t s_fails;
+static sched_stat_t s_ackstat;
+static uint8_t s_missed;
+
+// Receive interrupt: time the first reply byte, then buffer it as usual
+static void comp_rx_isr(void) {
+    if (s_waiting) {
+        s_waiting = false;
+        if ((uint8_t)(Scheduler_GetTicks() - s_sent_at.ticks) < SCHED_MS(COMP_ACK_TIMEOUT_MS)) {
+            s_latency = Scheduler_Elapsed(&s_sent_at);
+            s_in_time = true;
+        }
+    }
+    EUSART_Receive_ISR();
+}
+
+static void send_frame(uint8_t on, uint8_t speed) {
+    uint8_t buf[IRMC_FRAME_LEN] = { IRMC_SYNC, 0xeb, 0x90, on, speed, 0x00, 0x00, 0x00 };
+
+    // Whatever is still coming back belongs to the previous command
+    while (EUSART_is_rx_ready()) EUSART_Read();
+    s_rxlen = 0;
+    s_acked = s_garbled = false;
+    s_in_time = false;
+    Scheduler_Stamp(&s_sent_at);
+    s_waiting = true;
+    s_pending = true;
+
+    for (uint8_t i = 0; i < IRMC_FRAME_LEN - 1; i++) buf[IRMC_FRAME_LEN - 1] += buf[i];
+    for (uint8_t i = 0; i < IRMC_FRAME_LEN; i++) EUSART_Write(buf[i]);
+
+    s_sent_on = on;
+    s_sent_speed = speed;
+    s_resend = false;
+    s_keepalive = COMP_KEEPALIVE_S;
+}
+
+static void send_wanted(void) {
+    // EUSART_Write() blocks once the transmit buffer is full; unless all
+    // IRMC_FRAME_LEN bytes fit, leave the change to Compressor_Service()
+    if (EUSART_is_tx_ready() < IRMC_FRAME_LEN) {
+        s_resend = true;
+        return;
     }
-    while (!EUSART_is_tx_ready());
-    EUSART_Write(chksum);
+    send_frame(s_want_on, s_want_speed);
+}
+
+// 0xE1 alone is an ack; a longer reply must be a whole frame with a good sum
+static void parse_reply(uint8_t b) {
+    if (s_rxlen == 0 || (s_rxlen == 1 && b == IRMC_SYNC)) {
+        s_rxlen = 0;
+        if (b != IRMC_SYNC) {
+            s_garbled = true;
+            return;
+        }
+        s_acked = true;
+    } else if (s_rxlen < sizeof(s_header) && b != s_header[s_rxlen]) {
+        s_garbled = true;
+        s_rxlen = 0;
+        return;
+    }
+    s_rx[s_rxlen++] = b;
+    if (s_rxlen < IRMC_FRAME_LEN) return;
+
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < IRMC_FRAME_LEN - 1; i++) sum += s_rx[i];
+    if (sum != s_rx[IRMC_FRAME_LEN - 1]) s_garbled = true;
+    s_rxlen = 0;
+}
+
+static void command_done(void) {
+    s_pending = false;
+    s_waiting = false;
+    if (s_acked && s_in_time && !s_garbled) {
+        Scheduler_StatAdd(&s_ackstat, s_latency);
+        s_fails = 0;
+        s_link = COMP_LINK_OK;
+        return;
+    }
+    if (s_missed < 255) s_missed++;
+    s_resend = true;
+    if (s_fails < COMP_LINK_FAILS) s_fails++;
+    if (s_fails == COMP_LINK_FAILS) s_link = s_garbled ? COMP_LINK_GARBLED : COMP_LINK_SILENT;
 }
 
 void Compressor_Init(void) {
-    UART_Xmit( (uint8_t[]){0xe1, 0xeb, 0x90, 0x00, 0x00, 0x00, 0x00}, 7);
+    EUSART_SetRxInterruptHandler(comp_rx_isr);
+    s_want_on = 0;
+    s_want_speed = 0;
+    send_frame(0, 0);
+    // The scheduler clock is not running yet, so leave this one untimed
+    // and unsupervised; the first keepalive checks the link
+    s_waiting = false;
+    s_pending = false;
 }
 
 void Compressor_OnOff(bool on, bool fanon, uint8_t speedidx) {
     IO_DCDCEna_LAT = fanon;
     IO_FanEna_LAT = fanon;
     IO_Comp12VCtrl_LAT = fanon;
-    uint8_t newspeed = 0;
     if (speedidx >= NUM_SPEEDS) speedidx = NUM_SPEEDS - 1;
-    newspeed = s_supported_speeds[speedidx];
-    UART_Xmit( (uint8_t[]){0xe1, 0xeb, 0x90, on ? 1 : 0, newspeed, 0x00, 0x00}, 7);
+    s_want_on = on ? 1 : 0;
+    s_want_speed = s_supported_speeds[speedidx];
+    if (s_want_on != s_sent_on || s_want_speed != s_sent_speed) send_wanted();
     s_compressor_on = on;
 }
 
+void Compressor_Service(void) {
+    while (EUSART_is_rx_ready()) parse_reply(EUSART_Read());
+
+    if (s_pending && (uint8_t)(Scheduler_GetTicks() - s_sent_at.ticks) >= SCHED_MS(COMP_ACK_TIMEOUT_MS)) {
+        command_done();
+    }
+    if (s_keepalive) s_keepalive--;
+    if (!s_pending && (s_resend || s_keepalive == 0)) send_wanted();
+}
+
+comp_link_t Compressor_GetLink(void) {
+    return s_link;
+}
+
+const sched_stat_t* Compressor_GetAckStat(void) {
+    return &s_ackstat;
+}
+
+uint8_t Compressor_GetMissedAcks(void) {
+    return s_missed;
+}
+
 bool Compressor_IsOn(void) {
     return s_compressor_on;
 }
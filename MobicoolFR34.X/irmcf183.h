@@ -1,9 +1,36 @@
 #ifndef IRMCF183_H
 #define	IRMCF183_H
 
+#include "scheduler.h"
+
+// ── Command link supervision ──────────────────────────────────────────────
+//
+// A command frame only goes out when the on/off state or speed changes, when
+// the previous one went unanswered, and every COMP_KEEPALIVE_S otherwise.
+// The controller answers each frame with 0xE1, or a whole frame laid out like
+// the command; anything else counts as a garbled reply.  After
+// COMP_LINK_FAILS commands in a row without a clean answer the link is
+// reported as failed until the next one gets through.
+
+#define COMP_KEEPALIVE_S    10
+#define COMP_ACK_TIMEOUT_MS 50      // Command queued to first reply byte, < 65 ms
+#define COMP_LINK_FAILS     3
+
+typedef enum {
+    COMP_LINK_OK = 0,
+    COMP_LINK_SILENT,       // No reply at all, controller missing or unpowered
+    COMP_LINK_GARBLED       // Replies that do not parse, wrong baud or a faulty controller
+} comp_link_t;
+
 void Compressor_Init(void);
 void Compressor_OnOff(bool on, bool fanon, uint8_t speedidx);
 bool Compressor_IsOn(void);
+
+// Once per second: check the last command was answered, retry or keep alive
+void Compressor_Service(void);
+comp_link_t Compressor_GetLink(void);
+const sched_stat_t* Compressor_GetAckStat(void);    // Command to 0xE1, µs
+uint8_t Compressor_GetMissedAcks(void);             // Commands not answered cleanly (saturating)
 uint8_t Compressor_GetMinSpeedIdx(void);
 uint8_t Compressor_GetMaxSpeedIdx(void);
 uint8_t Compressor_GetDefaultSpeedIdx(void);
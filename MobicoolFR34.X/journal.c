@@ -0,0 +1,79 @@
+#include "journal.h"
+#include "crc8.h"
+#include "eecommit.h"
+
+#define RECORD_SIZE(j)      ((uint8_t)((j)->size + JOURNAL_OVERHEAD))
+#define RECORD_ADDR(j, n)   ((uint8_t)((j)->base + (n) * RECORD_SIZE(j)))
+
+// CRC of one record in place; *seq gets its sequence number
+static bool record_valid(const journal_t* journal, uint8_t slot, uint8_t* seq) {
+    uint8_t addr = RECORD_ADDR(journal, slot);
+    uint8_t crc = Crc8(journal->id, *seq = EECommit_Read(addr++));
+    for (uint8_t i = 0; i < journal->size; i++) {
+        crc = Crc8(crc, EECommit_Read(addr++));
+    }
+    return EECommit_Read(addr) == crc;
+}
+
+bool Journal_Load(journal_t* journal, void* payload) {
+    bool found = false;
+    uint8_t newest = 0;
+
+    for (uint8_t slot = 0; slot < journal->slots; slot++) {
+        uint8_t seq;
+        if (!record_valid(journal, slot, &seq)) continue;
+        if (!found || (uint8_t)(seq - journal->seq) < 0x80) {
+            journal->seq = seq;
+            newest = slot;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        journal->seq = 0;
+        journal->next = 0;
+        return false;
+    }
+
+    uint8_t addr = RECORD_ADDR(journal, newest) + 1;
+    uint8_t* p = (uint8_t*)payload;
+    for (uint8_t i = 0; i < journal->size; i++) {
+        p[i] = EECommit_Read(addr++);
+    }
+    journal->next = (uint8_t)(newest + 1 == journal->slots ? 0 : newest + 1);
+    return true;
+}
+
+void Journal_Format(journal_t* journal) {
+    static const uint8_t erased = 0xFF; // Cells already erased are skipped by the queue
+    uint8_t addr = journal->base;
+    for (uint8_t n = journal->slots * RECORD_SIZE(journal); n; n--, addr++) {
+        if (!EECommit_Write(addr, &erased, 1)) {
+            EECommit_Flush();
+            EECommit_Write(addr, &erased, 1);
+        }
+    }
+    journal->seq = 0;
+    journal->next = 0;
+}
+
+bool Journal_Append(journal_t* journal, const void* payload) {
+    uint8_t record[JOURNAL_MAX_PAYLOAD + JOURNAL_OVERHEAD];
+    const uint8_t* p = (const uint8_t*)payload;
+    uint8_t seq = (uint8_t)(journal->seq + 1);
+    uint8_t crc = Crc8(journal->id, seq);
+
+    record[0] = seq;
+    for (uint8_t i = 0; i < journal->size; i++) {
+        record[i + 1] = p[i];
+        crc = Crc8(crc, p[i]);
+    }
+    record[journal->size + 1] = crc;
+    if (!EECommit_Write(RECORD_ADDR(journal, journal->next), record, RECORD_SIZE(journal))) {
+        return false;
+    }
+
+    journal->seq = seq;
+    if (++journal->next == journal->slots) journal->next = 0;
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Log-structured EEPROM records ─────────────────────────────────────────
+//
+// A journal is a ring of fixed-size records in data EEPROM:
+//   [SEQ] [PAYLOAD×size] [CRC8]
+// Every save appends a record to the next slot instead of rewriting one
+// address, so the wear is spread over the whole ring.  On startup the
+// newest record with a good CRC wins; a record torn by a power loss fails
+// its CRC and the one before it is used.  SEQ is compared in serial-number
+// arithmetic, so it may wrap as long as a ring has fewer than 128 slots.
+//
+// CRC-8 (crc8.h) is polynomial 0x07 seeded with the journal id, so one journal never
+// accepts a record from another or from erased (0xFF) cells.
+//
+// Writes go through the EEPROM commit queue (eecommit.h).  A record is
+// queued whole, CRC last, so it only becomes valid once all of it is in.
+
+#define JOURNAL_OVERHEAD    2   // SEQ and CRC8 bytes per record
+#define JOURNAL_MAX_PAYLOAD 16
+
+typedef struct {
+    uint8_t base;       // First EEPROM address of the ring
+    uint8_t slots;      // Number of records in the ring
+    uint8_t size;       // Payload bytes per record
+    uint8_t id;         // CRC seed
+    uint8_t next;       // Slot the next record goes to
+    uint8_t seq;        // Sequence number of the newest record
+} journal_t;
+
+// Find the newest valid record and copy its payload out; false if there is none
+bool Journal_Load(journal_t* journal, void* payload);
+
+// Erase the ring and start it over; waits for the queue as needed (startup only)
+void Journal_Format(journal_t* journal);
+
+// Queue a record with the next sequence number.  False, and the journal is
+// left as it was, if the commit queue has no room for it; try again later.
+bool Journal_Append(journal_t* journal, const void* payload);
+
+#endif /* JOURNAL_H */
@@ -0,0 +1,95 @@
+#include "keys.h"
+#include "tm1620b.h"
+#include "settings.h"
+#include "ring.h"
+
+#if KEYS_QUEUE_SIZE & RING_MASK(KEYS_QUEUE_SIZE)
+#error "KEYS_QUEUE_SIZE must be a power of two"
+#endif
+
+#define SCANS(ms)       ((uint8_t)((ms) / KEYS_SCAN_MS))
+#define LONG_SCANS      SCANS(LONG_PRESS_TIME * 100)
+#define REPEATING       (KEY_PLUS | KEY_MINUS)
+
+static key_event_t s_queue[KEYS_QUEUE_SIZE];
+static uint8_t s_head;      // Next free slot
+static uint8_t s_count;
+
+static uint8_t s_raw;       // Last reading
+static uint8_t s_stable;    // Scans it has held, up to KEYS_DEBOUNCE
+static uint8_t s_state;     // Debounced
+
+static uint8_t s_timed;     // Key being timed for long press / repeat, 0 = none
+static uint8_t s_timer;     // Scans to its next long press or repeat
+static uint8_t s_interval;  // Current repeat interval, scans
+static uint8_t s_repeats;   // Repeats at this interval
+
+static void post(key_ev_kind_t kind, uint8_t key) {
+    if (s_count == KEYS_QUEUE_SIZE) return; // Nobody is reading; keep the oldest
+    s_queue[s_head].kind = (uint8_t)kind;
+    s_queue[s_head].key = key;
+    s_head = RING_NEXT(s_head, KEYS_QUEUE_SIZE);
+    s_count++;
+}
+
+void Keys_Initialize(void) {
+    s_head = 0;
+    s_count = 0;
+    s_raw = 0;
+    s_stable = 0;
+    s_state = 0;
+    s_timed = 0;
+}
+
+void Keys_Scan(void) {
+    uint8_t raw = TM1620B_GetKeys();
+    if (raw != s_raw) {
+        s_raw = raw;
+        s_stable = 0;
+    }
+    if (s_stable < KEYS_DEBOUNCE) s_stable++;
+
+    if (s_stable == KEYS_DEBOUNCE && raw != s_state) {
+        uint8_t changed = raw ^ s_state;
+        s_state = raw;
+        for (uint8_t key = 1; key <= KEY_ONOFF; key <<= 1) {
+            if (!(changed & key)) continue;
+            if (raw & key) {
+                post(KEY_EV_PRESS, key);
+                s_timed = key;
+                s_timer = (key & REPEATING) ? SCANS(KEYS_REPEAT_MS) : LONG_SCANS;
+                s_interval = SCANS(KEYS_REPEAT_SLOW_MS);
+                s_repeats = 0;
+            } else {
+                post(KEY_EV_RELEASE, key);
+                if (key == s_timed) s_timed = 0;
+            }
+        }
+        return;
+    }
+
+    if (!s_timed || --s_timer) return;
+    if (!(s_timed & REPEATING)) {
+        post(KEY_EV_LONG, s_timed);
+        s_timed = 0; // Once per press
+        return;
+    }
+    post(KEY_EV_REPEAT, s_timed);
+    if (++s_repeats == KEYS_REPEAT_ACCEL && s_interval > SCANS(KEYS_REPEAT_FAST_MS)) {
+        s_interval >>= 1;
+        if (s_interval < SCANS(KEYS_REPEAT_FAST_MS)) s_interval = SCANS(KEYS_REPEAT_FAST_MS);
+        s_repeats = 0;
+    }
+    s_timer = s_interval;
+}
+
+bool Keys_GetEvent(key_event_t* ev) {
+    if (!s_count) return false;
+    *ev = s_queue[RING_OLDEST(s_head, s_count, KEYS_QUEUE_SIZE)];
+    s_count--;
+    return true;
+}
+
+uint8_t Keys_Held(void) {
+    return s_state;
+}
@@ -0,0 +1,48 @@
+#ifndef KEYS_H
+#define KEYS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Key event engine ──────────────────────────────────────────────────────
+//
+// Keys_Scan() reads the TM1620B keypad every KEYS_SCAN_MS from the keys
+// task.  A new reading only counts once it has held for KEYS_DEBOUNCE scans,
+// and the debounced state is turned into press and release events.  A key
+// held for LONG_PRESS_TIME gets a long-press event, except +/-, which
+// auto-repeat instead: first after KEYS_REPEAT_MS, then every
+// KEYS_REPEAT_SLOW_MS, halving every KEYS_REPEAT_ACCEL repeats down to
+// KEYS_REPEAT_FAST_MS.  Only the most recently pressed key is timed.
+
+#define KEYS_SCAN_MS        20
+#define KEYS_DEBOUNCE       2       // Scans, 40 ms
+#define KEYS_REPEAT_MS      500
+#define KEYS_REPEAT_SLOW_MS 240
+#define KEYS_REPEAT_FAST_MS 60
+#define KEYS_REPEAT_ACCEL   4
+#define KEYS_QUEUE_SIZE     8       // power of two
+
+typedef enum {
+    KEY_EV_PRESS = 0,
+    KEY_EV_RELEASE,
+    KEY_EV_LONG,
+    KEY_EV_REPEAT
+} key_ev_kind_t;
+
+typedef struct {
+    uint8_t kind;   // key_ev_kind_t
+    uint8_t key;    // One KEY_* bit
+} key_event_t;
+
+void Keys_Initialize(void);
+
+// Every KEYS_SCAN_MS
+void Keys_Scan(void);
+
+// Take the oldest event; false when there is none
+bool Keys_GetEvent(key_event_t* ev);
+
+// Debounced KEY_* bitmap
+uint8_t Keys_Held(void);
+
+#endif /* KEYS_H */
@@ -23,6 +23,16 @@
 #include "settings.h"
 #include "display.h"
 #include "tm1620b.h"
+#include "scheduler.h"
+#include "energy.h"
+#include "history.h"
+#include "events.h"
+#include "effmap.h"
+#include "keys.h"
+#include "eecommit.h"
+#include "standby.h"
+#include "warmstart.h"
+#include "cycles.h"
 
 
 typedef enum {
@@ -52,6 +62,13 @@ typedef struct {
     uint8_t fanspin;
     bool running;
     pmode_t pmode;
+    int32_t integral;   // PI integrator, speed index << PI_SHIFT
+    uint8_t ramp;       // Soft-start ceiling, speed index
+    uint8_t ramp_timer; // Seconds to the next step up
+    int16_t rest_volt;  // Supply before the start, 0.1 V
+    int16_t volt;       // Supply now, 0.1 V (from battery_context_t)
+    int16_t ocv;        // Supply with the load sag added back, 0.1 V
+    int16_t cutout;     // Active battery cut-out, 0.1 V, 0 = not known yet
 } compressor_context_t;
 
 typedef struct {
@@ -62,12 +79,22 @@ typedef struct {
     int16_t tempacc;
     uint8_t numtemps;
     int16_t temp_rate_tick;
+    bool valid;         // temperature10 holds a reading since the reset
 } temp_context_t;
 
 typedef struct {
     uint32_t voltacc;
+    uint16_t poweracc;  // Compressor power over the same samples, W
+    uint16_t fanacc;    // Fan current over the same samples, mA
     uint8_t numvolts;
+    bool powerbad;      // A power reading in the average was out of range
     bool battlow;
+    int16_t volt;       // Last average, 0.1 V
+    int16_t ocv;        // Last average with the load sag added back, 0.1 V
+    int16_t cutout;     // Cut-out of the matching battery level, 0.1 V
+    uint16_t last_mv;   // Previous average and load current, 0 = none
+    uint16_t last_ma;
+    uint16_t rint;      // Source resistance estimate, mOhm, 0 = not known yet
 } battery_context_t;
 
 #define THRESH_12V_24V (170) // Over 17.0V == 24V system, below == 12V system
@@ -83,36 +110,123 @@ static const battlevel_t levels[] = {
 };
 #define NUM_BMON_LEVELS (sizeof(levels) / sizeof(levels[0]))
 
+// Load compensation: the battery and its cable are taken as an open-circuit
+// voltage behind a resistance.  Whenever the load current changes by enough
+// between two successive averages (compressor start, stop, speed steps),
+// the voltage step over the current step gives the resistance, and the
+// cut-out decisions then use the voltage with I x R added back.  A loaded
+// battery that sags under the compressor keeps running until its charge,
+// not its wiring, says otherwise.
+#define RINT_MIN_STEP   700     // mA between successive averages to take a reading
+#define RINT_MAX        1500    // mOhm; a bigger step is another load, not the source
+#define RINT_MAX_COMP   3       // Never add back more than 1/8 of the reading
+
+// Compressor speed PI controller, run once per second while the compressor runs.
+// Output and integrator are speed indexes in Q12; the error is in tenths of a
+// degree and the feed-forward works on temp_rate (tenths per minute), so a
+// cabinet that is already cooling quickly gets less speed before it overshoots.
+#define PI_SHIFT 12
+
+typedef struct {
+    int16_t kp; // Speed per 0.1C of error
+    int16_t ki; // Speed per 0.1C of error, per second
+    int16_t kf; // Speed per 0.1C/min of temperature slope
+} pi_gains_t;
+
+static const pi_gains_t gains[] = { // Indexed by pmode_t
+    { 205, 3, 1024 },   // PMODE_ECO: 0.5 step/C, ~0.4 step/min per C
+    { 410, 7, 2048 },   // PMODE_NORMAL: 1 step/C, ~1 step/min per C
+    { 1638, 14, 0 },    // PMODE_HI: 4 steps/C, pinned at max during pull-down
+};
+
+// Soft-start: the speed is capped by a ceiling that starts a few indexes
+// above the minimum and climbs one index at a time, and only while the
+// compressor power and the supply sag since the start stay inside the
+// budget.  Over budget, or too close to the battery cut-out, the ceiling
+// drops below the current speed, one index per second.  A weak battery or
+// a long cable then settles at a speed the supply can carry instead of
+// tripping the cut-out.
+typedef struct {
+    uint8_t start;      // Ceiling at start, speed indexes above the minimum
+    uint8_t step;       // Seconds per index
+    uint8_t power;      // Compressor power budget, W
+    uint8_t sag;        // Supply sag budget, 0.1 V
+} ramp_profile_t;
+
+static const ramp_profile_t ramps[] = { // Indexed by pmode_t
+    { 0, 4, HIGH_POWER_THRESHOLD_ECO, 8 },  // PMODE_ECO
+    { 0, 2, HIGH_POWER_THRESHOLD, 10 },     // PMODE_NORMAL
+    { 3, 1, 255, 15 },                      // PMODE_HI: no power limit, as before
+};
+
+#define RAMP_HEADROOM 3     // Back off within 0.3V of the battery cut-out
+#define RAMP_HOLDOFF 30     // Seconds after a back-off before stepping up again
+
+// Task periods and deadlines, in scheduler ticks
+#define TASK_COMMS_PERIOD     1              // every tick, keeps the RX ring drained
+#define TASK_ANALOG_PERIOD    SCHED_MS(50)
+#define TASK_KEYS_PERIOD      SCHED_MS(KEYS_SCAN_MS)
+#define TASK_DISPLAY_PERIOD   SCHED_MS(100)
+#define TASK_CONTROL_PERIOD   SCHED_MS(1000)
+
+// Application state, shared between the scheduler tasks
+static display_context_t display;
+static temp_context_t temp;
+static battery_context_t battery;
+static compressor_context_t comp = {
+    .state = COMP_LOCKOUT,
+    .timer = 20,
+    .speed = 0,
+    .fanspin = 0,
+    .running = false,
+    .pmode = PMODE_NORMAL
+};
+static uint8_t keys_ticks = 0;    // Key scans since the last settings tick
+static bool standby_due = false;  // Switched off and left alone, see standby()
+static warmstart_t warm;          // Run state snapshot (warmstart.h)
+static comp_state_t reported_state = COMP_LOCKOUT;  // Last compressor state posted as an event
+static comp_link_t reported_link = COMP_LINK_OK;    // Last IRMCF183 link state posted as an event
+
 // Function declarations
-static void system_init(display_context_t* display);
+static void system_init(display_context_t* display, bool resumed);
 static void update_temperature(temp_context_t* temp);
-static bool update_battery(battery_context_t* battery, display_context_t* display, compressor_context_t* comp);
+static void update_battery(battery_context_t* battery, display_context_t* display, compressor_context_t* comp);
 static uint8_t calculate_compressor_speed(compressor_context_t* comp, temp_context_t* temp);
+static void ramp_reset(compressor_context_t* comp);
 static int16_t get_restart_threshold10(const compressor_context_t* comp);
 static int16_t get_shutdown_threshold10(const compressor_context_t* comp);
 static void update_compressor_state(compressor_context_t* comp, temp_context_t* temp, bool check_enabled);
-static void handle_key_press(uint8_t keys, uint8_t* lastkeys, uint8_t* longpress, display_context_t* display, compressor_context_t* comp);
+static void handle_key_event(const key_event_t* ev, display_context_t* display, compressor_context_t* comp);
 static void update_settings(display_context_t* display, int16_t* temp_setpoint10);
 
-static void system_init(display_context_t* display) {
+// Nothing in here waits: the analog rounds start right away and the splash
+// is a display state that the display task ends
+static void system_init(display_context_t* display, bool resumed) {
     SYSTEM_Initialize();
+    EECommit_Initialize();
+    AnalogInitialize();
+    INTERRUPT_PeripheralInterruptEnable();
+    INTERRUPT_GlobalInterruptEnable();
 
     IO_LightEna_SetHigh();
     TM1620B_Init();
-    TM1620B_Update((uint8_t[]){0, c_U, c_E, c_o, c_S});
-
-    __delay_ms(200);
+    Keys_Initialize();
     Display_Initialize();
     Compressor_Init();
     Comms_Initialize();
-    __delay_ms(1800);
 
     // Initialize settings
     settings_t settings;
+    Events_Initialize();
+    History_Initialize();
+    Cycles_Initialize();
+    Energy_Initialize();
     Settings_Initialize(&settings);
+    EffMap_Initialize();
 
-    // Initialize display context
+    // Initialize display context; a warm restart goes straight to the reading
     display->state = DISP_IDLE;
+    if (!resumed) Display_Splash(display);
     display->on = settings.on;
     display->temp_setpoint = settings.temp_setpoint;
     display->battmon = settings.battmon;
@@ -126,14 +240,34 @@ static void system_init(display_context_t* display) {
     // Sync initial state to comms
     Comms_SetTargetTemperature(display->temp_setpoint10);
     Comms_SetPowerMode((uint8_t)display->pmode);
-    
-    // Initial readings
-    AnalogUpdate();
-    display->temperature10 = AnalogGetTemperature10();
-    display->last_temp = display->temperature10;
     display->battlow = false;
 }
 
+// Pick the compressor up where a brown-out left it (warmstart.h).  A rest or
+// lockout continues with the time it had left.  A run stopped with the
+// supply, so it starts over as from a rest: the start delay, then the soft
+// start from its first step, with the PI controller seeded to match.  The
+// temperature bridges the gap to the first reading.
+static void resume(const warmstart_t* snap) {
+    temp.temperature10 = snap->temperature10;
+    temp.last_temp = snap->temperature10;
+    display.pmode = display.newpmode = (pmode_t)snap->pmode;
+    Comms_SetPowerMode(snap->pmode);
+
+    comp.pmode = display.pmode;
+    comp.state = (comp_state_t)snap->state;
+    comp.timer = snap->timer;
+    comp.fanspin = snap->fanspin;
+    if (comp.state == COMP_RUN || comp.state == COMP_STARTING) {
+        comp.state = COMP_OFF;
+        comp.timer = COMP_START_DELAY;
+        comp.fanspin = COMP_START_DELAY;
+        ramp_reset(&comp);
+        comp.speed = comp.ramp;
+        comp.integral = (int32_t)comp.ramp << PI_SHIFT;
+    }
+}
+
 static void update_temperature(temp_context_t* temp) {
     int16_t current_temp = AnalogGetTemperature10();
     
@@ -141,11 +275,18 @@ static void update_temperature(temp_context_t* temp) {
     if (current_temp < MIN_VALID_TEMP || current_temp > MAX_VALID_TEMP) {
         return; // Skip invalid readings
     }
+
+    if (!temp->valid) {
+        // First reading since the reset, until the average is in
+        temp->temperature10 = current_temp;
+        temp->last_temp = current_temp;
+        temp->valid = true;
+    }
     
     temp->tempacc += current_temp;
     temp->numtemps++;
     if (temp->numtemps == AVERAGING_SAMPLES) {
-        temp->temperature10 = (temp->tempacc + AVERAGING_ROUNDING) >> 6;
+        temp->temperature10 = (temp->tempacc + AVERAGING_ROUNDING) >> AVERAGING_SHIFT;
         // Bounds check the averaged result
         if (temp->temperature10 < MIN_VALID_TEMP) {
             temp->temperature10 = MIN_VALID_TEMP;
@@ -156,42 +297,116 @@ static void update_temperature(temp_context_t* temp) {
     }
 }
 
-static bool update_battery(battery_context_t* battery, display_context_t* display, compressor_context_t* comp) {
+// Fold one step in load current into the resistance estimate; returns the
+// load current in mA
+static uint16_t estimate_rint(battery_context_t* battery, uint16_t mv) {
+    uint16_t power = (uint16_t)((battery->poweracc + AVERAGING_ROUNDING) >> AVERAGING_SHIFT);
+    uint16_t fan = (uint16_t)((battery->fanacc + AVERAGING_ROUNDING) >> AVERAGING_SHIFT);
+    uint16_t ma = (uint16_t)((uint32_t)power * 1000000UL / mv) + fan;
+
+    if (battery->powerbad) {
+        battery->last_mv = 0;
+        return 0;
+    }
+    if (battery->last_mv) {
+        int16_t di = (int16_t)(ma - battery->last_ma);
+        int16_t dv = (int16_t)(battery->last_mv - mv);
+        if (di < 0) {
+            di = -di;
+            dv = -dv;
+        }
+        if (di >= RINT_MIN_STEP && dv >= 0) {
+            uint16_t r = (uint16_t)((uint32_t)dv * 1000 / (uint16_t)di);
+            if (r <= RINT_MAX) {
+                uint8_t reported = (uint8_t)((battery->rint + 5) / 10);
+                if (battery->rint) {
+                    battery->rint = (uint16_t)((int16_t)battery->rint + ((int16_t)(r - battery->rint) >> 2));
+                } else {
+                    battery->rint = r ? r : 1;
+                }
+                if ((uint8_t)((battery->rint + 5) / 10) != reported) {
+                    Events_Post(EVENT_SUPPLY_R, (uint8_t)((battery->rint + 5) / 10));
+                }
+            }
+        }
+    }
+    battery->last_mv = mv;
+    battery->last_ma = ma;
+    return ma;
+}
+
+static void update_battery(battery_context_t* battery, display_context_t* display, compressor_context_t* comp) {
     uint16_t voltage = AnalogGetVoltage();
-    if (voltage == 0 || voltage > 3000) { // Invalid voltage reading (>30V)
-        return false;
+    if (voltage == 0 || voltage > 30000) { // Invalid voltage reading (>30V)
+        return;
     }
+    uint8_t power = AnalogGetCompPower();
     
     battery->voltacc += voltage;
+    battery->poweracc += power;
+    battery->fanacc += AnalogGetFanCurrent();
+    if (power >= 99) battery->powerbad = true;
     battery->numvolts++;
     
     if (battery->numvolts == AVERAGING_SAMPLES) {
-        uint16_t volt = (uint16_t)((battery->voltacc + AVERAGING_ROUNDING) >> 6);
-        volt = (volt + 50) / 100; // Scale to tenths of Volts
+        uint16_t mv = (uint16_t)((battery->voltacc + AVERAGING_ROUNDING) >> AVERAGING_SHIFT);
+        uint16_t ma = estimate_rint(battery, mv);
+        uint16_t sag = (uint16_t)((uint32_t)ma * battery->rint / 1000);
+        if (sag > (mv >> RINT_MAX_COMP)) sag = mv >> RINT_MAX_COMP;
+        battery->volt = (int16_t)((mv + 50) / 100); // Scale to tenths of Volts
+        uint16_t volt = (uint16_t)((mv + sag + 50) / 100);
         bmon_volt_t supply = (volt > THRESH_12V_24V) ? BMON_24V : BMON_12V;
-        bool voltage_changed = false;
+        battery->ocv = (int16_t)volt;
         
         for (uint8_t i = 0; i < NUM_BMON_LEVELS; i++) {
             if (levels[i].level == display->battmon &&
                 (levels[i].supply == BMON_WILDCARD || levels[i].supply == supply)) {
+                battery->cutout = levels[i].cutout;
                 // Add hysteresis to prevent oscillation
                 if (volt < (levels[i].cutout - VOLTAGE_HYSTERESIS) && !display->battlow) {
                     display->battlow = true;
+                    Events_Post(EVENT_BATTLOW, 1);
                     Compressor_OnOff(false, false, 0);
                     comp->timer = COMP_LOCKOUT_TIME;
                     comp->state = COMP_LOCKOUT;
-                    voltage_changed = true;
                 } else if (volt > (levels[i].restart + VOLTAGE_HYSTERESIS) && display->battlow) {
                     display->battlow = false;
-                    voltage_changed = true;
+                    Events_Post(EVENT_BATTLOW, 0);
                 }
                 break;
             }
         }
         battery->voltacc = battery->numvolts = 0;
-        return voltage_changed;
+        battery->poweracc = battery->fanacc = 0;
+        battery->powerbad = false;
     }
-    return false;
+}
+
+// One PI step with anti-windup: the integrator is kept inside [lo, hi] and
+// stops integrating while the output is saturated in the direction of the error
+static uint8_t pi_speed(compressor_context_t* comp, const temp_context_t* temp, uint8_t lo, uint8_t hi) {
+    const pi_gains_t* g = &gains[comp->pmode];
+    int16_t tempdiff = temp->temperature10 - temp->temp_setpoint10;
+    int32_t lo_q = (int32_t)lo << PI_SHIFT;
+    int32_t hi_q = (int32_t)hi << PI_SHIFT;
+
+    int32_t integral = comp->integral;
+    if (integral > hi_q) integral = hi_q;
+    else if (integral < lo_q) integral = lo_q;
+
+    int32_t ff = (int32_t)g->kp * tempdiff + (int32_t)g->kf * temp->temp_rate;
+    int32_t out = integral + ff;
+    if (!((out >= hi_q && tempdiff > 0) || (out <= lo_q && tempdiff < 0))) {
+        integral += (int32_t)g->ki * tempdiff;
+        if (integral > hi_q) integral = hi_q;
+        else if (integral < lo_q) integral = lo_q;
+        out = integral + ff;
+    }
+    comp->integral = integral;
+
+    if (out >= hi_q) return hi;
+    if (out <= lo_q) return lo;
+    return (uint8_t)((out + (1L << (PI_SHIFT - 1))) >> PI_SHIFT);
 }
 
 static uint8_t calculate_compressor_speed(compressor_context_t* comp, temp_context_t* temp) {
@@ -214,51 +429,66 @@ static uint8_t calculate_compressor_speed(compressor_context_t* comp, temp_conte
         // Scale speed based on max power limit
         uint32_t maxSpeed = (20UL * max_power) / 100;
         speedidx = (uint8_t)((remote_power * maxSpeed) / 100);
-    } else {
-        int16_t tempdiff = (temp->temperature10 - temp->temp_setpoint10);
-        
-        if (comp->state == COMP_STARTING) {
-            speedidx = (temp->temp_setpoint10 > 0) ? min : Compressor_GetDefaultSpeedIdx();
-        } else if (comp->state == COMP_RUN) {
-            temp->temp_rate_tick++;
-            if (temp->temp_rate_tick == 60) {
-                temp->temp_rate = temp->temperature10 - temp->last_temp;
-                
-                if (comp->pmode == PMODE_HI) {
-                    speedidx = max; // Aggressive: always full speed when running
-                } else {
-                    uint8_t pwr_threshold = (comp->pmode == PMODE_ECO) ? HIGH_POWER_THRESHOLD_ECO : HIGH_POWER_THRESHOLD;
-                    if (tempdiff > 100 && AnalogGetCompPower() < pwr_threshold) {
-                        speedidx = max;
-                    } else if (tempdiff > 40) {
-                        if (temp->temp_rate > -5 && speedidx < max) speedidx++;
-                        else if (temp->temp_rate < -5 && speedidx > min) speedidx--;
-                    } else {
-                        if (temp->temp_rate > -1 && speedidx < max) speedidx++;
-                        else if (temp->temp_rate < -1 && speedidx > min) speedidx--;
-                    }
-                }
-                
-                temp->temp_rate_tick = 0;
-                temp->last_temp = temp->temperature10;
-            }
-            
-            if (comp->pmode != PMODE_HI && speedidx > min) {
-                uint8_t pwr_threshold = (comp->pmode == PMODE_ECO) ? HIGH_POWER_THRESHOLD_ECO : HIGH_POWER_THRESHOLD;
-                if (AnalogGetCompPower() > pwr_threshold) speedidx--;
-            }
+    } else if (comp->state == COMP_STARTING) {
+        speedidx = (temp->temp_setpoint10 > 0) ? min : Compressor_GetDefaultSpeedIdx();
+    } else if (comp->state == COMP_RUN) {
+        // Temperature slope, for the feed-forward and the status display
+        temp->temp_rate_tick++;
+        if (temp->temp_rate_tick == 60) {
+            temp->temp_rate = temp->temperature10 - temp->last_temp;
+            temp->temp_rate_tick = 0;
+            temp->last_temp = temp->temperature10;
         }
+
+        // Short cycles in spite of the widest restart offset: run slower
+        uint8_t trim = Cycles_GetSpeedTrim((uint8_t)comp->pmode);
+        max = max > min + trim ? max - trim : min;
+
+        // The controller stays below the soft-start ceiling, so it does
+        // not wind up while the ramp holds it back
+        if (max > comp->ramp) max = comp->ramp;
+        speedidx = EffMap_Prefer(pi_speed(comp, temp, min, max), max);
     }
     
+    if (speedidx > comp->ramp) speedidx = comp->ramp; // Remote power and start speed too
     return speedidx;
 }
 
-static int16_t get_restart_threshold10(const compressor_context_t* comp) {
-    if (comp->pmode == PMODE_ECO) {
-        return TEMP_HYSTERESIS_ECO;
+static void ramp_reset(compressor_context_t* comp) {
+    comp->ramp = Compressor_GetMinSpeedIdx() + ramps[comp->pmode].start;
+    comp->ramp_timer = ramps[comp->pmode].step;
+    comp->rest_volt = comp->volt;
+}
+
+// Once per second while the compressor runs, before the speed is chosen
+static void ramp_update(compressor_context_t* comp) {
+    const ramp_profile_t* r = &ramps[comp->pmode];
+    uint8_t min = Compressor_GetMinSpeedIdx();
+    if (!comp->rest_volt) comp->rest_volt = comp->volt; // Resumed before the first reading
+    bool over = AnalogGetCompPower() > r->power ||
+                (comp->rest_volt && comp->rest_volt - comp->volt > r->sag) ||
+                (comp->cutout && comp->ocv < comp->cutout + RAMP_HEADROOM);
+
+    if (over) {
+        if (comp->ramp > comp->speed && comp->speed >= min) comp->ramp = comp->speed;
+        if (comp->ramp > min) comp->ramp--;
+        comp->ramp_timer = RAMP_HOLDOFF;
+    } else if (comp->ramp_timer > 0) {
+        comp->ramp_timer--;
+    } else {
+        // Only a ceiling the speed has reached has been tried on the supply
+        if (comp->ramp < Compressor_GetMaxSpeedIdx() && comp->ramp <= comp->speed) comp->ramp++;
+        comp->ramp_timer = r->step;
     }
+}
 
-    return TEMP_HYSTERESIS_DEFAULT;
+// Adapted to the cycle rate (cycles.h)
+static int16_t get_restart_threshold10(const compressor_context_t* comp) {
+#if CYCLES_ENABLE
+    return Cycles_GetRestart10((uint8_t)comp->pmode);
+#else
+    return comp->pmode == PMODE_ECO ? TEMP_HYSTERESIS_ECO : TEMP_HYSTERESIS_DEFAULT;
+#endif
 }
 
 static int16_t get_shutdown_threshold10(const compressor_context_t* comp) {
@@ -266,7 +496,7 @@ static int16_t get_shutdown_threshold10(const compressor_context_t* comp) {
         return -TEMP_OVERSHOOT_HI;
     }
 
-    return 0;
+    return -Cycles_GetUndershoot10((uint8_t)comp->pmode);
 }
 
 static void handle_compressor_lockout(compressor_context_t* comp) {
@@ -277,14 +507,18 @@ static void handle_compressor_off(compressor_context_t* comp, temp_context_t* te
     if (temp->temperature10 - temp->temp_setpoint10 >= get_restart_threshold10(comp) && comp->timer == 0) {
         comp->timer = COMP_START_DELAY;
         comp->fanspin = COMP_START_DELAY;
+        ramp_reset(comp); // Supply still unloaded
     }
     Compressor_OnOff(false, comp->fanspin > 0, 0);
 }
 
 static void handle_compressor_starting(compressor_context_t* comp, temp_context_t* temp) {
+    ramp_update(comp);
     comp->speed = calculate_compressor_speed(comp, temp);
     Compressor_OnOff(true, true, comp->speed);
     if (comp->timer == 0) {
+        Energy_CountStart();
+        comp->integral = (int32_t)comp->speed << PI_SHIFT; // Bumpless hand-over to the PI controller
         temp->temp_rate_tick = 0;
         temp->temp_rate = 0;
         temp->last_temp = temp->temperature10;
@@ -293,6 +527,7 @@ static void handle_compressor_starting(compressor_context_t* comp, temp_context_
 }
 
 static void handle_compressor_running(compressor_context_t* comp, temp_context_t* temp) {
+    ramp_update(comp);
     comp->speed = calculate_compressor_speed(comp, temp);
     int16_t tempdiff = temp->temperature10 - temp->temp_setpoint10;
     uint8_t min_speed = Compressor_GetMinSpeedIdx();
@@ -344,30 +579,22 @@ static void update_compressor_state(compressor_context_t* comp, temp_context_t*
     }
 }
 
-static void handle_key_press(uint8_t keys, uint8_t* lastkeys, uint8_t* longpress, display_context_t* display, compressor_context_t* comp) {
-    uint8_t pressed_keys = keys & ~(*lastkeys);
-    
-    if (keys & KEY_ONOFF) {
-        if (*longpress <= LONG_PRESS_TIME) (*longpress)++;
-        if (*longpress == LONG_PRESS_TIME) {
-            display->newon = !display->on;
-            display->state = DISP_IDLE;
-            if (display->newon) {
-                display->idletimer = 0;
-                display->dimtimer = 0;
-            } else {
-                Compressor_OnOff(false, false, 0);
-                comp->timer = COMP_LOCKOUT_TIME;
-                comp->state = COMP_LOCKOUT;
-            }
+static void handle_key_event(const key_event_t* ev, display_context_t* display, compressor_context_t* comp) {
+    if (ev->kind == KEY_EV_LONG && ev->key == KEY_ONOFF) {
+        display->newon = !display->on;
+        display->state = DISP_IDLE;
+        if (display->newon) {
+            display->idletimer = 0;
+            display->dimtimer = 0;
+        } else {
+            Compressor_OnOff(false, false, 0);
+            comp->timer = COMP_LOCKOUT_TIME;
+            comp->state = COMP_LOCKOUT;
         }
-    } else {
-        *longpress = 0;
     }
     
-    Display_HandleKeyPress(display, pressed_keys);
-    Display_Update(display, pressed_keys);
-    *lastkeys = keys;
+    if (ev->kind == KEY_EV_PRESS) Events_Post(EVENT_KEYS, ev->key);
+    Display_HandleKeyPress(display, ev);
 }
 
 static void update_settings(display_context_t* display, int16_t* temp_setpoint10) {
@@ -376,6 +603,7 @@ static void update_settings(display_context_t* display, int16_t* temp_setpoint10
     if (display->newon != display->on) {
         display->on = display->newon;
         Settings_SaveOnOff(display->on);
+        Events_Post(EVENT_POWER, display->on);
     }
     
     // 1. Process local UI changes (display->newtemp)
@@ -385,6 +613,7 @@ static void update_settings(display_context_t* display, int16_t* temp_setpoint10
         *temp_setpoint10 = display->temp_setpoint10;
         Settings_SaveTemp(display->temp_setpoint);
         Comms_SetTargetTemperature(display->temp_setpoint10);
+        Events_Post(EVENT_SETPOINT, (uint8_t)display->temp_setpoint);
     }
     
     // 2. Process Remote Comms changes
@@ -418,74 +647,234 @@ static void update_settings(display_context_t* display, int16_t* temp_setpoint10
     }
 }
 
-void main(void) {
-    display_context_t display = {0};
-    temp_context_t temp = {0};
-    battery_context_t battery = {0};
-    compressor_context_t comp = {
-        .state = COMP_LOCKOUT,
-        .timer = 20,
-        .speed = 0,
-        .fanspin = 0,
-        .running = false,
-        .pmode = PMODE_NORMAL
-    };
-    
-    uint8_t lastkeys = 0;
-    uint8_t longpress = 0;
-    uint16_t seconds = 0;
-    
-    system_init(&display);
-    
-    temp.temperature10 = display.temperature10;
-    temp.temp_setpoint10 = display.temp_setpoint10;
-    temp.last_temp = display.last_temp;
-    
-    while (1) {
-        bool compressor_check = false;
-
-        if (TMR1_HasOverflowOccured()) {
-            TMR1_Reload();
-            PIR1bits.TMR1IF = 0;
-            seconds++;
-            compressor_check = true;
-            Display_TimerTick(&display);
-        }
+// ── Scheduler tasks ───────────────────────────────────────────────────────
 
-        Comms_Process();
-        AnalogUpdate();
-        
-        update_temperature(&temp);
-        if (update_battery(&battery, &display, &comp)) {
-            compressor_check &= !display.battlow;
+// Pick up freshly published analog readings and run the temperature/battery averaging
+static void task_analog(void) {
+    if (!AnalogUpdate()) return;
+    if (Energy_CheckSupply(AnalogGetVoltage())) {
+        Settings_Commit(); // Don't wait out the quiet period with the supply going
+    }
+    update_temperature(&temp);
+    update_battery(&battery, &display, &comp);
+}
+
+// Scan the keypad, act on its events and, every 100ms, apply any settings
+// changes (local or remote)
+static void task_keys(void) {
+    key_event_t ev;
+    Keys_Scan();
+    while (Keys_GetEvent(&ev)) {
+        handle_key_event(&ev, &display, &comp);
+    }
+    if (++keys_ticks < 100 / KEYS_SCAN_MS) return;
+    keys_ticks = 0;
+    update_settings(&display, &temp.temp_setpoint10);
+    Settings_Tick();
+}
+
+// Refresh the display context with the latest measurements and redraw
+static void task_display(void) {
+    display.voltage = AnalogGetVoltage();
+    display.fancurrent = AnalogGetFanCurrent();
+    display.comppower = AnalogGetCompPower();
+    display.comp_timer = comp.timer;
+    display.comp_speed = comp.speed;
+    display.comp_on = comp.running;
+    display.temperature10 = temp.temperature10;
+    display.last_temp = temp.last_temp;
+    display.temp_rate = temp.temp_rate;
+
+    if (display.on) {
+        IO_LightEna_SetHigh();
+    } else {
+        IO_LightEna_SetLow();
+    }
+
+    Display_Update(&display, 0);
+}
+
+// Efficiency map sweep (effmap.h), in place of the thermostat once the
+// compressor is out of its lockout
+static void run_sweep(compressor_context_t* comp, temp_context_t* temp) {
+    if (!display.on || display.battlow ||
+        (comp->cutout && comp->ocv < comp->cutout + RAMP_HEADROOM) ||
+        temp->temperature10 < temp->temp_setpoint10 - EFFMAP_UNDERSHOOT10) {
+        EffMap_Abort();
+    } else if (comp->state == COMP_LOCKOUT) {
+        update_compressor_state(comp, temp, true);
+        return;
+    } else {
+        if (comp->state != COMP_RUN) {
+            Energy_CountStart();
+            comp->state = COMP_RUN;
         }
+        comp->timer = 0;
+        comp->speed = EffMap_Tick(temp->temperature10, AnalogGetCompPower());
+        if (EffMap_Sweeping()) {
+            Compressor_OnOff(true, true, comp->speed);
+            return;
+        }
+    }
 
-        uint8_t keys = TM1620B_GetKeys();
-        handle_key_press(keys, &lastkeys, &longpress, &display, &comp);
-        
-        comp.running = Compressor_IsOn();
-        comp.pmode = display.pmode;
-        update_compressor_state(&comp, &temp, compressor_check);
-        
-        // Update display context with latest measurements and state
-        display.voltage = AnalogGetVoltage();
-        display.fancurrent = AnalogGetFanCurrent();
-        display.comppower = AnalogGetCompPower();
-        display.comp_timer = comp.timer;
-        display.comp_speed = comp.speed;
-        display.comp_on = comp.running;
-        display.temperature10 = temp.temperature10;
-        display.last_temp = temp.last_temp;
-        display.temp_rate = temp.temp_rate;
-
-        // Update on/off control
-        if (display.on) {
-            IO_LightEna_SetHigh();
-        } else {
-            IO_LightEna_SetLow();
-            compressor_check = false;
+    // Done or given up: rest as after any run
+    if (comp->state != COMP_LOCKOUT) {
+        comp->state = COMP_LOCKOUT;
+        comp->timer = COMP_LOCKOUT_TIME;
+        comp->fanspin = FAN_SPINDOWN_TIME;
+        Compressor_OnOff(false, true, 0);
+    }
+}
+
+// Switched off, nothing running and the panel left alone since it dimmed
+static bool standby_allowed(void) {
+    return !display.on && !display.newon && !comp.running && !EffMap_Sweeping() &&
+           display.state == DISP_IDLE && display.dimtimer >= 20 && !Keys_Held();
+}
+
+// Once-per-second housekeeping and compressor state machine
+static void task_control(void) {
+    Display_TimerTick(&display);
+
+    Compressor_Service();
+    if (Compressor_GetLink() != reported_link) {
+        reported_link = Compressor_GetLink();
+        Events_Post(EVENT_MOTOR, (uint8_t)reported_link);
+    }
+
+    comp.running = Compressor_IsOn();
+    comp.pmode = display.pmode;
+    comp.volt = battery.volt;
+    comp.ocv = battery.ocv;
+    comp.cutout = battery.cutout;
+    if (EffMap_Sweeping()) {
+        run_sweep(&comp, &temp);
+    } else {
+        update_compressor_state(&comp, &temp, display.on && !display.battlow);
+    }
+    if (comp.state != reported_state) {
+        reported_state = comp.state;
+        Events_Post(EVENT_COMPRESSOR, (uint8_t)comp.state);
+    }
+    Cycles_Tick(comp.running, display.on && !display.battlow && !EffMap_Sweeping(), (uint8_t)comp.pmode);
+    Energy_Tick(comp.running, AnalogGetCompPower(), AnalogGetVoltage(), AnalogGetFanCurrent());
+    History_Tick(temp.temperature10, comp.running, AnalogGetCompPower(), AnalogGetVoltage());
+
+    standby_due = standby_allowed();
+
+    warm.uptime++;
+    warm.state = (uint8_t)comp.state;
+    warm.timer = comp.timer;
+    warm.fanspin = comp.fanspin;
+    warm.pmode = (uint8_t)display.pmode;
+    warm.temperature10 = temp.temperature10;
+    WarmStart_Save(&warm);
+}
+
+// Single-wire link to the ESP32; bytes arrive by interrupt, frames are parsed here
+static void task_comms(void) {
+    Comms_Process();
+}
+
+static sched_task_t tasks[] = {
+    // run,          period,               deadline,                countdown (phase)
+    { task_comms,    TASK_COMMS_PERIOD,    TASK_COMMS_PERIOD,       1 },
+    { task_analog,   TASK_ANALOG_PERIOD,   TASK_ANALOG_PERIOD,      1 },
+    { task_keys,     TASK_KEYS_PERIOD,     TASK_KEYS_PERIOD / 2,    2 },
+    { task_control,  TASK_CONTROL_PERIOD,  SCHED_MS(100),           4 },
+    { task_display,  TASK_DISPLAY_PERIOD,  TASK_DISPLAY_PERIOD,     6 },
+};
+#define NUM_TASKS (sizeof(tasks) / sizeof(tasks[0]))
+
+// ── Timing readout (COMMS_CMD_GET_PERF) ───────────────────────────────────
+#define NUM_PROBES 2    // TM1620B_Update(), IRMCF183 command to ack
+
+static uint8_t put16(uint8_t* buf, uint16_t v) {
+    buf[0] = (uint8_t)v;
+    buf[1] = (uint8_t)(v >> 8);
+    return 2;
+}
+
+static uint8_t put_stat(uint8_t* buf, const sched_stat_t* stat) {
+    put16(&buf[0], stat->last);
+    put16(&buf[2], stat->min);
+    put16(&buf[4], Scheduler_StatAvg(stat));
+    put16(&buf[6], stat->max);
+    return 8;
+}
+
+static uint8_t perf_page(uint8_t page, uint8_t* buf) {
+    if (page == COMMS_PERF_LOOP) {
+        buf[0] = NUM_TASKS;
+        buf[1] = NUM_PROBES;
+        return (uint8_t)(2 + put_stat(&buf[2], Scheduler_GetLoopStat()));
+    }
+    if (page == COMMS_PERF_HIST) {
+        const uint16_t* hist = Scheduler_GetHistogram();
+        for (uint8_t i = 0; i < SCHED_HIST_BUCKETS; i++) put16(&buf[2 * i], hist[i]);
+        return 2 * SCHED_HIST_BUCKETS;
+    }
+    page -= COMMS_PERF_TASKS;
+    if (page < NUM_TASKS) {
+        put_stat(buf, &tasks[page].stat);
+        buf[8] = tasks[page].misses;
+        return 9;
+    }
+    if (page == NUM_TASKS) {
+        put_stat(buf, Display_GetPanelStat());
+        buf[8] = 0;
+        return 9;
+    }
+    if (page == NUM_TASKS + 1) {
+        put_stat(buf, Compressor_GetAckStat());
+        buf[8] = Compressor_GetMissedAcks();
+        return 9;
+    }
+    return 0;
+}
+
+// ── Deep standby (standby.h) ──────────────────────────────────────────────
+
+// Sleep until a key is pressed, keeping the temperature reading current in
+// the meantime.  A request on the link gets the scheduler back only until it
+// has been answered, as the companion polls every second.  Energy and
+// history accounting pause with the control task.
+static void standby(void) {
+    Settings_Commit();
+    EECommit_Flush();
+    Standby_Enter();
+    while (1) {
+        standby_wake_t wake = Standby_Sleep();
+        if (wake == STANDBY_WAKE_KEY) break;
+        if (wake == STANDBY_WAKE_SAMPLE) {
+            while (!AnalogUpdate()) SCHEDULER_IDLE();
+            update_temperature(&temp);
+            continue;
         }
+        TMR1_StartTimer();
+        while (!Comms_Idle()) Scheduler_Run();
+        TMR1_StopTimer();
+        update_settings(&display, &temp.temp_setpoint10);  // A remote setpoint
+        Settings_Commit();
+        EECommit_Flush();
+        if (!standby_allowed()) break;
+    }
+    Standby_Leave();
+    standby_due = false;
+}
 
-        update_settings(&display, &temp.temp_setpoint10);
+void main(void) {
+    bool resumed = WarmStart_Load(&warm); // While PCON still has the reset cause
+    system_init(&display, resumed);
+    
+    temp.temp_setpoint10 = display.temp_setpoint10;
+    if (resumed) resume(&warm);
+    
+    Scheduler_Initialize(tasks, NUM_TASKS);
+    Comms_SetPerfHandler(perf_page);
+
+    while (1) {
+        Scheduler_Run();
+        if (standby_due && Comms_Idle()) standby();
     }
 }
@@ -58,6 +58,8 @@
 
 #define ACQ_US_DELAY 5
 
+void (*ADC_InterruptHandler)(void);
+
 /**
   Section: ADC Module APIs
 */
@@ -69,8 +71,19 @@ void ADC_Initialize(void)
     // GO_nDONE stop; ADON enabled; CHS AN0; 
     ADCON0 = 0x01;
     
-    // ADFM right; ADNREF VSS; ADPREF VDD; ADCS FOSC/2; 
-    ADCON1 = 0x80;
+#if _XTAL_FREQ == 32000000
+    // ADFM right; ADNREF VSS; ADPREF VDD; ADCS FOSC/64; 
+    ADCON1 = 0xE0;
+#elif _XTAL_FREQ == 16000000
+    // ADFM right; ADNREF VSS; ADPREF VDD; ADCS FOSC/32; 
+    ADCON1 = 0xA0;
+#elif _XTAL_FREQ == 8000000
+    // ADFM right; ADNREF VSS; ADPREF VDD; ADCS FOSC/16; 
+    ADCON1 = 0xD0;
+#else
+    // ADFM right; ADNREF VSS; ADPREF VDD; ADCS FOSC/8; 
+    ADCON1 = 0x90;
+#endif
     
     // ADRESL 0; 
     ADRESL = 0x00;
@@ -78,6 +91,11 @@ void ADC_Initialize(void)
     // ADRESH 0; 
     ADRESH = 0x00;
     
+    // Enabling ADC interrupt.
+    PIE1bits.ADIE = 1;
+	
+	// Set Default Interrupt Handler
+    ADC_SetInterruptHandler(ADC_DefaultInterruptHandler);
 }
 
 void ADC_SelectChannel(adc_channel_t channel)
@@ -134,6 +152,25 @@ void ADC_TemperatureAcquisitionDelay(void)
 {
     __delay_us(200);
 }
+
+void ADC_ISR(void)
+{
+    // Clear the ADC interrupt flag
+    PIR1bits.ADIF = 0;
+	
+	if(ADC_InterruptHandler)
+    {
+        ADC_InterruptHandler();
+    }
+}
+
+void ADC_SetInterruptHandler(void (* InterruptHandler)(void)){
+    ADC_InterruptHandler = InterruptHandler;
+}
+
+void ADC_DefaultInterruptHandler(void){
+    // add your ADC interrupt handler code here
+}
 /**
  End of File
 */
\ No newline at end of file
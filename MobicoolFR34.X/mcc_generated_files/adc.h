@@ -319,6 +319,76 @@ adc_result_t ADC_GetConversion(adc_channel_t channel);
 */
 void ADC_TemperatureAcquisitionDelay(void);
 
+/**
+  @Summary
+    Implements ISR
+
+  @Description
+    This routine is used to implement the ISR for the interrupt-driven
+    implementations.
+
+  @Returns
+    None
+
+  @Param
+    None
+*/
+void ADC_ISR(void);
+
+/**
+  @Summary
+    ADC Interrupt Handler Setter
+
+  @Description
+    Sets ADC interrupt handler
+
+  @Preconditions
+    ADC_Initialize() function should have been called before calling this function.
+
+  @Returns
+    None
+
+  @Param
+    Address of function to be set as ADC interrupt handler
+*/
+void ADC_SetInterruptHandler(void (* InterruptHandler)(void));
+
+/**
+  @Summary
+    ADC Interrupt Handler
+
+  @Description
+    This is a function pointer to the function that will be called during the ISR
+
+  @Preconditions
+    ADC_Initialize() function should have been called before calling this function.
+
+  @Returns
+    None
+
+  @Param
+    None
+*/
+extern void (*ADC_InterruptHandler)(void);
+
+/**
+  @Summary
+    Default ADC Interrupt Handler
+
+  @Description
+    This is the default Interrupt Handler function
+
+  @Preconditions
+    ADC_Initialize() function should have been called before calling this function.
+
+  @Returns
+    None
+
+  @Param
+    None
+*/
+void ADC_DefaultInterruptHandler(void);
+
 #ifdef __cplusplus  // Provide C++ Compatibility
 
     }
@@ -48,13 +48,41 @@
   Section: Included Files
 */
 #include "eusart.h"
+#include "mcc.h"
 
+/**
+  Section: Macro Declarations
+*/
+
+#define EUSART_TX_BUFFER_SIZE 8
+#define EUSART_RX_BUFFER_SIZE 8
+
+/**
+  Section: Global Variables
+*/
+volatile uint8_t eusartTxHead = 0;
+volatile uint8_t eusartTxTail = 0;
+volatile uint8_t eusartTxBuffer[EUSART_TX_BUFFER_SIZE];
+volatile uint8_t eusartTxBufferRemaining;
+
+volatile uint8_t eusartRxHead = 0;
+volatile uint8_t eusartRxTail = 0;
+volatile uint8_t eusartRxBuffer[EUSART_RX_BUFFER_SIZE];
+volatile uint8_t eusartRxCount;
+
+void (*EUSART_TxDefaultInterruptHandler)(void);
+void (*EUSART_RxDefaultInterruptHandler)(void);
 
 /**
   Section: EUSART APIs
 */
 void EUSART_Initialize(void)
 {
+    // disable interrupts before changing states
+    PIE1bits.RCIE = 0;
+    EUSART_SetRxInterruptHandler(EUSART_Receive_ISR);
+    PIE1bits.TXIE = 0;
+    EUSART_SetTxInterruptHandler(EUSART_Transmit_ISR);
     // Set the EUSART module to the options selected in the user interface.
 
     // ABDOVF no_overflow; SCKP Non-Inverted; BRG16 16bit_generator; WUE disabled; ABDEN disabled; 
@@ -66,23 +94,54 @@ void EUSART_Initialize(void)
     // TX9 8-bit; TX9D 0; SENDB sync_break_complete; TXEN enabled; SYNC asynchronous; BRGH hi_speed; CSRC slave; 
     TXSTA = 0x24;
 
-    // SPBRGL 25; 
-    SPBRGL = 0x19;
+#if _XTAL_FREQ == 32000000
+    // SPBRGL 64; 
+    SPBRGL = 0x40;
+
+    // SPBRGH 3; 
+    SPBRGH = 0x03;
+#elif _XTAL_FREQ == 16000000
+    // SPBRGL 160; 
+    SPBRGL = 0xA0;
+
+    // SPBRGH 1; 
+    SPBRGH = 0x01;
+#elif _XTAL_FREQ == 8000000
+    // SPBRGL 207; 
+    SPBRGL = 0xCF;
+
+    // SPBRGH 0; 
+    SPBRGH = 0x00;
+#else
+    // SPBRGL 103; 
+    SPBRGL = 0x67;
 
     // SPBRGH 0; 
     SPBRGH = 0x00;
+#endif
+
+
+    // initializing the driver state
+    eusartTxHead = 0;
+    eusartTxTail = 0;
+    eusartTxBufferRemaining = sizeof(eusartTxBuffer);
 
+    eusartRxHead = 0;
+    eusartRxTail = 0;
+    eusartRxCount = 0;
 
+    // enable receive interrupt
+    PIE1bits.RCIE = 1;
 }
 
-bool EUSART_is_tx_ready(void)
+uint8_t EUSART_is_tx_ready(void)
 {
-    return (bool)(PIR1bits.TXIF && TXSTAbits.TXEN);
+    return eusartTxBufferRemaining;
 }
 
-bool EUSART_is_rx_ready(void)
+uint8_t EUSART_is_rx_ready(void)
 {
-    return PIR1bits.RCIF;
+    return eusartRxCount;
 }
 
 bool EUSART_is_tx_done(void)
@@ -92,35 +151,99 @@ bool EUSART_is_tx_done(void)
 
 uint8_t EUSART_Read(void)
 {
-    while(!PIR1bits.RCIF)
+    uint8_t readValue  = 0;
+    
+    while(0 == eusartRxCount)
     {
     }
 
-    
-    if(1 == RCSTAbits.OERR)
+    readValue = eusartRxBuffer[eusartRxTail++];
+    if(sizeof(eusartRxBuffer) <= eusartRxTail)
     {
-        // EUSART error - restart
-
-        RCSTAbits.CREN = 0; 
-        RCSTAbits.CREN = 1; 
+        eusartRxTail = 0;
     }
+    PIE1bits.RCIE = 0;
+    eusartRxCount--;
+    PIE1bits.RCIE = 1;
 
-    return RCREG;
+    return readValue;
 }
 
 void EUSART_Write(uint8_t txData)
 {
-    while(0 == PIR1bits.TXIF)
+    while(0 == eusartTxBufferRemaining)
+    {
+    }
+
+    if(0 == PIE1bits.TXIE)
+    {
+        TXREG = txData;
+    }
+    else
     {
+        PIE1bits.TXIE = 0;
+        eusartTxBuffer[eusartTxHead++] = txData;
+        if(sizeof(eusartTxBuffer) <= eusartTxHead)
+        {
+            eusartTxHead = 0;
+        }
+        eusartTxBufferRemaining--;
     }
+    PIE1bits.TXIE = 1;
+}
+
+void EUSART_Transmit_ISR(void)
+{
 
-    TXREG = txData;    // Write the data byte to the USART.
+    // add your EUSART interrupt custom code
+    if(sizeof(eusartTxBuffer) > eusartTxBufferRemaining)
+    {
+        TXREG = eusartTxBuffer[eusartTxTail++];
+        if(sizeof(eusartTxBuffer) <= eusartTxTail)
+        {
+            eusartTxTail = 0;
+        }
+        eusartTxBufferRemaining++;
+    }
+    else
+    {
+        PIE1bits.TXIE = 0;
+    }
 }
 
+void EUSART_Receive_ISR(void)
+{
+    uint8_t rxData;
+
+    if(1 == RCSTAbits.OERR)
+    {
+        // EUSART error - restart
+
+        RCSTAbits.CREN = 0; 
+        RCSTAbits.CREN = 1; 
+    }
 
+    rxData = RCREG;
 
+    // drop the byte on a full buffer rather than overrun the count
+    if(sizeof(eusartRxBuffer) > eusartRxCount)
+    {
+        eusartRxBuffer[eusartRxHead++] = rxData;
+        if(sizeof(eusartRxBuffer) <= eusartRxHead)
+        {
+            eusartRxHead = 0;
+        }
+        eusartRxCount++;
+    }
+}
 
+void EUSART_SetTxInterruptHandler(void (* interruptHandler)(void)){
+    EUSART_TxDefaultInterruptHandler = interruptHandler;
+}
 
+void EUSART_SetRxInterruptHandler(void (* interruptHandler)(void)){
+    EUSART_RxDefaultInterruptHandler = interruptHandler;
+}
 /**
   End of File
 */
@@ -68,11 +68,17 @@
 
 #define EUSART_DataReady  (EUSART_is_rx_ready())
 
+/**
+ Section: Global variables
+ */
+extern volatile uint8_t eusartTxBufferRemaining;
+extern volatile uint8_t eusartRxCount;
 
 /**
   Section: EUSART APIs
 */
-
+extern void (*EUSART_TxDefaultInterruptHandler)(void);
+extern void (*EUSART_RxDefaultInterruptHandler)(void);
 
 /**
   @Summary
@@ -114,9 +120,9 @@ void EUSART_Initialize(void);
     None
 
   @Returns
-    Status of EUSART transmitter
-    TRUE: EUSART transmitter is ready
-    FALSE: EUSART transmitter is not ready
+    Number of free bytes in the transmit buffer
+    Nonzero: EUSART_Write() will not block
+    0: the transmit buffer is full
     
   @Example
     <code>
@@ -142,7 +148,7 @@ void EUSART_Initialize(void);
     }
     </code>
 */
-bool EUSART_is_tx_ready(void);
+uint8_t EUSART_is_tx_ready(void);
 
 /**
   @Summary
@@ -162,9 +168,9 @@ bool EUSART_is_tx_ready(void);
     None
 
   @Returns
-    Status of EUSART receiver
-    TRUE: EUSART receiver is ready for reading
-    FALSE: EUSART receiver is not ready for reading
+    Number of received bytes waiting in the receive buffer
+    Nonzero: EUSART_Read() will not block
+    0: nothing has been received
     
   @Example
     <code>
@@ -190,7 +196,7 @@ bool EUSART_is_tx_ready(void);
     }
     </code>
 */
-bool EUSART_is_rx_ready(void);
+uint8_t EUSART_is_rx_ready(void);
 
 /**
   @Summary
@@ -279,6 +285,84 @@ uint8_t EUSART_Read(void);
 */
 void EUSART_Write(uint8_t txData);
 
+/**
+  @Summary
+    Maintains the driver's transmitter state machine and implements its ISR.
+
+  @Description
+    This routine is used to maintain the driver's internal transmitter state
+    machine.This interrupt service routine is called when the state of the
+    transmitter needs to be maintained in a non polled manner.
+
+  @Preconditions
+    EUSART_Initialize() function should have been called
+    for the ISR to execute correctly.
+
+  @Param
+    None
+
+  @Returns
+    None
+*/
+void EUSART_Transmit_ISR(void);
+
+/**
+  @Summary
+    Maintains the driver's receiver state machine and implements its ISR
+
+  @Description
+    This routine is used to maintain the driver's internal receiver state
+    machine.This interrupt service routine is called when the state of the
+    receiver needs to be maintained in a non polled manner.
+
+  @Preconditions
+    EUSART_Initialize() function should have been called
+    for the ISR to execute correctly.
+
+  @Param
+    None
+
+  @Returns
+    None
+*/
+void EUSART_Receive_ISR(void);
+
+/**
+  @Summary
+    Set EUSART Transmit Interrupt Handler
+
+  @Description
+    This API sets the function to be called upon EUSART transmit interrupt
+
+  @Preconditions
+    Initialize  the EUSART before calling this API
+
+  @Param
+    Address of function to be set as transmit interrupt handler
+
+  @Returns
+    None
+*/
+void EUSART_SetTxInterruptHandler(void (* interruptHandler)(void));
+
+/**
+  @Summary
+    Set EUSART Receive Interrupt Handler
+
+  @Description
+    This API sets the function to be called upon EUSART receive interrupt
+
+  @Preconditions
+    Initialize  the EUSART before calling this API
+
+  @Param
+    Address of function to be set as receive interrupt handler
+
+  @Returns
+    None
+*/
+void EUSART_SetRxInterruptHandler(void (* interruptHandler)(void));
+
 
 
 
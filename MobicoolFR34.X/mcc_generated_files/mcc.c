@@ -53,6 +53,8 @@ void SYSTEM_Initialize(void)
     PIN_MANAGER_Initialize();
     OSCILLATOR_Initialize();
     WDT_Initialize();
+    TMR2_Initialize();
+    TMR0_Initialize();
     TMR1_Initialize();
     ADC_Initialize();
     EUSART_Initialize();
@@ -60,8 +62,19 @@ void SYSTEM_Initialize(void)
 
 void OSCILLATOR_Initialize(void)
 {
-    // SCS INTOSC; SPLLEN disabled; IRCF 1MHz_HF; 
-    OSCCON = 0x5A;
+#if _XTAL_FREQ == 32000000
+    // SCS FOSC; SPLLEN enabled; IRCF 8MHz_HF; 
+    OSCCON = 0xF0;
+#elif _XTAL_FREQ == 16000000
+    // SCS INTOSC; SPLLEN disabled; IRCF 16MHz_HF; 
+    OSCCON = 0x7A;
+#elif _XTAL_FREQ == 8000000
+    // SCS INTOSC; SPLLEN disabled; IRCF 8MHz_HF; 
+    OSCCON = 0x72;
+#else
+    // SCS INTOSC; SPLLEN disabled; IRCF 4MHz_HF; 
+    OSCCON = 0x6A;
+#endif
     // TUN 0; 
     OSCTUNE = 0x00;
     // SBOREN disabled; 
@@ -50,12 +50,24 @@
 #include "pin_manager.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include "tmr2.h"
+#include "tmr0.h"
 #include "tmr1.h"
 #include "memory.h"
 #include "adc.h"
 #include "eusart.h"
+#include "interrupt_manager.h"
 
-#define _XTAL_FREQ  1000000
+// System clock, 4, 8, 16 or 32 MHz from INTOSC (32 MHz through the 4x PLL).
+// OSCILLATOR_Initialize() and the peripheral setups derive their settings
+// from it, so another clock is -D_XTAL_FREQ=<Hz> on the compiler line.
+#ifndef _XTAL_FREQ
+#define _XTAL_FREQ  4000000
+#endif
+
+#if _XTAL_FREQ != 4000000 && _XTAL_FREQ != 8000000 && _XTAL_FREQ != 16000000 && _XTAL_FREQ != 32000000
+#error "_XTAL_FREQ must be 4, 8, 16 or 32 MHz"
+#endif
 
 
 /**
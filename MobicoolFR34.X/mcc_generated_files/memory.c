@@ -219,6 +219,52 @@ uint8_t DATAEE_ReadByte(uint8_t bAdd)
 
     return (EEDATL);
 }
+
+void DATAEE_StartWrite(uint8_t bAdd, uint8_t bData)
+{
+    uint8_t GIEBitValue = 0;
+
+    EEADRL = (uint8_t)(bAdd & 0x0ff);    // Data Memory Address to write
+    EEDATL = bData;             // Data Memory Value to write
+    EECON1bits.EEPGD = 0;   // Point to DATA memory
+    EECON1bits.CFGS = 0;        // Deselect Configuration space
+    EECON1bits.WREN = 1;        // Enable writes
+
+    GIEBitValue = INTCONbits.GIE;
+    INTCONbits.GIE = 0;     // Disable INTs
+    EECON2 = 0x55;
+    EECON2 = 0xAA;
+    EECON1bits.WR = 1;      // Set WR bit to begin write
+    EECON1bits.WREN = 0;    // Disable further writes; this one continues
+    INTCONbits.GIE = GIEBitValue;
+}
+
+bool DATAEE_IsWriteBusy(void)
+{
+    return EECON1bits.WR;
+}
+
+void (*DATAEE_InterruptHandler)(void) = DATAEE_DefaultInterruptHandler;
+
+void DATAEE_ISR(void)
+{
+    // clear the EEPROM write complete flag
+    PIR2bits.EEIF = 0;
+
+    if(DATAEE_InterruptHandler)
+    {
+        DATAEE_InterruptHandler();
+    }
+}
+
+void DATAEE_SetInterruptHandler(void (* InterruptHandler)(void)){
+    DATAEE_InterruptHandler = InterruptHandler;
+}
+
+void DATAEE_DefaultInterruptHandler(void){
+    // add your EEPROM write complete interrupt custom code
+    // or set custom function using DATAEE_SetInterruptHandler()
+}
 /**
  End of File
-*/
\ No newline at end of file
+*/
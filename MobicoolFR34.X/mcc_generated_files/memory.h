@@ -245,6 +245,84 @@ void DATAEE_WriteByte(uint8_t bAdd, uint8_t bData);
 */
 uint8_t DATAEE_ReadByte(uint8_t bAdd);
 
+/**
+  @Summary
+    Starts a data byte write to Data EEPROM
+
+  @Description
+    This routine starts writing a data byte to given Data EEPROM location
+    and returns without waiting for the write to complete. EEIF is set
+    when the write has finished.
+
+  @Preconditions
+    No write in progress (DATAEE_IsWriteBusy() returns false)
+
+  @Param
+    bAdd  - Data EEPROM location to which data to be written
+    bData - Data to be written to Data EEPROM location
+
+  @Returns
+    None
+
+  @Example
+    <code>
+    DATAEE_StartWrite(0x10, 0x55);
+    while (DATAEE_IsWriteBusy());
+    </code>
+*/
+void DATAEE_StartWrite(uint8_t bAdd, uint8_t bData);
+
+/**
+  @Summary
+    Returns true while a Data EEPROM write is in progress
+*/
+bool DATAEE_IsWriteBusy(void);
+
+/**
+  @Summary
+    Data EEPROM write complete Interrupt Service Routine
+
+  @Description
+    Called by the Interrupt Manager when EEIF is set.
+
+  @Preconditions
+    None
+
+  @Param
+    None
+
+  @Returns
+    None
+*/
+void DATAEE_ISR(void);
+
+/**
+  @Summary
+    Set Data EEPROM write complete Interrupt Handler
+
+  @Param
+    Address of function to be set
+
+  @Returns
+    None
+*/
+void DATAEE_SetInterruptHandler(void (* InterruptHandler)(void));
+
+/**
+  @Summary
+    Data EEPROM write complete Interrupt Handler
+
+  @Description
+    This is a function pointer to the function that will be called during the ISR
+*/
+extern void (*DATAEE_InterruptHandler)(void);
+
+/**
+  @Summary
+    Default Data EEPROM write complete Interrupt Handler
+*/
+void DATAEE_DefaultInterruptHandler(void);
+
 #ifdef __cplusplus  // Provide C++ Compatibility
 
     }
@@ -53,6 +53,8 @@
 
 
 
+void (*IOCAF0_InterruptHandler)(void);
+
 
 void PIN_MANAGER_Initialize(void)
 {
@@ -95,15 +97,63 @@ void PIN_MANAGER_Initialize(void)
     APFCON0 = 0x00;
     APFCON1 = 0x00;
 
+    /**
+    IOCx registers 
+    */
+    //interrupt on change for group IOCAF - flag
+    IOCAFbits.IOCAF0 = 0;
+    //interrupt on change for group IOCAN - negative
+    IOCANbits.IOCAN0 = 1;
+    //interrupt on change for group IOCAP - positive
+    IOCAPbits.IOCAP0 = 0;
 
 
 
+    // register default IOC callback functions at runtime; use these methods to register a custom function
+    IOCAF0_SetInterruptHandler(IOCAF0_DefaultInterruptHandler);
    
+    // Enable IOCI interrupt 
+    INTCONbits.IOCIE = 1; 
     
 }
   
 void PIN_MANAGER_IOC(void)
 {   
+	// interrupt on change for pin IOCAF0
+    if(IOCAFbits.IOCAF0 == 1)
+    {
+        IOCAF0_ISR();  
+    }	
+}
+
+/**
+   IOCAF0 Interrupt Service Routine
+*/
+void IOCAF0_ISR(void) {
+
+    // Add custom IOCAF0 code
+
+    // Call the interrupt handler for the callback registered at runtime
+    if(IOCAF0_InterruptHandler)
+    {
+        IOCAF0_InterruptHandler();
+    }
+    IOCAFbits.IOCAF0 = 0;
+}
+
+/**
+  Allows selecting an interrupt handler for IOCAF0 at application runtime
+*/
+void IOCAF0_SetInterruptHandler(void (* InterruptHandler)(void)){
+    IOCAF0_InterruptHandler = InterruptHandler;
+}
+
+/**
+  Default interrupt handler for IOCAF0
+*/
+void IOCAF0_DefaultInterruptHandler(void){
+    // add your IOCAF0 interrupt custom code
+    // or set custom function using IOCAF0_SetInterruptHandler()
 }
 
 /**
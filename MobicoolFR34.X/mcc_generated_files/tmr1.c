@@ -50,11 +50,13 @@
 
 #include <xc.h>
 #include "tmr1.h"
+#include "mcc.h"
 
 /**
   Section: Global Variables Definitions
 */
 volatile uint16_t timer1ReloadVal;
+void (*TMR1_InterruptHandler)(void);
 
 /**
   Section: TMR1 APIs
@@ -67,20 +69,34 @@ void TMR1_Initialize(void)
     //T1GSS T1G_pin; TMR1GE disabled; T1GTM disabled; T1GPOL low; T1GGO done; T1GSPM disabled; 
     T1GCON = 0x00;
 
-    //TMR1H 133; 
-    TMR1H = 0x85;
+    //TMR1H 216; 
+    TMR1H = 0xD8;
 
-    //TMR1L 238; 
-    TMR1L = 0xEE;
+    //TMR1L 240; 
+    TMR1L = 0xF0;
 
     // Load the TMR value to reload variable
     timer1ReloadVal=(uint16_t)((TMR1H << 8) | TMR1L);
 
-    // Clearing IF flag.
+    // Clearing IF flag before enabling the interrupt.
     PIR1bits.TMR1IF = 0;
 
-    // T1CKPS 1:8; T1OSCEN disabled; nT1SYNC do_not_synchronize; TMR1CS FOSC/4; TMR1ON enabled; 
+    // Enabling TMR1 interrupt.
+    PIE1bits.TMR1IE = 1;
+
+    // Set Default Interrupt Handler
+    TMR1_SetInterruptHandler(TMR1_DefaultInterruptHandler);
+
+    // T1CKPS 1 us per count at any _XTAL_FREQ; T1OSCEN disabled; nT1SYNC do_not_synchronize; TMR1CS FOSC/4; TMR1ON enabled; 
+#if _XTAL_FREQ == 32000000
     T1CON = 0x35;
+#elif _XTAL_FREQ == 16000000
+    T1CON = 0x25;
+#elif _XTAL_FREQ == 8000000
+    T1CON = 0x15;
+#else
+    T1CON = 0x05;
+#endif
 }
 
 void TMR1_StartTimer(void)
@@ -147,10 +163,27 @@ uint8_t TMR1_CheckGateValueStatus(void)
     return (T1GCONbits.T1GVAL);
 }
 
-bool TMR1_HasOverflowOccured(void)
+void TMR1_ISR(void)
 {
-    // check if  overflow has occurred by checking the TMRIF bit
-    return(PIR1bits.TMR1IF);
+
+    // Clear the TMR1 interrupt flag
+    PIR1bits.TMR1IF = 0;
+    TMR1_WriteTimer(timer1ReloadVal);
+
+    if(TMR1_InterruptHandler)
+    {
+        TMR1_InterruptHandler();
+    }
+}
+
+
+void TMR1_SetInterruptHandler(void (* InterruptHandler)(void)){
+    TMR1_InterruptHandler = InterruptHandler;
+}
+
+void TMR1_DefaultInterruptHandler(void){
+    // add your TMR1 interrupt custom code
+    // or set custom function using TMR1_SetInterruptHandler()
 }
 /**
   End of File
@@ -350,41 +350,75 @@ uint8_t TMR1_CheckGateValueStatus(void);
 
 /**
   @Summary
-    Boolean routine to poll or to check for the overflow flag on the fly.
+    Timer Interrupt Service Routine
 
   @Description
-    This function is called to check for the timer overflow flag.
-    This function is usd in timer polling method.
+    Timer Interrupt Service Routine is called by the Interrupt Manager.
 
   @Preconditions
-    Initialize  the TMR1 module before calling this routine.
+    Initialize  the TMR1 module with interrupt before calling this isr.
 
   @Param
     None
 
   @Returns
-    true - timer overflow has occured.
-    false - timer overflow has not occured.
+    None
+*/
+void TMR1_ISR(void);
 
-  @Example
-    <code>
-    while(1)
-    {
-        // check the overflow flag
-        if(TMR1_HasOverflowOccured())
-        {
-            // Do something else...
+/**
+  @Summary
+    Set Timer Interrupt Handler
 
-            // clear the TMR1 interrupt flag
-            TMR1IF = 0;
+  @Description
+    This sets the function to be called during the ISR
 
-            // Reload the TMR1 value
-            TMR1_Reload();
-        }
-    }
-    </code>
+  @Preconditions
+    Initialize  the TMR1 module with interrupt before calling this.
+
+  @Param
+    Address of function to be set
+
+  @Returns
+    None
+*/
+ void TMR1_SetInterruptHandler(void (* InterruptHandler)(void));
+
+/**
+  @Summary
+    Timer Interrupt Handler
+
+  @Description
+    This is a function pointer to the function that will be called during the ISR
+
+  @Preconditions
+    Initialize  the TMR1 module with interrupt before calling this isr.
+
+  @Param
+    None
+
+  @Returns
+    None
+*/
+extern void (*TMR1_InterruptHandler)(void);
+
+/**
+  @Summary
+    Default Timer Interrupt Handler
+
+  @Description
+    This is the default Interrupt Handler function
+
+  @Preconditions
+    Initialize  the TMR1 module with interrupt before calling this isr.
+
+  @Param
+    None
+
+  @Returns
+    None
 */
-bool TMR1_HasOverflowOccured(void);
+void TMR1_DefaultInterruptHandler(void);
 
 #ifdef __cplusplus  // Provide C++ Compatibility
 
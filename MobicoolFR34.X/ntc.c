@@ -0,0 +1,16 @@
+#include "ntc.h"
+#include "ntc_table.h"
+
+int16_t NtcToTemp10(uint16_t reading) {
+    if (reading < ntcsegs[0].start) return NTC_TOO_HOT;
+    if (reading >= ntcsegs[NTC_SEGMENTS].start) return NTC_TOO_COLD;
+
+    // Under 40 segments and a new reading every 256 ms: a linear scan is fine
+    const ntc_segment_t* seg = ntcsegs;
+    while (reading >= seg[1].start) seg++;
+
+    int32_t delta = (int32_t)seg->slope * (uint16_t)(reading - seg->start);
+    int16_t temp = seg->temp + (int16_t)(delta >> NTC_SLOPE_SHIFT);
+    // Round to tenths; the arithmetic shift rounds negative values correctly
+    return (int16_t)((temp + (1 << (NTC_TEMP_FRAC_BITS - 1))) >> NTC_TEMP_FRAC_BITS);
+}
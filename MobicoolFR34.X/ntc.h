@@ -0,0 +1,28 @@
+#ifndef NTC_H
+#define NTC_H
+
+#include <stdint.h>
+
+// ── NTC reading to temperature ────────────────────────────────────────────
+//
+// Piecewise-linear fit of the cabinet NTC divider (ntc_table.h, generated by
+// sim/ntcgen.c).  The input keeps the oversampling fraction of the ADC sum,
+// so the reading moves smoothly between whole ADC counts.
+
+#define NTC_FRAC_BITS       5   // Input: ADC counts << NTC_FRAC_BITS (32x oversampled sum)
+#define NTC_TEMP_FRAC_BITS  4   // Segment temperatures in 1/16 of a tenth of a degree
+#define NTC_SLOPE_SHIFT     12  // Segment slopes per input step, scaled up by 2^12
+
+#define NTC_TOO_HOT         (-32767)    // Below the table (shorted NTC)
+#define NTC_TOO_COLD        (32767)     // Above the table (open NTC)
+
+typedef struct {
+    uint16_t start;     // First input value of the segment
+    int16_t  temp;      // Temperature at start
+    int16_t  slope;     // Temperature change per input step
+} ntc_segment_t;
+
+// Tenths of °C, or NTC_TOO_HOT / NTC_TOO_COLD outside the table
+int16_t NtcToTemp10(uint16_t reading);
+
+#endif /* NTC_H */
@@ -0,0 +1,44 @@
+// Generated by sim/ntcgen.c (make -C sim ntc-table), do not edit.
+// 10k NTC with Beta 2670 K against 10k to VDD, ADC 143..905 in 34 segments,
+// chord error at most 0.25 tenths of a degree.
+
+#define NTC_SEGMENTS (34)
+
+// { start << NTC_FRAC_BITS, temperature, slope << NTC_SLOPE_SHIFT }
+static const ntc_segment_t ntcsegs[NTC_SEGMENTS + 1] = {
+    {  4576,  16143,  -8485 },
+    {  4800,  15679,  -8010 },
+    {  5056,  15179,  -7559 },
+    {  5312,  14706,  -7134 },
+    {  5600,  14205,  -6734 },
+    {  5888,  13731,  -6361 },
+    {  6208,  13234,  -5995 },
+    {  6560,  12719,  -5657 },
+    {  6912,  12233,  -5346 },
+    {  7296,  11732,  -5048 },
+    {  7712,  11219,  -4766 },
+    {  8160,  10698,  -4501 },
+    {  8640,  10170,  -4254 },
+    {  9152,   9638,  -4025 },
+    {  9696,   9104,  -3809 },
+    { 10304,   8538,  -3608 },
+    { 10944,   7975,  -3423 },
+    { 11648,   7386,  -3250 },
+    { 12416,   6777,  -3094 },
+    { 13248,   6149,  -2951 },
+    { 14176,   5480,  -2822 },
+    { 15232,   4752,  -2709 },
+    { 16448,   3948,  -2614 },
+    { 17984,   2968,  -2556 },
+    { 22016,    452,  -2635 },
+    { 23360,   -413,  -2742 },
+    { 24448,  -1141,  -2873 },
+    { 25344,  -1770,  -3022 },
+    { 26112,  -2336,  -3191 },
+    { 26784,  -2860,  -3383 },
+    { 27392,  -3362,  -3600 },
+    { 27936,  -3840,  -3841 },
+    { 28416,  -4290,  -4113 },
+    { 28864,  -4740,  -4299 },
+    { 28960,  -4841,      0 }, // end of table
+};
@@ -0,0 +1,27 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+
+// ── Power-of-two rings ────────────────────────────────────────────────────
+//
+// Index arithmetic shared by the byte-indexed queues (eecommit, events,
+// keys).  The size must be a power of two no larger than 128; each user
+// checks that with
+//
+//   #if FOO_QUEUE_SIZE & RING_MASK(FOO_QUEUE_SIZE)
+//   #error "FOO_QUEUE_SIZE must be a power of two"
+//   #endif
+
+#define RING_MASK(size)                 ((size) - 1)
+
+// Slot after i
+#define RING_NEXT(i, size)              ((uint8_t)(((i) + 1) & RING_MASK(size)))
+
+// Oldest of count entries ending just before head
+#define RING_OLDEST(head, count, size)  ((uint8_t)(((head) - (count)) & RING_MASK(size)))
+
+// Free slots between head and tail, one always left empty
+#define RING_ROOM(head, tail, size)     ((uint8_t)(((tail) - (head) - 1) & RING_MASK(size)))
+
+#endif /* RING_H */
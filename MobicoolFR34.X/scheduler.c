@@ -0,0 +1,152 @@
+#include "mcc_generated_files/mcc.h"
+#include "scheduler.h"
+#include <stddef.h>
+
+// ── State ─────────────────────────────────────────────────────────────────
+static volatile uint8_t s_ticks = 0;    // Incremented by the TMR1 ISR
+static uint8_t s_lastticks = 0;         // Tick count already handed out
+
+static sched_task_t* s_tasks = NULL;
+static uint8_t s_numtasks = 0;
+static bool s_background = false;       // Any period-0 tasks in the table
+
+static sched_stat_t s_loop;             // Busy time per Scheduler_Run() pass
+static uint16_t s_hist[SCHED_HIST_BUCKETS];
+
+// ── Tick ISR (called from TMR1_ISR) ──────────────────────────────────────
+static void scheduler_tick(void) {
+    s_ticks++;
+}
+
+// ── Timestamps ────────────────────────────────────────────────────────────
+uint8_t Scheduler_GetTicks(void) {
+    return s_ticks;
+}
+
+void Scheduler_Stamp(sched_stamp_t* stamp) {
+    // TMR1 is read a byte at a time, so re-read if the high byte moved
+    // under us or the tick ISR fired in between
+    uint8_t high;
+    do {
+        stamp->ticks = s_ticks;
+        high = TMR1H;
+        stamp->count = TMR1_ReadTimer();
+    } while (stamp->ticks != s_ticks || high != (uint8_t)(stamp->count >> 8));
+}
+
+uint16_t Scheduler_Elapsed(const sched_stamp_t* stamp) {
+    sched_stamp_t now;
+    Scheduler_Stamp(&now);
+    // TMR1 counts up from SCHED_TMR1_RELOAD each tick, so whole ticks plus
+    // the counter difference gives the span (modulo 2^16, i.e. < 65 ms)
+    uint8_t dticks = (uint8_t)(now.ticks - stamp->ticks);
+    return (uint16_t)((uint16_t)dticks * SCHED_TICK_COUNTS + now.count - stamp->count);
+}
+
+// ── Statistics ────────────────────────────────────────────────────────────
+void Scheduler_StatAdd(sched_stat_t* stat, uint16_t cycles) {
+    stat->last = cycles;
+    if (stat->runs == 0 || cycles < stat->min) stat->min = cycles;
+    if (cycles > stat->max) stat->max = cycles;
+    if (stat->runs == 0xFFFF) {
+        // Halve both so the mean keeps following recent behaviour
+        stat->runs >>= 1;
+        stat->sum >>= 1;
+    }
+    stat->runs++;
+    stat->sum += cycles;
+}
+
+uint16_t Scheduler_StatAvg(const sched_stat_t* stat) {
+    if (stat->runs == 0) return 0;
+    return (uint16_t)((stat->sum + stat->runs / 2) / stat->runs);
+}
+
+static void hist_add(uint16_t cycles) {
+    uint16_t v = cycles >> SCHED_HIST_SHIFT;
+    uint8_t b = 0;
+    while (v && b < SCHED_HIST_BUCKETS - 1) {
+        v >>= 1;
+        b++;
+    }
+    if (s_hist[b] == 0xFFFF) {
+        // Keep the shape, lose the absolute count
+        for (uint8_t i = 0; i < SCHED_HIST_BUCKETS; i++) s_hist[i] >>= 1;
+    }
+    s_hist[b]++;
+}
+
+const sched_stat_t* Scheduler_GetLoopStat(void) {
+    return &s_loop;
+}
+
+const uint16_t* Scheduler_GetHistogram(void) {
+    return s_hist;
+}
+
+// ── Dispatcher ────────────────────────────────────────────────────────────
+static void run_task(sched_task_t* t) {
+    sched_stamp_t start;
+    Scheduler_Stamp(&start);
+    t->run();
+    Scheduler_StatAdd(&t->stat, Scheduler_Elapsed(&start));
+}
+
+static void count_miss(sched_task_t* t) {
+    if (t->misses < 255) t->misses++;
+}
+
+void Scheduler_Initialize(sched_task_t* tasks, uint8_t num) {
+    s_tasks = tasks;
+    s_numtasks = num;
+    s_background = false;
+    for (uint8_t i = 0; i < num; i++) {
+        if (tasks[i].period == 0) s_background = true;
+        if (tasks[i].countdown == 0) tasks[i].countdown = tasks[i].period;
+        tasks[i].released = 0;
+    }
+    s_lastticks = s_ticks;
+    TMR1_SetInterruptHandler(scheduler_tick);
+}
+
+void Scheduler_Run(void) {
+    // Without background work there is nothing to do until the next tick
+    if (!s_background) {
+        while (s_ticks == s_lastticks) {
+            SCHEDULER_IDLE();
+        }
+    }
+
+    sched_stamp_t pass;
+    Scheduler_Stamp(&pass);
+
+    // Release everything that became due during the elapsed ticks
+    while (s_lastticks != s_ticks) {
+        s_lastticks++;
+        for (uint8_t i = 0; i < s_numtasks; i++) {
+            sched_task_t* t = &s_tasks[i];
+            if (t->period == 0) continue;
+            if (t->released && t->released < 255) t->released++;
+            if (--t->countdown == 0) {
+                t->countdown = t->period;
+                if (t->released) count_miss(t); // Still pending from last period
+                t->released = 1;
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < s_numtasks; i++) {
+        sched_task_t* t = &s_tasks[i];
+        if (t->period == 0) {
+            run_task(t);
+        } else if (t->released) {
+            if (t->released > t->deadline) count_miss(t);
+            t->released = 0;
+            run_task(t);
+        }
+    }
+
+    uint16_t busy = Scheduler_Elapsed(&pass);
+    Scheduler_StatAdd(&s_loop, busy);
+    hist_add(busy);
+}
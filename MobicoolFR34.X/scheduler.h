@@ -0,0 +1,83 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Tick-driven cooperative scheduler ─────────────────────────────────────
+//
+// TMR1 interrupts every SCHED_TICK_MS and only bumps a tick counter.  The
+// main loop calls Scheduler_Run(), which releases every task whose period
+// has elapsed and runs the released tasks to completion in table order
+// (table order == priority).  Nothing runs between ticks except background
+// tasks (period 0), which are called on every pass of the main loop.
+//
+// Every task run is timed with TMR1 so the cost of each task, the number of
+// missed deadlines and a histogram of the busy time per tick can be read back
+// at runtime (TMR0 belongs to the single-wire link and is not used here).
+
+#define SCHED_TICK_MS       10
+#define SCHED_TICK_COUNTS   10000   // TMR1 counts per tick (Fosc/4 prescaled to 1 µs)
+#define SCHED_TMR1_RELOAD   (0x10000UL - SCHED_TICK_COUNTS)
+#define SCHED_MS(ms)        ((uint8_t)((ms) / SCHED_TICK_MS))
+
+// Running min/avg/max of a measured span, in TMR1 counts (1 µs)
+typedef struct {
+    uint16_t last;       // Most recent sample
+    uint16_t min;
+    uint16_t max;
+    uint16_t runs;       // Samples in sum; both are halved when runs saturates
+    uint32_t sum;
+} sched_stat_t;
+
+typedef struct {
+    void    (*run)(void);
+    uint8_t period;      // Ticks between releases, 0 = background (every pass)
+    uint8_t deadline;    // Ticks after release by which the task must have started
+    uint8_t countdown;   // Ticks until next release; initial value = phase offset
+    uint8_t released;    // Ticks since release, 0 = not released
+
+    sched_stat_t stat;   // Run time statistics
+    uint8_t  misses;     // Deadline misses and overruns (saturating)
+} sched_task_t;
+
+// Point in time with TMR1 resolution, valid for spans up to ~65 ms
+typedef struct {
+    uint8_t  ticks;
+    uint16_t count;
+} sched_stamp_t;
+
+// Idle hook executed while waiting for the next tick.  The PIC16F1829 has
+// no Idle mode and TMR1 is clocked from Fosc/4 (stops in Sleep), so this
+// is just a spin that leaves the CPU to the interrupt handlers.
+#ifndef SCHEDULER_IDLE
+#define SCHEDULER_IDLE() NOP()
+#endif
+
+// Hook the TMR1 interrupt and take ownership of the task table
+void Scheduler_Initialize(sched_task_t* tasks, uint8_t num);
+
+// Release due tasks and run them; call from the main loop forever
+void Scheduler_Run(void);
+
+// Busy time per pass of Scheduler_Run(), i.e. per tick with work to do.
+// Bucket 0 counts passes under 256 µs, bucket n passes under 256 << n µs,
+// the last bucket everything from 16 ms (over a whole tick) up.
+#define SCHED_HIST_BUCKETS  8
+#define SCHED_HIST_SHIFT    8
+
+const sched_stat_t* Scheduler_GetLoopStat(void);
+const uint16_t* Scheduler_GetHistogram(void);      // SCHED_HIST_BUCKETS counts
+
+// Free-running tick counter (wraps every 2.56 s)
+uint8_t Scheduler_GetTicks(void);
+
+// Timestamp helpers for measuring code with TMR1 resolution
+void Scheduler_Stamp(sched_stamp_t* stamp);
+uint16_t Scheduler_Elapsed(const sched_stamp_t* stamp);
+
+// Accumulate one measured span, e.g. Scheduler_Elapsed() around a driver call
+void Scheduler_StatAdd(sched_stat_t* stat, uint16_t cycles);
+uint16_t Scheduler_StatAvg(const sched_stat_t* stat);
+
+#endif /* SCHEDULER_H */
@@ -1,51 +1,97 @@
 #include "settings.h"
-#include "mcc_generated_files/memory.h"
+#include "journal.h"
+#include "eecommit.h"
 
-#define MAGIC ('W')
+// Settings record payload
+typedef struct {
+    uint8_t on;
+    int8_t temp_setpoint;
+    uint8_t battmon;
+} settings_record_t;
+
+static journal_t s_journal = {
+    EE_SETTINGS_BASE, EE_SETTINGS_SLOTS, sizeof(settings_record_t), 0x53
+};
+static settings_record_t s_record; // Current settings, saved or not
+static bool s_dirty;                // s_record differs from the newest record
+static uint8_t s_quiet;             // Settings_Tick() calls since the last change
+
+static bool record_sane(const settings_record_t* record) {
+    return record->on <= 1 &&
+           record->temp_setpoint >= MIN_TEMP && record->temp_setpoint <= MAX_TEMP &&
+           record->battmon <= BMON_HIGH;
+}
+
+static void changed(void) {
+    s_dirty = true;
+    s_quiet = 0;
+}
 
 void Settings_Initialize(settings_t* settings) {
-    bool eeinvalid = false;
+    uint8_t layout = EECommit_Read(EE_LAYOUT);
+    bool valid = false;
 
-    // Check if EEPROM data is valid
-    if (DATAEE_ReadByte(EE_MAGIC) != MAGIC) {
-        eeinvalid = true;
-    }
-    
-    // Read settings
-    settings->on = DATAEE_ReadByte(EE_ONOFF);
-    settings->temp_setpoint = (int8_t)DATAEE_ReadByte(EE_TEMP);
-    if (settings->temp_setpoint < MIN_TEMP || settings->temp_setpoint > MAX_TEMP) {
-        eeinvalid = true;
-    }
-    
-    settings->battmon = DATAEE_ReadByte(EE_BATTMON);
-    if (settings->battmon > BMON_HIGH) {
-        eeinvalid = true;
+    if (layout == EE_LAYOUT_JOURNAL) {
+        valid = Journal_Load(&s_journal, &s_record) && record_sane(&s_record);
+    } else if (layout == EE_LAYOUT_LEGACY) {
+        // The fixed-address settings sit below the ring and the marker is
+        // written last, so an interrupted migration simply runs again.
+        s_record.on = EECommit_Read(EE_ONOFF);
+        s_record.temp_setpoint = (int8_t)EECommit_Read(EE_TEMP);
+        s_record.battmon = EECommit_Read(EE_BATTMON);
+        valid = record_sane(&s_record);
     }
 
     // Initialize with defaults if invalid
-    if (eeinvalid) {
-        settings->on = true;
-        DATAEE_WriteByte(EE_ONOFF, settings->on);
-        
-        settings->temp_setpoint = DEFAULT_TEMP;
-        DATAEE_WriteByte(EE_TEMP, (uint8_t)settings->temp_setpoint);
-        
-        settings->battmon = BMON_LOW;
-        DATAEE_WriteByte(EE_BATTMON, (uint8_t)settings->battmon);
-        
-        DATAEE_WriteByte(EE_MAGIC, MAGIC);
+    if (!valid) {
+        s_record.on = true;
+        s_record.temp_setpoint = DEFAULT_TEMP;
+        s_record.battmon = BMON_LOW;
+    }
+    s_dirty = false;
+    if (layout != EE_LAYOUT_JOURNAL || !valid) {
+        Journal_Format(&s_journal);
+        EECommit_Flush();
+        Journal_Append(&s_journal, &s_record);
     }
+    if (layout != EE_LAYOUT_JOURNAL) {
+        static const uint8_t marker = EE_LAYOUT_JOURNAL;
+        EECommit_Write(EE_LAYOUT, &marker, 1); // Queued behind the record
+    }
+
+    settings->on = s_record.on;
+    settings->temp_setpoint = s_record.temp_setpoint;
+    settings->battmon = s_record.battmon;
 }
 
 void Settings_SaveOnOff(bool on) {
-    DATAEE_WriteByte(EE_ONOFF, on);
+    if (s_record.on == on) return;
+    s_record.on = on;
+    changed();
 }
 
 void Settings_SaveTemp(int8_t temp) {
-    DATAEE_WriteByte(EE_TEMP, (uint8_t)temp);
+    if (s_record.temp_setpoint == temp) return;
+    s_record.temp_setpoint = temp;
+    changed();
 }
 
 void Settings_SaveBattMon(bmon_t level) {
-    DATAEE_WriteByte(EE_BATTMON, (uint8_t)level);
+    if (s_record.battmon == level) return;
+    s_record.battmon = (uint8_t)level;
+    changed();
+}
+
+void Settings_Tick(void) {
+    if (!s_dirty) return;
+    if (++s_quiet >= SETTINGS_COMMIT_DELAY) {
+        Settings_Commit();
+    }
+}
+
+void Settings_Commit(void) {
+    // A full queue leaves s_dirty set and the next Settings_Tick() retries
+    if (s_dirty && Journal_Append(&s_journal, &s_record)) {
+        s_dirty = false;
+    }
 }
@@ -4,7 +4,21 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-// EEPROM data locations
+// Data EEPROM layout: a layout marker, then three journals (journal.h) that
+// share the rest of the 256 bytes.  Firmware before the journals kept the
+// settings at fixed addresses after a 'W' marker; that layout is migrated
+// on the first boot.
+#define EE_LAYOUT           0x00
+#define EE_LAYOUT_LEGACY    'W'
+#define EE_LAYOUT_JOURNAL   'J'
+#define EE_SETTINGS_BASE    0x08    // 16 settings records (settings.c)
+#define EE_SETTINGS_SLOTS   16
+#define EE_EFFMAP_BASE      0x58    // 2 efficiency map records (effmap.c)
+#define EE_EFFMAP_SLOTS     2
+#define EE_ENERGY_BASE      0x80    // 7 energy records (energy.c)
+#define EE_ENERGY_SLOTS     7
+
+// Legacy fixed layout, read once for the migration
 typedef enum {
     EE_MAGIC = 0,
     EE_ONOFF,
@@ -18,8 +32,9 @@ typedef enum {
 #define MIN_TEMP (-18)
 #define DEFAULT_TEMP MAX_TEMP
 // System constants
-#define AVERAGING_SAMPLES 64
-#define AVERAGING_ROUNDING 32  // = AVERAGING_SAMPLES/2, added before >>6 for correct rounding
+#define AVERAGING_SHIFT 2      // Average 4 published analog readings (~1s)
+#define AVERAGING_SAMPLES (1 << AVERAGING_SHIFT)
+#define AVERAGING_ROUNDING (AVERAGING_SAMPLES / 2) // Added before the shift for correct rounding
 #define MIN_VALID_TEMP (-200)  // -20.0°C (below the -18°C minimum setpoint)
 #define MAX_VALID_TEMP 500     // 50.0°C
 #define VOLTAGE_HYSTERESIS 5   // 0.5V hysteresis for battery protection
@@ -30,8 +45,8 @@ typedef enum {
 #define LONG_PRESS_TIME 20     // Long press detection time in 100ms units
 #define HIGH_POWER_THRESHOLD 45    // High power threshold for compressor speed reduction (Normal mode)
 #define HIGH_POWER_THRESHOLD_ECO 30 // Power threshold for Eco mode
-#define TEMP_HYSTERESIS_DEFAULT 10 // 1.0°C restart offset in normal/Hi mode
-#define TEMP_HYSTERESIS_ECO 20    // 2.0°C restart offset in Eco mode
+#define TEMP_HYSTERESIS_DEFAULT 10 // 1.0°C restart offset in normal/Hi mode, before cycles.h adapts it
+#define TEMP_HYSTERESIS_ECO 20    // 2.0°C restart offset in Eco mode, likewise
 #define TEMP_OVERSHOOT_HI 20      // 2.0°C extra cooling before Hi mode shuts down
 
 
@@ -49,12 +64,22 @@ typedef struct {
     bmon_t battmon;
 } settings_t;
 
+// Changes are written once nothing has changed for SETTINGS_COMMIT_DELAY
+// calls of Settings_Tick(), so stepping through values costs one record
+#define SETTINGS_COMMIT_DELAY 20   // 100ms units
+
 // Initialize settings from EEPROM
 void Settings_Initialize(settings_t* settings);
 
-// Save individual settings to EEPROM
+// Record individual settings changes; they reach EEPROM from Settings_Tick()
 void Settings_SaveOnOff(bool on);
 void Settings_SaveTemp(int8_t temp);
 void Settings_SaveBattMon(bmon_t level);
 
+// Every 100ms: commit pending changes once they have settled
+void Settings_Tick(void);
+
+// Commit pending changes now, e.g. when the supply is going away
+void Settings_Commit(void);
+
 #endif /* SETTINGS_H */
@@ -0,0 +1,135 @@
+#include "models.h"
+#include "sim.h"
+#include <string.h>
+
+// ── ESP32 companion on RA0 ────────────────────────────────────────────────
+//
+// An 8N1 UART sharing the open-drain line with the PIC, like
+// comms_master.cpp: it drives the request out, then listens for the reply.
+// Reception samples the line at the centre of each bit after a falling edge.
+// It starts at 9600 baud, as the PIC does.
+
+#define LINE_BIT    0   // PORTA
+
+static uint64_t s_bit;      // ns per bit
+
+static uint8_t s_tx[LINK_MAX_FRAME];
+static uint8_t s_txlen;
+static uint8_t s_txpos;
+static uint8_t s_txbit;
+static bool s_sending;
+static sim_event_t s_tx_ev;
+
+static uint8_t s_rx[LINK_MAX_FRAME];
+static uint8_t s_rxlen;
+static uint8_t s_rxbit;
+static uint8_t s_rxshift;
+static bool s_receiving;
+static sim_event_t s_rx_ev;
+
+static void link_tx(sim_event_t* ev) {
+    if (s_txpos == s_txlen) {
+        s_sending = false;
+        return;
+    }
+    uint8_t b = s_tx[s_txpos];
+    bool level;
+    if (s_txbit == 0) level = false;                    // start
+    else if (s_txbit <= 8) level = (b >> (s_txbit - 1)) & 1;
+    else level = true;                                  // stop
+    Sim_SetInput(SIM_PORTA, LINE_BIT, level);
+    if (++s_txbit == 10) {
+        s_txbit = 0;
+        s_txpos++;
+    }
+    Sim_Schedule(ev, ev->at + s_bit);
+}
+
+static void link_rx(sim_event_t* ev) {
+    bool level = Sim_GetPin(SIM_PORTA, LINE_BIT);
+    if (s_rxbit == 0) {
+        if (level) { s_receiving = false; return; }     // glitch
+    } else if (s_rxbit <= 8) {
+        s_rxshift = (uint8_t)((s_rxshift >> 1) | (level ? 0x80 : 0));
+    } else {
+        if (level && s_rxlen < LINK_MAX_FRAME) s_rx[s_rxlen++] = s_rxshift;
+        s_receiving = false;
+        return;
+    }
+    s_rxbit++;
+    Sim_Schedule(ev, ev->at + s_bit);
+}
+
+static void link_pins(uint8_t port, uint8_t level, uint8_t changed) {
+    if (port != SIM_PORTA || !(changed & (1 << LINE_BIT))) return;
+    if (s_sending || s_receiving || (level & (1 << LINE_BIT))) return;
+    s_receiving = true;
+    s_rxbit = 0;
+    s_rxshift = 0;
+    Sim_Schedule(&s_rx_ev, Sim_Now() + s_bit / 2);
+}
+
+void Link_Send(const uint8_t* bytes, uint8_t len) {
+    if (len > LINK_MAX_FRAME) len = LINK_MAX_FRAME;
+    memcpy(s_tx, bytes, len);
+    s_txlen = len;
+    s_txpos = 0;
+    s_txbit = 0;
+    s_rxlen = 0;
+    s_sending = true;
+    Sim_Schedule(&s_tx_ev, Sim_Now());
+}
+
+void Link_Request(uint8_t cmd, const uint8_t* payload, uint8_t len) {
+    uint8_t frame[LINK_MAX_FRAME];
+    frame[0] = 0xAA;
+    frame[1] = cmd;
+    frame[2] = len;
+    memcpy(&frame[3], payload, len);
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < 3 + len; i++) crc ^= frame[i];
+    frame[3 + len] = crc;
+    Link_Send(frame, (uint8_t)(4 + len));
+}
+
+uint8_t Link_Crc8(const uint8_t* bytes, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *bytes++;
+        for (int i = 0; i < 8; i++) crc = (uint8_t)(crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1);
+    }
+    return crc;
+}
+
+void Link_RequestV2(uint8_t seq, uint8_t cmd, const uint8_t* payload, uint8_t len) {
+    uint8_t frame[LINK_MAX_FRAME];
+    frame[0] = 0xA5;
+    frame[1] = seq;
+    frame[2] = cmd;
+    frame[3] = len;
+    memcpy(&frame[4], payload, len);
+    frame[4 + len] = Link_Crc8(frame, (uint8_t)(4 + len));
+    Link_Send(frame, (uint8_t)(5 + len));
+}
+
+void Link_SetBaud(uint32_t baud) {
+    s_bit = 1000000000ULL / baud;
+}
+
+bool Link_Busy(void) {
+    return s_sending || s_receiving;
+}
+
+uint8_t Link_Response(uint8_t* buf) {
+    memcpy(buf, s_rx, s_rxlen);
+    return s_rxlen;
+}
+
+void Link_Init(void) {
+    s_txlen = s_rxlen = 0;
+    s_sending = s_receiving = false;
+    Link_SetBaud(9600);
+    s_tx_ev.fn = link_tx;
+    s_rx_ev.fn = link_rx;
+    Sim_AddPinListener(link_pins);
+}
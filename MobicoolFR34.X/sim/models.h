@@ -0,0 +1,79 @@
+#ifndef SIM_MODELS_H
+#define SIM_MODELS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Cooler plant: cabinet thermals, supply, IRMCF183 motor drive ──────────
+typedef enum {
+    PLANT_REPLY_ACK = 0,    // 0xE1 after every valid frame
+    PLANT_REPLY_NONE,       // controller missing
+    PLANT_REPLY_GARBLED     // answers, but with noise
+} plant_reply_t;
+
+typedef struct {
+    // Parameters
+    double ambient;         // °C
+    double supply;          // open-circuit supply voltage, V
+    double supply_r;        // supply + wiring resistance, ohm
+    double capacity;        // cabinet heat capacity, J/K
+    double ua;              // insulation loss, W/K
+    double watts_per_speed; // cooling power per IRMCF183 speed unit, W
+    double cop;             // cooling power / electrical power
+    double cop_peak;        // speed of the best COP, 0 = same COP at every speed
+    double cop_droop;       // COP lost one cop_peak away from it, fraction
+    plant_reply_t reply;    // how the IRMCF183 answers commands
+
+    // State
+    double cabinet;         // °C
+    bool comp_cmd;          // last IRMCF183 on/off command
+    uint8_t comp_speed;     // last IRMCF183 speed command
+    bool comp_running;      // command and 12 V rail both on
+    double comp_watts;      // electrical input
+    double energy_wh;       // compressor energy since start
+    double board_ma;        // control board, light and fan draw, last step
+    double board_mah;       // its charge since start
+
+    // Statistics
+    uint32_t frames;        // valid IRMCF183 frames
+    uint32_t bad_frames;
+    uint32_t starts;
+    uint64_t last_start;
+    uint64_t last_stop;
+    uint64_t min_on;        // shortest completed run
+    uint64_t min_off;       // shortest rest between runs
+    uint64_t runtime;       // total compressor run time
+} plant_t;
+
+extern plant_t plant;
+
+void Plant_Init(void);
+double Plant_SupplyVoltage(void);   // at the terminals, under load
+
+// ── TM1620B display / keypad ──────────────────────────────────────────────
+#define PANEL_KEY_MINUS   (1 << 0)
+#define PANEL_KEY_PLUS    (1 << 1)
+#define PANEL_KEY_SET     (1 << 2)
+#define PANEL_KEY_ONOFF   (1 << 3)
+
+void Panel_Init(void);
+void Panel_SetKeys(uint8_t keys);
+void Panel_GetBuffer(uint8_t buf[5]);   // same layout as TM1620B_Update()
+const char* Panel_Text(void);           // digits 1-4 as text, a digit's dot precedes it
+uint8_t Panel_Brightness(void);         // 0-7, or 0xFF when blanked
+uint32_t Panel_Updates(void);           // display RAM writes seen
+void Panel_Glitch(void);                // display RAM lost to interference
+
+// ── ESP32 companion on the RA0 single-wire link ───────────────────────────
+#define LINK_MAX_FRAME    48
+
+void Link_Init(void);
+void Link_Send(const uint8_t* bytes, uint8_t len);  // raw bytes, 8N1
+void Link_SetBaud(uint32_t baud);                   // 9600 after Link_Init()
+void Link_Request(uint8_t cmd, const uint8_t* payload, uint8_t len);  // v1 frame
+void Link_RequestV2(uint8_t seq, uint8_t cmd, const uint8_t* payload, uint8_t len);
+uint8_t Link_Crc8(const uint8_t* bytes, uint8_t len);  // v2 frame CRC
+bool Link_Busy(void);
+uint8_t Link_Response(uint8_t* buf);    // bytes received since the last send
+
+#endif // SIM_MODELS_H
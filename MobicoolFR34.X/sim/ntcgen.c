@@ -0,0 +1,73 @@
+// Generates ../ntc_table.h, the piecewise-linear NTC segment table used by
+// ntc.c:  make ntc-table
+//
+// The curve is the same Beta 2670 K formula the old per-count table was
+// generated from.  Segments are grown greedily from the hot end for as long
+// as the chord stays within NTCGEN_TOL of the curve at every 1/32 count, so
+// the steep ends of the divider get short segments and the flat middle long
+// ones.  Chord end points sit exactly on the curve, which keeps consecutive
+// segments continuous.
+
+#include "../ntc.h"
+#include <math.h>
+#include <stdio.h>
+
+#define NTCGEN_BETA     2670.0
+#define NTCGEN_TOL      0.25    // °C / 10, worst chord error per segment
+#define NTCGEN_FIRST    143     // ADC counts covered by the table
+#define NTCGEN_LAST     905
+
+#define ONE             (1 << NTC_FRAC_BITS)
+
+// Temperature in tenths of °C at ADC reading adc (fractional counts)
+static double ntc_temp10(double adc) {
+    double r = (10000.0 * adc) / (1023.0 - adc);
+    return 10 * ((1 / ((log(r / 10000.0) / NTCGEN_BETA) + (1 / (273.15 + 25.000)))) - 273.15);
+}
+
+static double chord_error(int x0, int x1) {
+    double y0 = ntc_temp10(x0), y1 = ntc_temp10(x1), worst = 0;
+    for (int s = x0 * ONE; s <= x1 * ONE; s++) {
+        double x = (double)s / ONE;
+        double e = fabs(y0 + (y1 - y0) * (x - x0) / (x1 - x0) - ntc_temp10(x));
+        if (e > worst) worst = e;
+    }
+    return worst;
+}
+
+static long q4(double temp10) {
+    return lround(temp10 * (1 << NTC_TEMP_FRAC_BITS));
+}
+
+int main(void) {
+    int ends[NTCGEN_LAST - NTCGEN_FIRST + 1];
+    int n = 0;
+    for (int x0 = NTCGEN_FIRST; x0 < NTCGEN_LAST; ) {
+        int x1 = x0 + 1;
+        while (x1 < NTCGEN_LAST && chord_error(x0, x1 + 1) <= NTCGEN_TOL) x1++;
+        ends[n++] = x1;
+        x0 = x1;
+    }
+
+    printf("// Generated by sim/ntcgen.c (make -C sim ntc-table), do not edit.\n");
+    printf("// 10k NTC with Beta %.0f K against 10k to VDD, ADC %d..%d in %d segments,\n",
+           NTCGEN_BETA, NTCGEN_FIRST, NTCGEN_LAST, n);
+    printf("// chord error at most %.2f tenths of a degree.\n\n", NTCGEN_TOL);
+    printf("#define NTC_SEGMENTS (%d)\n\n", n);
+    printf("// { start << NTC_FRAC_BITS, temperature, slope << NTC_SLOPE_SHIFT }\n");
+    printf("static const ntc_segment_t ntcsegs[NTC_SEGMENTS + 1] = {\n");
+    int x0 = NTCGEN_FIRST;
+    for (int i = 0; i <= n; i++) {
+        long slope = 0;
+        if (i < n) {
+            int x1 = ends[i];
+            double dy = (ntc_temp10(x1) - ntc_temp10(x0)) * (1 << NTC_TEMP_FRAC_BITS);
+            slope = lround(dy / ((x1 - x0) * ONE) * (1L << NTC_SLOPE_SHIFT));
+        }
+        printf("    { %5d, %6ld, %6ld },%s\n", x0 * ONE, q4(ntc_temp10(x0)), slope,
+               i == n ? " // end of table" : "");
+        if (i < n) x0 = ends[i];
+    }
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Host check of NtcToTemp10() against the Beta 2670 K curve and the
+// per-count ntcmap[] table it replaces (ADC 144..904, whole tenths).
+
+#include "../ntc.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ONE     (1 << NTC_FRAC_BITS)
+
+static double ntc_temp10(double adc) {
+    double r = (10000.0 * adc) / (1023.0 - adc);
+    return 10 * ((1 / ((log(r / 10000.0) / 2670.0) + (1 / (273.15 + 25.000)))) - 273.15);
+}
+
+int main(void) {
+    bool ok = true;
+    int exact = 0, counts = 0, prev = 32767;
+    double worst = 0;
+
+    // Every whole count against the old table, which was round(ntc_temp10(i))
+    for (int i = 144; i <= 904; i++) {
+        int want = (int)round(ntc_temp10(i));
+        int got = NtcToTemp10((uint16_t)(i * ONE));
+        counts++;
+        if (got == want) exact++;
+        if (abs(got - want) > 1) {
+            printf("  ADC %d: %d, table %d\n", i, got, want);
+            ok = false;
+        }
+    }
+
+    // Every 1/32 count against the curve, and no steps backwards
+    for (int s = 144 * ONE; s <= 904 * ONE; s++) {
+        int got = NtcToTemp10((uint16_t)s);
+        double e = fabs(got - ntc_temp10((double)s / ONE));
+        if (e > worst) worst = e;
+        if (got > prev) {
+            printf("  reading %d: %d after %d\n", s, got, prev);
+            ok = false;
+        }
+        prev = got;
+    }
+    if (worst > 0.8) ok = false;
+
+    if (NtcToTemp10(0) != NTC_TOO_HOT || NtcToTemp10(140 * ONE) != NTC_TOO_HOT) ok = false;
+    if (NtcToTemp10(910 * ONE) != NTC_TOO_COLD || NtcToTemp10(1023 * ONE) != NTC_TOO_COLD) ok = false;
+
+    printf("ntc        %d of %d counts match the table, worst error %.2f tenths\n",
+           exact, counts, worst);
+    printf("ntc        %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include "models.h"
+#include "sim.h"
+#include <string.h>
+
+// ── TM1620B display / keypad ──────────────────────────────────────────────
+//
+// Follows the three-wire bus (STB = RC4, CLK = RC5, DIO = RA4) edge by edge:
+// bytes are clocked in LSB first on CLK rising edges while STB is low, the
+// first byte after STB falls is a command, the rest are display data.  After
+// a key-read command the chip drives DIO on each CLK falling edge.
+
+#define STB_BIT     4   // PORTC
+#define CLK_BIT     5   // PORTC
+#define DIO_BIT     4   // PORTA
+
+static uint8_t s_ram[16];
+static uint8_t s_addr;
+static bool s_fixed;
+static uint8_t s_ctrl;
+static uint8_t s_keys;
+static uint32_t s_updates;
+
+static bool s_selected;
+static bool s_first;
+static bool s_reading;
+static uint8_t s_shift;
+static uint8_t s_bits;
+static uint8_t s_rdbit;
+
+// Keys are reported in bit 1 and bit 4 of the first two key bytes
+static bool key_bit(uint8_t n) {
+    uint8_t byte = n / 8, bit = n % 8;
+    uint8_t v = 0;
+    if (byte == 0) v = (uint8_t)(((s_keys & PANEL_KEY_MINUS) ? 0x02 : 0) | ((s_keys & PANEL_KEY_PLUS) ? 0x10 : 0));
+    if (byte == 1) v = (uint8_t)(((s_keys & PANEL_KEY_SET) ? 0x02 : 0) | ((s_keys & PANEL_KEY_ONOFF) ? 0x10 : 0));
+    return (v >> bit) & 1;
+}
+
+static void panel_byte(uint8_t b) {
+    if (!s_first) {
+        s_ram[s_addr] = b;
+        if (!s_fixed) s_addr = (s_addr + 1) & 0x0F;
+        s_updates++;
+        return;
+    }
+    s_first = false;
+    switch (b >> 6) {
+        case 1:     // data command
+            if (b & 0x02) {
+                s_reading = true;
+                s_rdbit = 0;
+            }
+            s_fixed = (b & 0x04) != 0;
+            break;
+        case 2:     // display control
+            s_ctrl = b;
+            break;
+        case 3:     // address
+            s_addr = b & 0x0F;
+            break;
+        default:    // display mode
+            break;
+    }
+}
+
+static void panel_pins(uint8_t port, uint8_t level, uint8_t changed) {
+    if (port != SIM_PORTC) return;
+
+    if (changed & (1 << STB_BIT)) {
+        s_selected = !(level & (1 << STB_BIT));
+        s_first = true;
+        s_bits = 0;
+        s_shift = 0;
+        if (!s_selected) {
+            s_reading = false;
+            Sim_SetInput(SIM_PORTA, DIO_BIT, true);
+        }
+    }
+    if (!s_selected || !(changed & (1 << CLK_BIT))) return;
+
+    if (s_reading) {
+        if (!(level & (1 << CLK_BIT))) Sim_SetInput(SIM_PORTA, DIO_BIT, key_bit(s_rdbit++));
+        return;
+    }
+    if (level & (1 << CLK_BIT)) {
+        if (Sim_GetPin(SIM_PORTA, DIO_BIT)) s_shift |= (uint8_t)(1u << s_bits);
+        if (++s_bits == 8) {
+            panel_byte(s_shift);
+            s_bits = 0;
+            s_shift = 0;
+        }
+    }
+}
+
+void Panel_SetKeys(uint8_t keys) {
+    s_keys = keys;
+}
+
+void Panel_GetBuffer(uint8_t buf[5]) {
+    // TM1620B_Update() writes buf[4] first: segments 1-6, then 12-13 >> 3
+    for (uint8_t k = 0; k < 5; k++) {
+        buf[4 - k] = (uint8_t)((s_ram[2 * k] & 0x3F) | ((s_ram[2 * k + 1] << 3) & 0xC0));
+    }
+}
+
+const char* Panel_Text(void) {
+    static const struct { uint8_t seg; char ch; } glyphs[] = {
+        { 0x7D, '0' }, { 0x28, '1' }, { 0xDC, '2' }, { 0xBC, '3' }, { 0xA9, '4' },
+        { 0xB5, '5' }, { 0xF5, '6' }, { 0x2C, '7' }, { 0xFD, '8' }, { 0xBD, '9' },
+        { 0xED, 'A' }, { 0xF1, 'b' }, { 0x55, 'C' }, { 0xF8, 'd' }, { 0xD5, 'E' },
+        { 0xC5, 'F' }, { 0xE1, 'h' }, { 0xE9, 'H' }, { 0x20, 'i' }, { 0x78, 'J' },
+        { 0x51, 'L' }, { 0x6D, 'M' }, { 0xF0, 'o' }, { 0xCD, 'P' }, { 0xC0, 'r' },
+        { 0xD1, 't' }, { 0x79, 'U' }, { 0x80, '-' }, { 0x00, ' ' },
+    };
+    static char text[12];
+    uint8_t buf[5];
+    char* p = text;
+    Panel_GetBuffer(buf);
+    for (uint8_t i = 1; i < 5; i++) {
+        uint8_t seg = buf[i] & (uint8_t)~0x02;
+        char ch = '?';
+        for (uint8_t g = 0; g < sizeof(glyphs) / sizeof(glyphs[0]); g++) {
+            if (glyphs[g].seg == seg) { ch = glyphs[g].ch; break; }
+        }
+        if (buf[i] & 0x02) *p++ = '.';
+        *p++ = ch;
+    }
+    *p = 0;
+    return text;
+}
+
+uint8_t Panel_Brightness(void) {
+    return (s_ctrl & 0x08) ? (s_ctrl & 0x07) : 0xFF;
+}
+
+uint32_t Panel_Updates(void) {
+    return s_updates;
+}
+
+void Panel_Glitch(void) {
+    memset(s_ram, 0xFF, sizeof(s_ram));
+}
+
+void Panel_Init(void) {
+    memset(s_ram, 0, sizeof(s_ram));
+    s_addr = s_ctrl = s_keys = 0;
+    s_fixed = false;
+    s_updates = 0;
+    s_selected = s_reading = false;
+    Sim_AddPinListener(panel_pins);
+}
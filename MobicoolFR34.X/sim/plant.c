@@ -0,0 +1,170 @@
+#include "models.h"
+#include "sim.h"
+#include <math.h>
+#include <string.h>
+
+// ── Cooler plant ──────────────────────────────────────────────────────────
+//
+// Lumped single-node cabinet: C dT/dt = UA (Tamb - T) - Qcool.  The
+// compressor's cooling power follows the IRMCF183 speed command and its
+// electrical draw loads the supply through supply_r.  The analog front end
+// is modelled with the scaling analog.c assumes: 10k/10k NTC divider with
+// Beta 2670, 54 mV/count supply, 22 mA/count fan, 20 mA/count compressor.
+
+#define PLANT_STEP      SIM_MS(100)
+#define FAN_MA          150.0
+#define REPLY_DELAY     SIM_MS(2)   // IRMCF183 turnaround after a command
+
+// Control board draw from the supply, compressor and fan aside, mA
+#define BOARD_BASE_MA   0.5     // regulator and op-amp quiescent
+#define PIC_MA_PER_MHZ  0.15    // running
+#define PIC_SLEEP_MA    0.001
+#define PANEL_MA        1.0     // TM1620B logic
+#define PANEL_STEP_MA   2.0     // LEDs, per brightness step
+#define DCDC_MA         8.0     // 12 V converter idling (RC2)
+#define MOTOR_LOGIC_MA  10.0    // IRMCF183 board supply (RC0)
+#define LIGHT_MA        60.0    // interior light (RA1)
+
+plant_t plant;
+
+static sim_event_t s_step_ev;
+static uint8_t s_frame[8];
+static uint8_t s_framelen;
+static uint64_t s_lastbyte;
+static sim_event_t s_reply_ev;
+static uint64_t s_slept;        // Sim_SleepTime() at the last step
+
+static bool pin(uint8_t port, uint8_t bit) {
+    return Sim_GetPin(port, bit);
+}
+
+double Plant_SupplyVoltage(void) {
+    double amps = plant.comp_watts / plant.supply + (pin(SIM_PORTB, 6) ? FAN_MA / 1000.0 : 0);
+    return plant.supply - amps * plant.supply_r;
+}
+
+static uint16_t plant_adc(uint8_t chs) {
+    double v = 0;
+    switch (chs) {
+        case 5: {   // AN5 NTC, 10k pull-up against 10k @ 25 °C
+            double r = 10000.0 * exp(2670.0 * (1.0 / (plant.cabinet + 273.15) - 1.0 / 298.15));
+            v = 1023.0 * r / (r + 10000.0);
+            break;
+        }
+        case 2:     // AN2 supply monitor
+            v = Plant_SupplyVoltage() * 1000.0 / 54.0;
+            break;
+        case 7:     // AN7 fan current
+            v = pin(SIM_PORTB, 6) ? FAN_MA / 22.0 : 0;
+            break;
+        case 8:     // AN8 compressor current
+            v = plant.comp_watts / Plant_SupplyVoltage() * 1000.0 / 20.0;
+            break;
+        case 10:    // AN10 1.8 V reference against 5 V Vdd
+            v = 1023.0 * 1.8 / 5.0;
+            break;
+        default:
+            break;
+    }
+    if (v < 0) v = 0;
+    return (uint16_t)(v + 0.5);
+}
+
+// IRMCF183 command frame: E1 EB 90 <on> <speed> 00 00 <sum>
+static void plant_uart(uint8_t data) {
+    uint64_t now = Sim_Now();
+    if (s_framelen && now - s_lastbyte > SIM_MS(5)) s_framelen = 0;
+    s_lastbyte = now;
+    if (s_framelen == 0 && data != 0xE1) return;
+    s_frame[s_framelen++] = data;
+    if (s_framelen < sizeof(s_frame)) return;
+    s_framelen = 0;
+
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < 7; i++) sum = (uint8_t)(sum + s_frame[i]);
+    if (sum != s_frame[7] || s_frame[1] != 0xEB || s_frame[2] != 0x90) {
+        plant.bad_frames++;
+        return;
+    }
+    plant.frames++;
+    plant.comp_cmd = s_frame[3] != 0;
+    plant.comp_speed = s_frame[4];
+    if (plant.reply != PLANT_REPLY_NONE) Sim_Schedule(&s_reply_ev, now + REPLY_DELAY);
+}
+
+static void plant_reply(sim_event_t* ev) {
+    (void)ev;
+    Sim_UartReceive(plant.reply == PLANT_REPLY_GARBLED ? 0x5A : 0xE1);
+}
+
+static void plant_step(sim_event_t* ev) {
+    uint64_t now = ev->at;
+    double dt = (double)PLANT_STEP / 1e9;
+
+    // The motor drive only runs with its 12 V rail (DCDC enable, RC2) up
+    bool running = plant.comp_cmd && plant.comp_speed && pin(SIM_PORTC, 2);
+    if (running != plant.comp_running) {
+        if (running) {
+            if (plant.starts && (plant.min_off == 0 || now - plant.last_stop < plant.min_off))
+                plant.min_off = now - plant.last_stop;
+            plant.starts++;
+            plant.last_start = now;
+        } else {
+            if (plant.min_on == 0 || now - plant.last_start < plant.min_on)
+                plant.min_on = now - plant.last_start;
+            plant.last_stop = now;
+        }
+        plant.comp_running = running;
+    }
+
+    double qcool = 0;
+    plant.comp_watts = 0;
+    if (running) {
+        qcool = plant.watts_per_speed * plant.comp_speed;
+        double cop = plant.cop;
+        if (plant.cop_peak > 0) {
+            double off = (plant.comp_speed - plant.cop_peak) / plant.cop_peak;
+            cop *= 1.0 - plant.cop_droop * off * off;
+        }
+        plant.comp_watts = qcool / cop;
+        plant.runtime += PLANT_STEP;
+        plant.energy_wh += plant.comp_watts * dt / 3600.0;
+    }
+    plant.cabinet += dt * (plant.ua * (plant.ambient - plant.cabinet) - qcool) / plant.capacity;
+
+    // Board current, the PIC's share weighted by how much of the step it slept
+    double asleep = (double)(Sim_SleepTime() - s_slept) / PLANT_STEP;
+    s_slept = Sim_SleepTime();
+    double ma = BOARD_BASE_MA + (1.0 - asleep) * PIC_MA_PER_MHZ * Sim_ClockHz() / 1e6 +
+                asleep * PIC_SLEEP_MA;
+    uint8_t bright = Panel_Brightness();
+    ma += PANEL_MA + (bright == 0xFF ? 0 : PANEL_STEP_MA * (bright + 1));
+    if (pin(SIM_PORTC, 2)) ma += DCDC_MA;
+    if (pin(SIM_PORTC, 0)) ma += MOTOR_LOGIC_MA;
+    if (pin(SIM_PORTA, 1)) ma += LIGHT_MA;
+    if (pin(SIM_PORTB, 6)) ma += FAN_MA;
+    plant.board_ma = ma;
+    plant.board_mah += ma * dt / 3600.0;
+
+    Sim_Schedule(ev, now + PLANT_STEP);
+}
+
+void Plant_Init(void) {
+    memset(&plant, 0, sizeof(plant));
+    plant.ambient = 25.0;
+    plant.cabinet = 25.0;
+    plant.supply = 12.6;
+    plant.supply_r = 0.05;
+    plant.capacity = 8000.0;
+    plant.ua = 0.4;
+    plant.watts_per_speed = 0.6;
+    plant.cop = 1.3;
+    s_framelen = 0;
+    s_slept = Sim_SleepTime();
+
+    Sim_SetAdcSource(plant_adc);
+    Sim_SetUartSink(plant_uart);
+    s_reply_ev.fn = plant_reply;
+    s_step_ev.fn = plant_step;
+    Sim_Schedule(&s_step_ev, Sim_Now() + PLANT_STEP);
+}
@@ -0,0 +1,1389 @@
+#include "models.h"
+#include "sim.h"
+#include "../settings.h"
+#include "../energy.h"
+#include "../effmap.h"
+#include "../cycles.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// ── Regression scenarios ──────────────────────────────────────────────────
+//
+// Each scenario boots the unmodified firmware on the virtual PIC in a forked
+// child (firmware statics cannot be reset in-process), drives the plant,
+// keypad and ESP32 link from a timed script, and checks the outcome.
+//
+//   fr34sim                 run every scenario
+//   fr34sim -v <name>...    run the named ones, logging plant state per minute
+
+void Firmware_Main(void);
+
+int16_t AnalogGetTemperature10(void);
+uint16_t AnalogGetVoltage(void);
+int16_t Comms_GetTargetTemperature(void);
+uint8_t Comms_GetCompressorPower(void);
+uint8_t Comms_GetMaxPowerLimit(void);
+uint8_t Comms_GetPowerMode(void);
+
+typedef struct {
+    uint32_t at_ms;
+    void (*fn)(void);
+} step_t;
+
+typedef struct {
+    const char* name;
+    uint32_t seconds;
+    void (*setup)(void);
+    const step_t* script;
+    void (*sample)(void);   // every SAMPLE_PERIOD, optional
+    bool (*check)(void);
+} scenario_t;
+
+static bool s_verbose;
+static bool s_ok;
+static const step_t* s_step;
+static sim_event_t s_script_ev;
+static sim_event_t s_sample_ev;
+static sim_event_t s_log_ev;
+static void (*s_sample)(void);
+
+#define SAMPLE_PERIOD   SIM_S(10)
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("    %s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            s_ok = false; \
+        } \
+    } while (0)
+
+#define AT_S(s)     ((uint32_t)((s) * 1000))
+#define END         { 0, NULL }
+
+// ── Script runner ─────────────────────────────────────────────────────────
+static void script_next(sim_event_t* ev) {
+    if (ev) (s_step++)->fn();
+    if (s_step && s_step->fn) Sim_Schedule(&s_script_ev, SIM_MS(s_step->at_ms));
+}
+
+static void sample(sim_event_t* ev) {
+    s_sample();
+    Sim_Schedule(ev, ev->at + SAMPLE_PERIOD);
+}
+
+static void log_minute(sim_event_t* ev) {
+    printf("    %7.1f min  cab %5.2f C  fw %5.1f C  comp %-3s spd %2u  %5.1f W  %5.2f V  fw %5.2f V  [%s]\n",
+           (double)Sim_Now() / 60e9, plant.cabinet, AnalogGetTemperature10() / 10.0,
+           plant.comp_running ? "on" : "off", plant.comp_speed, plant.comp_watts,
+           Plant_SupplyVoltage(), AnalogGetVoltage() / 1000.0, Panel_Text());
+    Sim_Schedule(ev, ev->at + SIM_S(60));
+}
+
+// Presets use the legacy fixed layout, so every scenario that boots from one
+// also runs the migration to the journals
+static void preset_settings(bool on, int8_t setpoint) {
+    sim_eeprom[EE_MAGIC] = EE_LAYOUT_LEGACY;
+    sim_eeprom[EE_ONOFF] = on;
+    sim_eeprom[EE_TEMP] = (uint8_t)setpoint;
+    sim_eeprom[EE_BATTMON] = BMON_LOW;
+}
+
+// ── EEPROM journals, decoded independently of journal.c ───────────────────
+// [base] [slots] [payload size] [journal id]; the settings record is
+// private to settings.c: on, setpoint, battery monitor level
+#define SETTINGS_RING   EE_SETTINGS_BASE, EE_SETTINGS_SLOTS, 3, 0x53
+#define EFFMAP_RING     EE_EFFMAP_BASE, EE_EFFMAP_SLOTS, sizeof(effmap_t), 0x4D
+#define ENERGY_RING     EE_ENERGY_BASE, EE_ENERGY_SLOTS, sizeof(energy_counters_t), 0x45
+
+static uint8_t crc8(uint8_t crc, uint8_t b) {
+    crc ^= b;
+    for (int i = 0; i < 8; i++) crc = (uint8_t)(crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1);
+    return crc;
+}
+
+// Payload of the newest valid record, returns its sequence number or -1
+static int ee_newest(uint8_t base, uint8_t slots, uint8_t size, uint8_t id, uint8_t* out) {
+    int best = -1;
+    for (uint8_t n = 0; n < slots; n++) {
+        const uint8_t* r = &sim_eeprom[base + n * (size + 2)];
+        uint8_t crc = id;
+        for (uint8_t i = 0; i <= size; i++) crc = crc8(crc, r[i]);
+        if (crc != r[size + 1]) continue;
+        if (best < 0 || (uint8_t)(r[0] - best) < 0x80) {
+            best = r[0];
+            memcpy(out, &r[1], size);
+        }
+    }
+    return best;
+}
+
+static bool ee_settings(uint8_t on, int8_t setpoint) {
+    uint8_t rec[3];
+    return sim_eeprom[EE_LAYOUT] == EE_LAYOUT_JOURNAL && ee_newest(SETTINGS_RING, rec) >= 0 &&
+           rec[0] == on && (int8_t)rec[1] == setpoint && rec[2] == 1;
+}
+
+// ── boot: blank EEPROM, splash, first reading ─────────────────────────────
+static void boot_setup(void) {}
+
+static bool boot_check(void) {
+    CHECK(ee_settings(true, 10));       // defaults
+    int16_t t = AnalogGetTemperature10();
+    printf("    reading %d, display \"%s\"\n", t, Panel_Text());
+    CHECK(t >= 245 && t <= 255);        // cabinet at 25.0 °C
+    char expect[12];
+    snprintf(expect, sizeof(expect), "%d.%d.C", t / 10, t % 10);
+    CHECK(strcmp(Panel_Text(), expect) == 0);
+    CHECK(Panel_Brightness() == 4);
+    CHECK(plant.frames >= 1 && plant.bad_frames == 0);
+    CHECK(!plant.comp_running);    // still in the power-up lockout
+    return s_ok;
+}
+
+// ── pulldown: 25 °C cabinet to a 4 °C setpoint, then thermostat cycling ───
+static uint64_t s_reached;
+static double s_low = 100, s_high = -100;
+
+static void pulldown_setup(void) {
+    preset_settings(true, 4);
+    s_reached = 0;
+}
+
+// Within the 1.0 °C restart hysteresis of the setpoint
+#define PULLDOWN_BAND   4.5
+
+static void pulldown_sample(void) {
+    if (!s_reached && plant.cabinet <= PULLDOWN_BAND) s_reached = Sim_Now();
+    if (!s_reached) return;
+    if (plant.cabinet < s_low) s_low = plant.cabinet;
+    if (plant.cabinet > s_high) s_high = plant.cabinet;
+}
+
+static bool pulldown_check(void) {
+    printf("    setpoint reached after %.1f min, held %.2f..%.2f C, %u starts, "
+           "min on %.0f s, min off %.0f s, %.1f Wh\n",
+           (double)s_reached / 60e9, s_low, s_high, plant.starts,
+           (double)plant.min_on / 1e9, (double)plant.min_off / 1e9, plant.energy_wh);
+    CHECK(s_reached && s_reached < SIM_S(120 * 60));
+    CHECK(s_low > 3.5 && s_high < 5.5);
+    CHECK(plant.starts >= 3);
+    CHECK(plant.min_off >= SIM_S(99));     // COMP_LOCKOUT_TIME
+    CHECK(plant.min_on >= SIM_S(30));      // COMP_MIN_RUN_TIME
+    CHECK(plant.bad_frames == 0);
+    return s_ok;
+}
+
+// ── remote: ESP32 GET / SET_TEMP over the bit-level link ──────────────────
+static uint8_t s_resp[LINK_MAX_FRAME];
+static uint8_t s_resplen;
+static bool s_get_ok, s_set_ok, s_badcrc_silent;
+
+static bool v1_response(uint8_t len) {
+    s_resplen = Link_Response(s_resp);
+    if (s_resplen != len + 2 || s_resp[0] != len) return false;
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < s_resplen - 1; i++) crc ^= s_resp[i];
+    return crc == s_resp[s_resplen - 1];
+}
+
+static void remote_get(void) { Link_Request(0x01, NULL, 0); }
+static void remote_get_check(void) {
+    s_get_ok = v1_response(11);
+    int16_t t = (int16_t)(s_resp[1] | s_resp[2] << 8);
+    int16_t sp = (int16_t)(s_resp[3] | s_resp[4] << 8);
+    uint16_t mv = (uint16_t)(s_resp[5] | s_resp[6] << 8);
+    CHECK(s_get_ok);
+    CHECK(t == AnalogGetTemperature10());
+    CHECK(sp == 40);
+    CHECK(mv > 12000 && mv < 13000);
+}
+static void remote_set(void) {
+    int16_t t = -20;
+    uint8_t p[2] = { (uint8_t)t, (uint8_t)((uint16_t)t >> 8) };
+    Link_Request(0x02, p, 2);
+}
+static void remote_set_check(void) {
+    s_set_ok = v1_response(1) && s_resp[1] == 0x06;
+}
+static void remote_badcrc(void) {
+    uint8_t frame[] = { 0xAA, 0x01, 0x00, 0x00 };
+    Link_Send(frame, sizeof(frame));
+}
+static void remote_badcrc_check(void) {
+    s_badcrc_silent = Link_Response(s_resp) == 0;
+}
+
+static const step_t remote_script[] = {
+    { AT_S(25.0), remote_get },
+    { AT_S(25.3), remote_get_check },
+    { AT_S(26.0), remote_set },
+    { AT_S(26.3), remote_set_check },
+    { AT_S(27.0), remote_badcrc },
+    { AT_S(27.3), remote_badcrc_check },
+    END
+};
+
+static void remote_setup(void) { preset_settings(true, 4); }
+
+static bool remote_check(void) {
+    CHECK(s_set_ok);
+    CHECK(s_badcrc_silent);
+    CHECK(Comms_GetTargetTemperature() == -20);
+    CHECK(ee_settings(true, -2));
+    return s_ok;
+}
+
+// ── protocol: v2 frames, TLV SET, retries and errors ──────────────────────
+static uint8_t s_v2_seq;
+static bool s_v2_version, s_v2_set, s_v2_dup, s_v2_rejected, s_v2_unknown, s_v2_long, s_v1_after;
+static bool s_v2_power, s_v2_over, s_v2_range;
+static uint8_t s_v2_first[LINK_MAX_FRAME];
+
+// Checks framing, SEQ echo and FLAGS; true for a well-formed v2 response.
+// The pending-events flag follows the compressor and keypad, not the
+// request, and is left to the events scenario.
+static bool v2_response(uint8_t len, uint8_t flags) {
+    s_resplen = Link_Response(s_resp);
+    return s_resplen == len + 5 && s_resp[0] == 0xA5 && s_resp[1] == s_v2_seq &&
+           (s_resp[2] & ~0x04) == flags && s_resp[3] == len &&
+           Link_Crc8(s_resp, (uint8_t)(s_resplen - 1)) == s_resp[s_resplen - 1];
+}
+
+static int16_t v2_setpoint(void) { return (int16_t)(s_resp[6] | s_resp[7] << 8); }
+
+static void proto_version(void) { Link_RequestV2(++s_v2_seq, 0x09, NULL, 0); }
+static void proto_version_check(void) {
+    s_v2_version = v2_response(3, 0) && s_resp[4] == 2 && s_resp[5] == 32 && s_resp[6] == 32;
+}
+
+// Setpoint -5.0 °C, power cap 80 %, Hi mode in one frame
+static const uint8_t s_tlv_set[] = { 0x02, 2, 0xCE, 0xFF,  0x04, 1, 80,  0x05, 1, 2 };
+static void proto_set(void) { Link_RequestV2(++s_v2_seq, 0x0A, s_tlv_set, sizeof(s_tlv_set)); }
+static void proto_set_check(void) {
+    s_v2_set = v2_response(11, 0) && v2_setpoint() == -50 && s_resp[13] == 80 && s_resp[14] == 2;
+    memcpy(s_v2_first, s_resp, s_resplen);
+}
+// The same SEQ again, as after a lost response
+static void proto_retry(void) { Link_RequestV2(s_v2_seq, 0x0A, s_tlv_set, sizeof(s_tlv_set)); }
+static void proto_retry_check(void) {
+    s_v2_dup = v2_response(11, 0x02) && memcmp(&s_resp[3], &s_v2_first[3], 12) == 0;
+}
+
+// A good setpoint next to a bad power mode: neither is applied
+static void proto_reject(void) {
+    static const uint8_t tlv[] = { 0x02, 2, 0x9C, 0xFF,  0x05, 1, 7 };
+    Link_RequestV2(++s_v2_seq, 0x0A, tlv, sizeof(tlv));
+}
+static void proto_reject_check(void) {
+    s_v2_rejected = v2_response(1, 0x01) && s_resp[4] == 0x15 && Comms_GetTargetTemperature() == -50;
+}
+
+static void proto_unknown(void) { Link_RequestV2(++s_v2_seq, 0x7F, NULL, 0); }
+static void proto_unknown_check(void) { s_v2_unknown = v2_response(1, 0x01) && s_resp[4] == 0x15; }
+
+// A full 32-byte payload: eleven items, the last setpoint wins
+static void proto_long(void) {
+    uint8_t tlv[32];
+    uint8_t n = 0;
+    for (int i = 0; i < 7; i++) { tlv[n++] = 0x04; tlv[n++] = 1; tlv[n++] = 90; }
+    for (int i = 0; i < 2; i++) { tlv[n++] = 0x05; tlv[n++] = 1; tlv[n++] = 1; }
+    tlv[n++] = 0x02; tlv[n++] = 2; tlv[n++] = 0xD8; tlv[n++] = 0xFF;  // -4.0 °C
+    Link_RequestV2(++s_v2_seq, 0x0A, tlv, n);
+}
+static void proto_long_check(void) {
+    s_v2_long = v2_response(11, 0) && v2_setpoint() == -40 && s_resp[13] == 90 && s_resp[14] == 1;
+}
+
+static void proto_v1(void) { Link_Request(0x01, NULL, 0); }
+static void proto_v1_check(void) { s_v1_after = v1_response(11); }
+
+// A power above the cap in force, raised later in the same frame
+static void proto_power(void) {
+    static const uint8_t tlv[] = { 0x03, 1, 95,  0x04, 1, 100 };
+    Link_RequestV2(++s_v2_seq, 0x0A, tlv, sizeof(tlv));
+}
+static void proto_power_check(void) { s_v2_power = v2_response(11, 0) && s_resp[12] == 95 && s_resp[13] == 100; }
+
+// The cap lowered below the power next to it: neither is applied
+static void proto_over(void) {
+    static const uint8_t tlv[] = { 0x03, 1, 60,  0x04, 1, 50 };
+    Link_RequestV2(++s_v2_seq, 0x0A, tlv, sizeof(tlv));
+}
+static void proto_over_check(void) {
+    s_v2_over = v2_response(1, 0x01) && s_resp[4] == 0x15 &&
+                Comms_GetCompressorPower() == 95 && Comms_GetMaxPowerLimit() == 100;
+}
+
+// A setpoint above MAX_TEMP next to a good power mode
+static void proto_range(void) {
+    static const uint8_t tlv[] = { 0x05, 1, 0,  0x02, 2, 0x2C, 0x01 };     // 30.0 °C
+    Link_RequestV2(++s_v2_seq, 0x0A, tlv, sizeof(tlv));
+}
+static void proto_range_check(void) {
+    s_v2_range = v2_response(1, 0x01) && s_resp[4] == 0x15 && Comms_GetPowerMode() == 1;
+}
+
+static const step_t protocol_script[] = {
+    { AT_S(25.0), proto_version }, { AT_S(25.3), proto_version_check },
+    { AT_S(26.0), proto_set },     { AT_S(26.3), proto_set_check },
+    { AT_S(27.0), proto_retry },   { AT_S(27.3), proto_retry_check },
+    { AT_S(28.0), proto_reject },  { AT_S(28.3), proto_reject_check },
+    { AT_S(29.0), proto_unknown }, { AT_S(29.3), proto_unknown_check },
+    { AT_S(30.0), proto_long },    { AT_S(30.3), proto_long_check },
+    { AT_S(31.0), proto_v1 },      { AT_S(31.3), proto_v1_check },
+    { AT_S(32.0), proto_power },   { AT_S(32.3), proto_power_check },
+    { AT_S(33.0), proto_over },    { AT_S(33.3), proto_over_check },
+    { AT_S(34.0), proto_range },   { AT_S(34.3), proto_range_check },
+    END
+};
+
+static bool protocol_check(void) {
+    CHECK(s_v2_version);
+    CHECK(s_v2_set);
+    CHECK(s_v2_dup);
+    CHECK(s_v2_rejected);
+    CHECK(s_v2_unknown);
+    CHECK(s_v2_long);
+    CHECK(s_v1_after);
+    CHECK(s_v2_power && s_v2_over && s_v2_range);
+    CHECK(Comms_GetTargetTemperature() == -40);
+    return s_ok;
+}
+
+// ── baud: step the link up to the fastest profile and fall back ───────────
+// Profiles this build's clock should offer: a bit of 100 cycles or more
+#if _XTAL_FREQ == 32000000
+#define BAUD_EXPECTED   0x0F
+#elif _XTAL_FREQ == 16000000
+#define BAUD_EXPECTED   0x07
+#elif _XTAL_FREQ == 8000000
+#define BAUD_EXPECTED   0x03
+#else
+#define BAUD_EXPECTED   0x01
+#endif
+
+static const uint32_t s_bauds[] = { 9600, 19200, 38400, 57600 };
+static uint8_t s_fastest;
+static bool s_baud_mask, s_baud_ack, s_baud_fast, s_baud_nak, s_baud_back;
+
+static void baud_query(void) { Link_RequestV2(++s_v2_seq, 0x0B, NULL, 0); }
+static void baud_query_check(void) {
+    s_baud_mask = v2_response(1, 0) && s_resp[4] == BAUD_EXPECTED;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (s_resp[4] & (1 << i)) s_fastest = i;
+    }
+}
+static void baud_switch(void) { Link_RequestV2(++s_v2_seq, 0x0B, &s_fastest, 1); }
+static void baud_switch_check(void) {
+    s_baud_ack = v2_response(1, 0) && s_resp[4] == 0x06;
+    Link_SetBaud(s_bauds[s_fastest]);
+}
+static void baud_get(void) { Link_RequestV2(++s_v2_seq, 0x01, NULL, 0); }
+static void baud_get_check(void) { s_baud_fast = v2_response(11, 0) && v2_setpoint() == 40; }
+static void baud_unsupported(void) {
+    uint8_t p = 4;  // past the last profile, 57600
+    Link_RequestV2(++s_v2_seq, 0x0B, &p, 1);
+}
+static void baud_unsupported_check(void) { s_baud_nak = v2_response(1, 0x01) && s_resp[4] == 0x15; }
+// The master gives up on the fast link; the PIC must be back at 9600
+static void baud_drop(void) {
+    Link_SetBaud(9600);
+    Link_RequestV2(++s_v2_seq, 0x01, NULL, 0);
+}
+static void baud_drop_check(void) { s_baud_back = v2_response(11, 0); }
+
+static const step_t baud_script[] = {
+    { AT_S(25.0), baud_query },       { AT_S(25.3), baud_query_check },
+    { AT_S(26.0), baud_switch },      { AT_S(26.3), baud_switch_check },
+    { AT_S(27.0), baud_get },         { AT_S(27.3), baud_get_check },
+    { AT_S(28.0), baud_unsupported }, { AT_S(28.3), baud_unsupported_check },
+    { AT_S(31.5), baud_drop },        { AT_S(31.8), baud_drop_check },
+    END
+};
+
+static bool baud_check(void) {
+    CHECK(s_baud_mask);
+    CHECK(s_baud_ack);
+    CHECK(s_baud_fast);
+    CHECK(s_baud_nak);
+    CHECK(s_baud_back);
+    return s_ok;
+}
+
+// ── delta: GET_DELTA snapshots, deadbands and a lost response ─────────────
+static uint8_t s_delta_ack;
+static bool s_delta_full, s_delta_quiet, s_delta_setp, s_delta_lost, s_delta_reset;
+
+// Checks that the bitmap accounts for exactly the payload that came with it
+static bool delta_response(void) {
+    static const uint8_t size[7] = { 2, 2, 2, 2, 1, 1, 1 };
+    s_resplen = Link_Response(s_resp);
+    if (s_resplen < 7 || s_resp[3] != s_resplen - 5 || s_resp[4] == 0) return false;
+    if (Link_Crc8(s_resp, (uint8_t)(s_resplen - 1)) != s_resp[s_resplen - 1]) return false;
+    uint8_t n = 2;
+    for (int f = 0; f < 7; f++) {
+        if (s_resp[5] & (1 << f)) n += size[f];
+    }
+    return n == s_resp[3];
+}
+
+// Setpoint, when the bitmap carries it
+static bool delta_setpoint(int16_t* sp) {
+    if (!(s_resp[5] & 0x02)) return false;
+    uint8_t at = (s_resp[5] & 0x01) ? 8 : 6;
+    *sp = (int16_t)(s_resp[at] | s_resp[at + 1] << 8);
+    return true;
+}
+
+// First request sets a wide temperature deadband so it cannot fire here
+static void delta_first(void) {
+    uint8_t p[4] = { 0, 50, 5, 2 };
+    Link_RequestV2(++s_v2_seq, 0x0C, p, 4);
+}
+static void delta_first_check(void) {
+    s_delta_full = delta_response() && s_resp[5] == 0x7F;
+    s_delta_ack = s_resp[4];
+}
+static void delta_next(void) { Link_RequestV2(++s_v2_seq, 0x0C, &s_delta_ack, 1); }
+static void delta_quiet_check(void) {
+    s_delta_quiet = delta_response() && (s_resp[5] & ~0x0C) == 0;
+    s_delta_ack = s_resp[4];
+}
+static void delta_setp_check(void) {
+    int16_t sp = 0;
+    s_delta_setp = delta_response() && delta_setpoint(&sp) && sp == -20;
+    // Not acknowledged: the next request still names the snapshot before it
+}
+static void delta_lost_check(void) {
+    int16_t sp = 0;
+    s_delta_lost = delta_response() && delta_setpoint(&sp) && sp == -20;
+}
+static void delta_stranger(void) {
+    uint8_t p = 0x77;
+    Link_RequestV2(++s_v2_seq, 0x0C, &p, 1);
+}
+static void delta_stranger_check(void) { s_delta_reset = delta_response() && s_resp[5] == 0x7F; }
+
+static const step_t delta_script[] = {
+    { AT_S(25.0), delta_first },    { AT_S(25.3), delta_first_check },
+    { AT_S(26.0), delta_next },     { AT_S(26.3), delta_quiet_check },
+    { AT_S(27.0), remote_set },     { AT_S(27.3), remote_set_check },
+    { AT_S(28.0), delta_next },     { AT_S(28.3), delta_setp_check },
+    { AT_S(29.0), delta_next },     { AT_S(29.3), delta_lost_check },
+    { AT_S(30.0), delta_stranger }, { AT_S(30.3), delta_stranger_check },
+    END
+};
+
+static bool delta_check(void) {
+    CHECK(s_delta_full);
+    CHECK(s_delta_quiet);
+    CHECK(s_set_ok);
+    CHECK(s_delta_setp);
+    CHECK(s_delta_lost);
+    CHECK(s_delta_reset);
+    return s_ok;
+}
+
+// ── perf: GET_PERF pages after a minute of normal running ─────────────────
+static uint8_t s_page;
+
+static uint16_t le16(const uint8_t* p) { return (uint16_t)(p[0] | p[1] << 8); }
+
+static void perf_request(void) { Link_Request(0x06, &s_page, 1); }
+
+static void perf_check_loop(void) {
+    CHECK(v1_response(10));
+    printf("    loop: %u tasks, %u probes, busy last %u min %u avg %u max %u us\n",
+           s_resp[1], s_resp[2], le16(&s_resp[3]), le16(&s_resp[5]),
+           le16(&s_resp[7]), le16(&s_resp[9]));
+    CHECK(s_resp[1] == 5 && s_resp[2] == 2);
+    CHECK(le16(&s_resp[5]) <= le16(&s_resp[7]) && le16(&s_resp[7]) <= le16(&s_resp[9]));
+    CHECK(le16(&s_resp[9]) < 10000);    // nothing overran a tick
+    s_page++;
+}
+
+static void perf_check_hist(void) {
+    uint32_t total = 0;
+    CHECK(v1_response(16));
+    printf("    histogram:");
+    for (uint8_t i = 0; i < 8; i++) {
+        printf(" %u", le16(&s_resp[1 + 2 * i]));
+        total += le16(&s_resp[1 + 2 * i]);
+    }
+    printf("\n");
+    CHECK(total > 5000);                // one pass per tick for a minute
+    s_page++;
+}
+
+static void perf_check_task(void) {
+    static const char* names[] = { "comms", "analog", "keys", "control", "display", "panel", "motor" };
+    CHECK(v1_response(9));
+    printf("    %-8s last %5u min %5u avg %5u max %5u us, %u misses\n", names[s_page - 2],
+           le16(&s_resp[1]), le16(&s_resp[3]), le16(&s_resp[5]), le16(&s_resp[7]), s_resp[9]);
+    CHECK(le16(&s_resp[7]) > 0);
+    s_page++;
+}
+
+static void perf_check_nak(void) {
+    CHECK(v1_response(1) && s_resp[1] == 0x15);
+}
+
+#define PERF_PAGE(t, check)  { AT_S(t), perf_request }, { AT_S((t) + 0.3), check }
+static const step_t perf_script[] = {
+    PERF_PAGE(60, perf_check_loop),
+    PERF_PAGE(61, perf_check_hist),
+    PERF_PAGE(62, perf_check_task), PERF_PAGE(63, perf_check_task),
+    PERF_PAGE(64, perf_check_task), PERF_PAGE(65, perf_check_task),
+    PERF_PAGE(66, perf_check_task), PERF_PAGE(67, perf_check_task),
+    PERF_PAGE(68, perf_check_task),
+    PERF_PAGE(69, perf_check_nak),
+    END
+};
+
+static bool perf_check(void) {
+    CHECK(s_page == 9);
+    return s_ok;
+}
+
+// ── energy: counters resume from EEPROM, GET_ENERGY, brown-out checkpoint ─
+static const uint32_t s_preset[4] = { 100, 150, 36000, 40 };
+static uint32_t s_linked[4];
+static bool s_energy_ok, s_checkpointed;
+
+static uint32_t le32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Counters from an earlier run: one record, sequence 1, in the first slot
+static void energy_setup(void) {
+    preset_settings(true, 4);
+    uint8_t* r = &sim_eeprom[EE_ENERGY_BASE];
+    uint8_t crc = crc8(0x45, r[0] = 1);
+    memcpy(&r[1], s_preset, sizeof(s_preset));
+    for (uint8_t i = 1; i <= sizeof(s_preset); i++) crc = crc8(crc, r[i]);
+    r[1 + sizeof(s_preset)] = crc;
+}
+
+static void energy_get(void) { Link_Request(0x07, NULL, 0); }
+static void energy_get_check(void) {
+    s_energy_ok = v1_response(16);
+    for (uint8_t i = 0; i < 4; i++) s_linked[i] = le32(&s_resp[1 + 4 * i]);
+}
+static void energy_brownout(void) { plant.supply = 6.0; }
+static void energy_probe(void) {
+    // After the preset record comes the checkpoint written as the supply
+    // fell, a second or two of run time before the battery monitor cut out
+    uint8_t rec[sizeof(energy_counters_t)];
+    const energy_counters_t* e = Energy_Get();
+    s_checkpointed = ee_newest(ENERGY_RING, rec) == 2 && le32(&rec[12]) == e->starts &&
+                     e->run_seconds - le32(&rec[8]) <= 3;
+}
+
+static const step_t energy_script[] = {
+    { AT_S(1500.0), energy_get },
+    { AT_S(1500.3), energy_get_check },
+    { AT_S(1560.0), energy_brownout },
+    { AT_S(1565.0), energy_probe },
+    END
+};
+
+static bool energy_check(void) {
+    const energy_counters_t* e = Energy_Get();
+    double wh = e->comp_wh - s_preset[0];
+    printf("    metered %.0f Wh compressor, %u Wh total, %u s, %u starts; plant %.1f Wh, %.0f s, %u starts\n",
+           wh, e->total_wh - s_preset[1], e->run_seconds - s_preset[2], e->starts - s_preset[3],
+           plant.energy_wh, (double)plant.runtime / 1e9, plant.starts);
+    CHECK(s_energy_ok);
+    CHECK(s_linked[0] >= s_preset[0] && s_linked[3] == s_preset[3] + 1);
+    CHECK(s_checkpointed);
+    CHECK(e->starts == s_preset[3] + plant.starts);
+    // A firmware second is 100 TMR1 ticks, and the MCC reload loses the
+    // interrupt latency on each one, so the count slips about 1 s in 600
+    CHECK(abs((int)(e->run_seconds - s_preset[2]) - (int)(plant.runtime / 1000000000)) <=
+          2 + (int)(plant.runtime / 600000000000ULL));
+    // AnalogGetCompPower() scales V × I by 1/1024 instead of 1.08/1000
+    CHECK(wh > plant.energy_wh * 0.85 - 1 && wh < plant.energy_wh * 1.05 + 1);
+    CHECK(e->total_wh >= e->comp_wh - s_preset[0] + s_preset[1]);
+    return s_ok;
+}
+
+// ── wear: settled setpoint changes spread over the ring ────────────────────
+static int8_t s_sweep;
+
+// Changes 2.5 s apart, just over the settings quiet period, so each one is saved
+static void wear_set(sim_event_t* ev) {
+    int16_t t = (int16_t)(s_sweep++ % 2 ? -100 : -50);
+    uint8_t p[2] = { (uint8_t)t, (uint8_t)((uint16_t)t >> 8) };
+    Link_Request(0x02, p, 2);
+    if (s_sweep < 60) Sim_Schedule(ev, ev->at + SIM_MS(2500));
+}
+
+static sim_event_t s_wear_ev;
+static void wear_start(void) {
+    s_sweep = 0;
+    s_wear_ev.fn = wear_set;
+    Sim_Schedule(&s_wear_ev, Sim_Now());
+}
+
+static const step_t wear_script[] = {
+    { AT_S(25.0), wear_start },
+    END
+};
+
+static void wear_setup(void) { preset_settings(true, 4); }
+
+static bool wear_check(void) {
+    uint32_t most = 0;
+    for (int a = EE_SETTINGS_BASE; a < EE_EFFMAP_BASE; a++) {
+        if (sim_eeprom_writes[a] > most) most = sim_eeprom_writes[a];
+    }
+    // 60 setpoints and the migration make 61 records over 16 slots
+    printf("    most writes to one settings cell: %u\n", most);
+    CHECK(most <= 4);
+    CHECK(sim_eeprom_writes[EE_TEMP] == 0);    // the legacy setpoint byte
+    CHECK(ee_settings(true, -10));
+    return s_ok;
+}
+
+// ── coalesce: a burst of changes becomes one record after the quiet period ─
+static void coalesce_set(sim_event_t* ev) {
+    int16_t t = (int16_t)(-10 * ++s_sweep);
+    uint8_t p[2] = { (uint8_t)t, (uint8_t)((uint16_t)t >> 8) };
+    Link_Request(0x02, p, 2);
+    if (s_sweep < 18) Sim_Schedule(ev, ev->at + SIM_MS(100));
+}
+
+static void coalesce_start(void) {
+    s_sweep = 0;
+    s_wear_ev.fn = coalesce_set;
+    Sim_Schedule(&s_wear_ev, Sim_Now());
+}
+
+static bool s_pending_ok;
+static void coalesce_pending(void) {
+    uint8_t rec[3];
+    s_pending_ok = ee_newest(SETTINGS_RING, rec) == 1 && (int8_t)rec[1] == 4;
+}
+
+static void coalesce_perf(void) { s_page = 4; perf_request(); }    // keys task
+
+static void coalesce_check_keys(void) {
+    CHECK(v1_response(9));
+    printf("    keys task max %u us\n", le16(&s_resp[7]));
+    CHECK(le16(&s_resp[7]) < 1000);     // never waits on an EEPROM write
+}
+
+static const step_t coalesce_script[] = {
+    { AT_S(25.0), coalesce_start },
+    { AT_S(28.5), coalesce_pending },   // 1.7 s after the last change
+    { AT_S(32.0), coalesce_perf },  { AT_S(32.3), coalesce_check_keys },
+    END
+};
+
+static bool coalesce_check(void) {
+    uint8_t rec[3];
+    CHECK(s_pending_ok);
+    CHECK(ee_newest(SETTINGS_RING, rec) == 2);    // the migration, then one record
+    CHECK(ee_settings(true, -18));
+    return s_ok;
+}
+
+// ── history: five-minute ring over a pull-down, paged out over the link ──
+#define HISTORY_ENTRY   5
+static uint8_t s_hist_page;
+static uint8_t s_hist_newest[HISTORY_ENTRY], s_hist_oldest[HISTORY_ENTRY];
+static bool s_hist_ok, s_hist_end_nak;
+static int16_t s_hist_fw_temp;
+
+static void history_setup(void) { preset_settings(true, -10); }
+
+static void history_get(void) { Link_Request(0x08, &s_hist_page, 1); }
+
+static void history_check_first(void) {
+    s_hist_ok = v1_response(28);
+    printf("    entry %u newest, %u held\n", le16(&s_resp[1]), s_resp[3]);
+    s_hist_ok &= le16(&s_resp[1]) == 59 && s_resp[3] == 48;     // the ring has wrapped
+    memcpy(s_hist_newest, &s_resp[4], HISTORY_ENTRY);
+    s_hist_fw_temp = AnalogGetTemperature10();
+    s_hist_page = 9;
+}
+
+// 48 entries, the last page holds the oldest three
+static void history_check_last(void) {
+    CHECK(v1_response(28));
+    memcpy(s_hist_oldest, &s_resp[4 + 2 * HISTORY_ENTRY], HISTORY_ENTRY);
+    for (int i = 3 * HISTORY_ENTRY; i < 5 * HISTORY_ENTRY; i++) CHECK(s_resp[4 + i] == 0);
+    s_hist_page = 10;
+}
+
+static void history_check_end(void) {
+    s_hist_end_nak = v1_response(1) && s_resp[1] == 0x15;
+}
+
+static const step_t history_script[] = {
+    { AT_S(17995.0), history_get }, { AT_S(17995.3), history_check_first },
+    { AT_S(17996.0), history_get }, { AT_S(17996.3), history_check_last },
+    { AT_S(17997.0), history_get }, { AT_S(17997.3), history_check_end },
+    END
+};
+
+static void history_print(const char* name, const uint8_t* e) {
+    printf("    %s: %5.1f/%5.1f/%5.1f C, %3u%% on, %2u W, %4.1f V\n", name,
+           ((int8_t)e[0] - (e[1] & 15)) / 2.0, (int8_t)e[0] / 2.0, ((int8_t)e[0] + (e[1] >> 4)) / 2.0,
+           e[2], e[3], e[4] / 5.0);
+}
+
+static bool history_check(void) {
+    const uint8_t* n = s_hist_newest;
+    const uint8_t* o = s_hist_oldest;
+    history_print("newest", n);
+    history_print("oldest", o);
+    CHECK(s_hist_ok);
+    CHECK(s_hist_end_nak);
+    CHECK(abs((int8_t)n[0] * 5 - s_hist_fw_temp) <= 10);    // within 1 °C of the live reading
+    CHECK((n[1] & 15) > 0 || (n[1] >> 4) > 0);              // cycling around the setpoint
+    CHECK((int8_t)o[0] > (int8_t)n[0] + 10);                // still pulling down 4 hours ago
+    CHECK((o[1] >> 4) + (o[1] & 15) >= 2);                   // a degree or more in 5 minutes
+    CHECK(o[2] == 100 && o[3] > 10);                        // flat out at the time
+    CHECK(n[4] > 55 && n[4] < 65);                          // 12.6 V supply, less the drop
+    return s_ok;
+}
+
+// ── keypad: SET, three MINUS presses, settle back to idle ─────────────────
+static void key_set(void) { Panel_SetKeys(PANEL_KEY_SET); }
+static void key_minus(void) { Panel_SetKeys(PANEL_KEY_MINUS); }
+static void key_none(void) { Panel_SetKeys(0); }
+
+static char s_settext[12];
+static void keypad_snapshot(void) { strcpy(s_settext, Panel_Text()); }
+
+static const step_t keypad_script[] = {
+    { AT_S(25.0), key_set },   { AT_S(25.3), key_none },
+    { AT_S(26.0), key_minus }, { AT_S(26.3), key_none },
+    { AT_S(27.0), key_minus }, { AT_S(27.3), key_none },
+    { AT_S(28.0), key_minus }, { AT_S(28.3), key_none },
+    { AT_S(28.5), keypad_snapshot },
+    END
+};
+
+static bool keypad_check(void) {
+    printf("    setting display: \"%s\"\n", s_settext);
+    CHECK(strchr(s_settext, '7') != NULL);
+    CHECK(ee_settings(true, 7));
+    CHECK(Comms_GetTargetTemperature() == 70);
+    return s_ok;
+}
+
+// ── repeat: held keys repeat faster and faster, bounces are ignored ───────
+static void key_plus(void) { Panel_SetKeys(PANEL_KEY_PLUS); }
+static void key_onoff(void) { Panel_SetKeys(PANEL_KEY_ONOFF); }
+
+static char s_bouncetext[12], s_heldtext[12], s_mintext[12];
+static bool s_repeat_saved;
+
+static void repeat_bounce(void) { strcpy(s_bouncetext, Panel_Text()); }
+static void repeat_held(void) { strcpy(s_heldtext, Panel_Text()); }
+static void repeat_min(void) { strcpy(s_mintext, Panel_Text()); }
+static void repeat_saved(void) { s_repeat_saved = ee_settings(true, -18); }
+
+static const step_t repeat_script[] = {
+    { AT_S(25.0), key_set },     { AT_S(25.2), key_none },
+    { AT_S(26.0), key_plus },    { AT_S(26.01), key_none },    // contact bounce
+    { AT_S(26.5), repeat_bounce },
+    { AT_S(27.0), key_minus },   { AT_S(29.0), key_none },     // 2 s
+    { AT_S(29.1), repeat_held },
+    { AT_S(30.0), key_minus },   { AT_S(34.0), key_none },     // all the way down
+    { AT_S(34.1), repeat_min },
+    { AT_S(50.0), repeat_saved },
+    { AT_S(55.0), key_onoff },   { AT_S(57.5), key_none },     // long press: off
+    END
+};
+
+static bool repeat_check(void) {
+    int held = 99;
+    sscanf(s_heldtext, "%d", &held);
+    printf("    after a bounce \"%s\", 2 s held \"%s\", then \"%s\"\n",
+           s_bouncetext, s_heldtext, s_mintext);
+    CHECK(strcmp(s_bouncetext, " 10.C") == 0);
+    CHECK(held >= 10 - 14 && held <= 10 - 12);  // press, then 4 at 240, 4 at 120, 60 ms
+    CHECK(strcmp(s_mintext, "-18.C") == 0);
+    CHECK(s_repeat_saved);
+    CHECK(ee_settings(false, -18));
+    return s_ok;
+}
+
+// ── events: keypad activity reaches the companion through the FIFO ────────
+static uint8_t s_events[64];
+static uint8_t s_nevents;
+static bool s_ev_flagged, s_ev_framed, s_ev_lost, s_ev_settled;
+
+static void events_drain(void) { Link_RequestV2(++s_v2_seq, 0x0D, NULL, 0); }
+static void events_collect(void) {
+    s_resplen = Link_Response(s_resp);
+    bool ok = s_resplen >= 7 && s_resp[0] == 0xA5 && s_resp[1] == s_v2_seq && !(s_resp[3] & 1) &&
+              Link_Crc8(s_resp, (uint8_t)(s_resplen - 1)) == s_resp[s_resplen - 1];
+    if (!ok) { s_ev_framed = false; return; }
+    if (s_resp[5]) s_ev_lost = true;
+    for (uint8_t i = 6; i + 1 < s_resplen - 1 && s_nevents + 2 <= sizeof(s_events); i += 2) {
+        s_events[s_nevents++] = s_resp[i];
+        s_events[s_nevents++] = s_resp[i + 1];
+    }
+    // The flag is up exactly while something is left
+    s_ev_settled = (s_resp[4] == 0) == !(s_resp[2] & 0x04);
+}
+static void events_forget(void) { events_collect(); s_nevents = 0; }
+static void events_poll(void) { Link_RequestV2(++s_v2_seq, 0x01, NULL, 0); }
+static void events_poll_check(void) { s_ev_flagged = v2_response(11, 0) && (s_resp[2] & 0x04); }
+
+static const step_t events_script[] = {
+    { AT_S(22.0), events_drain }, { AT_S(22.3), events_forget },   // boot-time compressor states
+    { AT_S(22.5), events_drain }, { AT_S(22.8), events_forget },
+    { AT_S(25.0), key_set },   { AT_S(25.3), key_none },
+    { AT_S(26.0), key_minus }, { AT_S(26.3), key_none },
+    { AT_S(27.0), key_minus }, { AT_S(27.3), key_none },
+    { AT_S(28.0), key_minus }, { AT_S(28.3), key_none },
+    { AT_S(40.0), events_poll },  { AT_S(40.3), events_poll_check },
+    { AT_S(40.5), events_drain }, { AT_S(40.8), events_collect },
+    { AT_S(41.0), events_drain }, { AT_S(41.3), events_collect },
+    END
+};
+
+// Index of the first (type, arg) event at or after pair index from, or -1
+static int find_event(int from, uint8_t type, uint8_t arg) {
+    for (int i = from; i < s_nevents / 2; i++) {
+        if (s_events[2 * i] == type && s_events[2 * i + 1] == arg) return i;
+    }
+    return -1;
+}
+
+static bool events_check(void) {
+    int set = find_event(0, 5, 0x04);
+    int m1 = set < 0 ? -1 : find_event(set + 1, 5, 0x01);
+    int m2 = m1 < 0 ? -1 : find_event(m1 + 1, 5, 0x01);
+    int m3 = m2 < 0 ? -1 : find_event(m2 + 1, 5, 0x01);
+    int sp = m3 < 0 ? -1 : find_event(m3 + 1, 1, 7);
+    printf("    %u events after the boot ones\n", s_nevents / 2);
+    CHECK(s_ev_flagged);
+    CHECK(s_ev_framed);
+    CHECK(!s_ev_lost);
+    CHECK(s_ev_settled);
+    CHECK(sp >= 0);     // SET, three MINUS, then the new setpoint
+    return s_ok;
+}
+
+static void events_setup(void) { s_ev_framed = true; }
+
+// ── battery: supply sags below the cut-out, then recovers ─────────────────
+static bool s_cut, s_led;
+static uint8_t s_leds;
+
+static void batt_sag(void) { plant.supply = 9.0; }
+static void batt_probe(void) {
+    uint8_t buf[5];
+    Panel_GetBuffer(buf);
+    s_leds = buf[0];
+    s_cut = !plant.comp_running;
+    s_led = (buf[0] & 0x40) != 0;
+}
+static void batt_recover(void) { plant.supply = 12.6; }
+
+static const step_t battery_script[] = {
+    { AT_S(300), batt_sag },
+    { AT_S(315), batt_probe },
+    { AT_S(600), batt_recover },
+    END
+};
+
+static bool battery_check(void) {
+    CHECK(s_cut);
+    CHECK(s_led);
+    CHECK(plant.comp_running);
+    CHECK(plant.starts == 2);
+    return s_ok;
+}
+
+// ── motor: change-only IRMCF183 commands, ack timing, silent controller ──
+static uint32_t s_frames_at[2];
+static uint16_t s_ack_avg, s_ack_missed;
+static bool s_motor_quiet;
+
+static void motor_count(void) { s_frames_at[s_frames_at[0] ? 1 : 0] = plant.frames; }
+static void motor_perf(void) { s_page = 8; perf_request(); }
+static void motor_perf_check(void) {
+    if (!v1_response(9)) return;
+    s_ack_avg = le16(&s_resp[5]);
+    s_ack_missed = s_resp[9];
+}
+static void motor_silent(void) { plant.reply = PLANT_REPLY_NONE; }
+static void motor_back(void) { plant.reply = PLANT_REPLY_ACK; }
+static void motor_quiet_check(void) {
+    // Nothing queued while the controller answers
+    s_motor_quiet = v2_response(11, 0) && !(s_resp[2] & 0x04);
+}
+
+static const step_t motor_script[] = {
+    { AT_S(30.0), motor_count },
+    { AT_S(90.0), motor_count },
+    { AT_S(91.0), motor_perf },   { AT_S(91.3), motor_perf_check },
+    { AT_S(91.5), events_drain }, { AT_S(91.8), events_forget },   // compressor start-up
+    { AT_S(92.0), events_poll },  { AT_S(92.3), motor_quiet_check },
+    { AT_S(95.0), motor_silent },
+    { AT_S(125.0), motor_back },
+    { AT_S(140.0), events_drain }, { AT_S(140.3), events_collect },
+    END
+};
+
+static bool motor_check(void) {
+    uint32_t steady = s_frames_at[1] - s_frames_at[0];
+    int silent = find_event(0, 6, 1);
+    int back = silent < 0 ? -1 : find_event(silent + 1, 6, 0);
+    printf("    %u frames in 60 s of running, ack avg %u us, %u missed\n",
+           steady, s_ack_avg, s_ack_missed);
+    CHECK(plant.comp_running);
+    CHECK(steady >= 60 / 10 && steady < 20);    // keepalives and speed steps, not one a second
+    CHECK(s_ack_avg > 8000 && s_ack_avg < 15000);   // 8 bytes out, 2 ms turnaround, 1 byte back
+    CHECK(s_ack_missed == 0);
+    CHECK(s_motor_quiet);
+    CHECK(silent >= 0 && back >= 0);
+    CHECK(plant.bad_frames == 0);
+    return s_ok;
+}
+
+// ── softstart: a weak supply that full speed would pull below the cut-out ─
+// 11.0 V behind 0.5 ohm sags to ~9.4 V at full speed, under the 9.6 V trip
+// of the low battery level; the ramp has to hold the speed down instead.
+static sim_event_t s_soft_ev;
+static uint8_t s_soft_first, s_soft_top, s_soft_jumps;
+static double s_soft_vmin = 100;
+
+static int speed_index(uint8_t speed) {
+    static const uint8_t speeds[] = { 3, 6, 9, 17, 19, 22, 25, 33, 35, 38, 41,
+                                      49, 51, 54, 57, 65, 67, 70, 73, 81, 83 };
+    for (int i = 0; i < (int)sizeof(speeds); i++) if (speeds[i] == speed) return i;
+    return -1;
+}
+
+static void soft_sample(sim_event_t* ev) {
+    static uint8_t last;
+    if (plant.comp_running) {
+        if (!s_soft_first) s_soft_first = plant.comp_speed;
+        if (plant.comp_speed > s_soft_top) s_soft_top = plant.comp_speed;
+        if (last && speed_index(plant.comp_speed) > speed_index(last) + 1) s_soft_jumps++;
+        last = plant.comp_speed;
+        double v = Plant_SupplyVoltage();
+        if (v < s_soft_vmin) s_soft_vmin = v;
+    }
+    Sim_Schedule(ev, ev->at + SIM_S(1));
+}
+
+static void softstart_setup(void) {
+    plant.supply = 11.0;
+    plant.supply_r = 0.5;
+    s_soft_ev.fn = soft_sample;
+    Sim_Schedule(&s_soft_ev, SIM_S(1));
+}
+
+static bool softstart_check(void) {
+    printf("    first speed %u, top %u, supply down to %.2f V\n", s_soft_first, s_soft_top, s_soft_vmin);
+    CHECK(s_soft_first == 33);          // minimum speed, not the default 41
+    CHECK(s_soft_jumps == 0);
+    CHECK(s_soft_vmin > 9.6);
+    CHECK(plant.starts == 1 && plant.comp_running);
+    return s_ok;
+}
+
+// ── panel: only changed display addresses go out, lost RAM comes back ──
+static uint32_t s_panel_writes[2];
+static char s_panel_glitched[12], s_panel_restored[12];
+
+static void panel_count(void) { s_panel_writes[s_panel_writes[0] ? 1 : 0] = Panel_Updates(); }
+static void panel_glitch(void) { Panel_Glitch(); }
+static void panel_glitched(void) { strcpy(s_panel_glitched, Panel_Text()); }
+static void panel_restored(void) { strcpy(s_panel_restored, Panel_Text()); }
+
+static const step_t panel_script[] = {
+    { AT_S(60.0), panel_count },
+    { AT_S(120.0), panel_count },
+    { AT_S(130.0), panel_glitch },
+    { AT_S(130.05), panel_glitched },
+    { AT_S(141.0), panel_restored },
+    END
+};
+
+static bool panel_check(void) {
+    uint32_t writes = s_panel_writes[1] - s_panel_writes[0];
+    printf("    %u display writes in 60 s, \"%s\" after a glitch, then \"%s\"\n",
+           writes, s_panel_glitched, s_panel_restored);
+    CHECK(writes < 60 * 10 * 10 / 10);   // a tenth of rewriting every frame
+    CHECK(strcmp(s_panel_glitched, ".8.8.8.8") == 0);  // every segment lit
+    CHECK(strchr(s_panel_restored, '8') == NULL && strchr(s_panel_restored, 'C') != NULL);
+    return s_ok;
+}
+
+// ── sag: a long cable that pulls the running supply under the cut-out ───
+// 11.0 V behind 1 ohm reads ~9.5 V with the compressor at minimum speed,
+// under the 9.6 V trip of the low battery level.  The battery itself is
+// fine, so once the step at start-up has shown the cable resistance the
+// compressor has to keep running.
+static sim_event_t s_sag_ev;
+static double s_sag_vmin = 100;
+
+static void sag_sample(sim_event_t* ev) {
+    double v = Plant_SupplyVoltage();
+    if (plant.comp_running && v < s_sag_vmin) s_sag_vmin = v;
+    Sim_Schedule(ev, ev->at + SIM_S(1));
+}
+
+static const step_t sag_script[] = {
+    { AT_S(60.0), events_drain },  { AT_S(60.3), events_collect },
+    { AT_S(300.0), events_drain }, { AT_S(300.3), events_collect },
+    END
+};
+
+static void sag_setup(void) {
+    s_ev_framed = true;
+    plant.supply = 11.0;
+    plant.supply_r = 1.0;
+    s_sag_ev.fn = sag_sample;
+    Sim_Schedule(&s_sag_ev, SIM_S(1));
+}
+
+static bool sag_check(void) {
+    int r = -1;
+    for (int i = 0; i < s_nevents / 2; i++) {
+        if (s_events[2 * i] == 7) r = s_events[2 * i + 1];
+    }
+    printf("    supply down to %.2f V, resistance estimate %d0 mohm\n", s_sag_vmin, r);
+    CHECK(s_ev_framed);
+    CHECK(s_sag_vmin < 9.6);                // the old monitor would have tripped
+    CHECK(r >= 85 && r <= 115);
+    CHECK(find_event(0, 3, 1) < 0);
+    CHECK(plant.starts == 1 && plant.comp_running);
+    return s_ok;
+}
+
+// ── effmap: service sweep on a compressor with a COP sweet spot ──────────
+// The plant's COP peaks at speed 51 (index 12) and drops off either side,
+// so the map has to peak there and the controller has to lean towards it.
+static uint8_t s_effmap[16];
+static bool s_eff_started, s_eff_running, s_eff_done;
+
+static void effmap_op(uint8_t op) { Link_Request(0x0E, &op, 1); }
+static void effmap_start(void) { effmap_op(1); }
+static void effmap_start_check(void) { s_eff_started = v1_response(1) && s_resp[1] == 0x06; }
+static void effmap_status(void) { effmap_op(0); }
+static void effmap_running_check(void) {
+    // 14 speeds up then down, three minutes each: five done by now
+    s_eff_running = v1_response(5) && s_resp[1] == 1 && s_resp[2] == 5 && s_resp[3] == 28 &&
+                    s_resp[4] == 12;
+}
+static void effmap_done_check(void) { s_eff_done = v1_response(5) && s_resp[1] == 0 && s_resp[5] == 14; }
+static void effmap_read(void) { effmap_op(3); }
+static void effmap_read_check(void) {
+    if (v1_response(16)) memcpy(s_effmap, &s_resp[1], 16);
+}
+
+static const step_t effmap_script[] = {
+    { AT_S(23.0), effmap_start },   { AT_S(23.3), effmap_start_check },
+    { AT_S(1000), effmap_status },  { AT_S(1000.3), effmap_running_check },
+    { AT_S(5200), effmap_status },  { AT_S(5200.3), effmap_done_check },
+    { AT_S(5201), effmap_read },    { AT_S(5201.3), effmap_read_check },
+    END
+};
+
+static void effmap_setup(void) {
+    preset_settings(true, -2);
+    plant.cop_peak = 51;
+    plant.cop_droop = 2.0;
+}
+
+static bool effmap_check(void) {
+    uint8_t rec[sizeof(effmap_t)];
+    int peak = 0;
+    printf("    map from index %u:", s_effmap[0]);
+    for (int i = 0; i < s_effmap[1] && i < 14; i++) {
+        printf(" %u", s_effmap[2 + i]);
+        if (s_effmap[2 + i] > s_effmap[2 + peak]) peak = i;
+    }
+    printf("\n");
+    CHECK(s_eff_started);
+    CHECK(s_eff_running);
+    CHECK(s_eff_done);
+    CHECK(s_effmap[0] == 7 && s_effmap[1] == 14);
+    CHECK(peak + 7 >= 11 && peak + 7 <= 13);
+    CHECK(s_effmap[2] < s_effmap[2 + peak] && s_effmap[15] < s_effmap[2 + peak]);
+    CHECK(ee_newest(EFFMAP_RING, rec) >= 0 && memcmp(rec, s_effmap, sizeof(effmap_t)) == 0);
+    CHECK(EffMap_Prefer(10, 18) > 10);  // leans towards the sweet spot
+    CHECK(EffMap_Prefer(peak + 7, 18) == peak + 7);
+    CHECK(EffMap_Prefer(10, 10) == 10); // but not past the limit
+    return s_ok;
+}
+
+// ── standby: switched off, the board sleeps but still answers and wakes ──
+// Current is compared between 15 s awake with the "oFF" display lit and
+// most of the following hour in standby; the cabinet is swapped for a colder one late
+// on, which a GET has to report without ending standby.
+static double s_sb_mah, s_sb_awake_ma, s_sb_ma, s_sb_slept, s_sb_after_get;
+static uint64_t s_sb_sleep0;
+static int16_t s_sb_temp;
+static bool s_sb_get_ok;
+static uint8_t s_sb_bright;
+
+static void sb_mark(void) { s_sb_mah = plant.board_mah; }
+static void sb_awake(void) { s_sb_awake_ma = (plant.board_mah - s_sb_mah) * 3600.0 / 15.0; }
+static void sb_standby(void) {
+    s_sb_mah = plant.board_mah;
+    s_sb_sleep0 = Sim_SleepTime();
+}
+static void sb_asleep(void) {
+    s_sb_ma = (plant.board_mah - s_sb_mah) * 3600.0 / 3400.0;
+    s_sb_slept = (double)(Sim_SleepTime() - s_sb_sleep0) / SIM_S(3400);
+}
+static void sb_cold(void) { plant.cabinet = 8.0; }
+static void sb_get(void) { Link_Request(0x01, NULL, 0); }
+static void sb_get_check(void) {
+    s_sb_get_ok = v1_response(11);
+    s_sb_temp = (int16_t)(s_resp[1] | s_resp[2] << 8);
+    s_sb_sleep0 = Sim_SleepTime();
+}
+static void sb_after_get(void) { s_sb_after_get = (double)(Sim_SleepTime() - s_sb_sleep0) / SIM_S(4); }
+static void sb_bright(void) { s_sb_bright = Panel_Brightness(); }
+
+static const step_t standby_script[] = {
+    { AT_S(3.0), sb_mark },     { AT_S(18.0), sb_awake },     // dims at 20 s
+    { AT_S(63.0), sb_standby },
+    { AT_S(3463), sb_asleep },
+    { AT_S(3470), sb_cold },
+    { AT_S(3500), sb_get },     { AT_S(3500.3), sb_get_check },
+    { AT_S(3504.3), sb_after_get },
+    { AT_S(3505), key_set },    { AT_S(3505.5), key_none },
+    { AT_S(3506), sb_bright },
+    END
+};
+
+static void standby_setup(void) { preset_settings(false, 4); }
+
+static bool standby_check(void) {
+    printf("    awake %.2f mA, standby %.3f mA, asleep %.1f%% (%.1f%% after a GET), GET %d, "
+           "brightness %u\n", s_sb_awake_ma, s_sb_ma, s_sb_slept * 100.0,
+           s_sb_after_get * 100.0, s_sb_temp, s_sb_bright);
+    CHECK(s_sb_ma < s_sb_awake_ma / 2);
+    CHECK(s_sb_slept > 0.95);
+    CHECK(s_sb_after_get > 0.9);
+    CHECK(s_sb_get_ok);
+    CHECK(s_sb_temp >= 70 && s_sb_temp <= 90);  // within two samples of the swap
+    CHECK(s_sb_bright != 0xFF);
+    CHECK(!plant.comp_running && plant.starts == 0);
+    return s_ok;
+}
+
+// ── warm: brown-outs while the compressor runs ────────────────────────────
+// The IRMCF183 shares the supply, so it drops its command as well.  The
+// first three restart the run after the start delay, from the soft start's
+// first step; a fourth within two minutes of the last gets the cold start's
+// splash and lockout.
+static char s_wm_splash[12], s_wm_text[12], s_wm_cold_text[12];
+static int s_wm_resumes, s_wm_held;
+static uint8_t s_wm_speed;
+static bool s_wm_cold_running, s_wm_cold_restarted;
+
+static void wm_splash(void) { strcpy(s_wm_splash, Panel_Text()); }
+static void wm_brownout(void) {
+    plant.comp_cmd = false;
+    Sim_BrownOut();
+}
+static void wm_held(void) {
+    if (!plant.comp_running) s_wm_held++;
+}
+static void wm_resumed(void) {
+    if (plant.comp_cmd && plant.comp_running) s_wm_resumes++;
+    if (plant.comp_speed > s_wm_speed) s_wm_speed = plant.comp_speed;
+}
+static void wm_text(void) { strcpy(s_wm_text, Panel_Text()); }
+static void wm_cold(void) {
+    strcpy(s_wm_cold_text, Panel_Text());
+    s_wm_cold_running = plant.comp_running;
+}
+static void wm_cold_restart(void) { s_wm_cold_restarted = plant.comp_running; }
+
+static const step_t warm_script[] = {
+    { AT_S(1.0), wm_splash },
+    { AT_S(300), wm_brownout }, { AT_S(301), wm_held }, { AT_S(303.5), wm_resumed }, { AT_S(304), wm_text },
+    { AT_S(320), wm_brownout }, { AT_S(321), wm_held }, { AT_S(323.5), wm_resumed },
+    { AT_S(340), wm_brownout }, { AT_S(341), wm_held }, { AT_S(343.5), wm_resumed },
+    { AT_S(360), wm_brownout }, { AT_S(361), wm_cold },
+    { AT_S(400), wm_cold_restart },
+    END
+};
+
+static void warm_setup(void) { preset_settings(true, 4); }
+
+static bool warm_check(void) {
+    printf("    %d of 3 brown-outs held off 1 s, %d resumed within 3.5 s at speed %u or less, "
+           "showing \"%s\"; 4th: \"%s\", %s\n", s_wm_held, s_wm_resumes, s_wm_speed,
+           s_wm_text, s_wm_cold_text, s_wm_cold_running ? "running" : "stopped");
+    CHECK(s_wm_held == 3 && s_wm_resumes == 3);
+    CHECK(s_wm_speed == 33);                            // the soft start's first step
+    CHECK(strcmp(s_wm_text, s_wm_splash) != 0);         // no splash on a warm restart
+    CHECK(strcmp(s_wm_cold_text, s_wm_splash) == 0);
+    CHECK(!s_wm_cold_running && s_wm_cold_restarted);   // lockout, then cooling again
+    CHECK(plant.bad_frames == 0);
+    return s_ok;
+}
+
+// ── cycles: hot day, light load; the restart offset widens to cut the starts ─
+#define CYC_HOURS   6
+#define CYC_SETTLED 2                                   // hours checked at the end
+static uint32_t s_cyc_starts[CYC_HOURS + 1];    // plant.starts at each hour
+static uint8_t s_cyc[12];
+static bool s_cyc_ok;
+static double s_cyc_high, s_cyc_low = 99.0;
+
+static void cycles_setup(void) {
+    preset_settings(true, 4);
+    plant.ambient = 40.0;
+    plant.capacity = 2500.0;            // nearly empty cabinet
+    plant.cabinet = 5.0;
+}
+
+static void cycles_sample(void) {
+    uint64_t now = Sim_Now();
+    if (now % SIM_S(3600) < SAMPLE_PERIOD) s_cyc_starts[now / SIM_S(3600)] = plant.starts;
+    if (now < SIM_S(1800)) return;
+    if (plant.cabinet > s_cyc_high) s_cyc_high = plant.cabinet;
+    if (plant.cabinet < s_cyc_low) s_cyc_low = plant.cabinet;
+}
+
+static void cycles_get(void) { Link_Request(0x0F, NULL, 0); }
+static void cycles_get_check(void) {
+    s_cyc_ok = v1_response(12);
+    memcpy(s_cyc, &s_resp[1], sizeof(s_cyc));
+}
+
+static const step_t cycles_script[] = {
+    { AT_S(CYC_HOURS * 3600 - 10.0), cycles_get },
+    { AT_S(CYC_HOURS * 3600 - 9.7), cycles_get_check },
+    END
+};
+
+static bool cycles_check(void) {
+    s_cyc_starts[CYC_HOURS] = plant.starts;
+    uint32_t first = s_cyc_starts[1] - s_cyc_starts[0];
+    uint32_t settled = s_cyc_starts[CYC_HOURS] - s_cyc_starts[CYC_HOURS - CYC_SETTLED];
+    uint32_t period = le16(&s_cyc[0]) + le16(&s_cyc[2]);
+    printf("    starts per hour");
+    for (int h = 0; h < CYC_HOURS; h++) printf(" %u", s_cyc_starts[h + 1] - s_cyc_starts[h]);
+    printf(", last %u s on / %u s off, %u/h, offset %u.%u C, trim %u, under %u.%u C\n",
+           le16(&s_cyc[0]), le16(&s_cyc[2]), s_cyc[7], s_cyc[9] / 10, s_cyc[9] % 10, s_cyc[10],
+           s_cyc[11] / 10, s_cyc[11] % 10);
+    printf("    cabinet %.2f..%.2f C after the first half hour\n", s_cyc_low, s_cyc_high);
+    CHECK(s_cyc_ok);
+    CHECK(s_cyc[8] == CYCLES_TARGET_PER_H);
+    CHECK(s_cyc[9] == 15 && s_cyc[10] > 0);     // widest NORMAL offset, then slower runs
+    CHECK(first > CYCLES_TARGET_PER_H + 1);
+    // Settled: the last hours within 25 % of the target, the last cycle in the band
+    CHECK(4 * settled >= 3 * CYC_SETTLED * CYCLES_TARGET_PER_H &&
+          4 * settled <= 5 * CYC_SETTLED * CYCLES_TARGET_PER_H);
+    CHECK(period >= CYCLES_TARGET_S - CYCLES_SLACK_S && period <= CYCLES_TARGET_S + CYCLES_SLACK_S);
+    CHECK(le16(&s_cyc[0]) >= 30 && le16(&s_cyc[2]) >= 99);
+    CHECK(s_cyc_high < 4.0 + 1.5 + 0.3);        // inside the comfort bounds
+    CHECK(s_cyc_low > 4.0 - 0.5 - 0.3);
+    CHECK(plant.bad_frames == 0);
+    return s_ok;
+}
+
+static const scenario_t s_scenarios[] = {
+    { "boot",     10,       boot_setup,     NULL,           NULL,            boot_check },
+    { "pulldown", 4 * 3600, pulldown_setup, NULL,           pulldown_sample, pulldown_check },
+    { "remote",   30,       remote_setup,   remote_script,  NULL,            remote_check },
+    { "protocol", 36,       remote_setup,   protocol_script, NULL,           protocol_check },
+    { "baud",     35,       remote_setup,   baud_script,    NULL,            baud_check },
+    { "delta",    35,       remote_setup,   delta_script,   NULL,            delta_check },
+    { "perf",     72,       boot_setup,     perf_script,    NULL,            perf_check },
+    { "energy",   1600,     energy_setup,   energy_script,  NULL,            energy_check },
+    { "wear",     180,      wear_setup,     wear_script,    NULL,            wear_check },
+    { "coalesce", 35,       wear_setup,     coalesce_script, NULL,           coalesce_check },
+    { "history",  18000,    history_setup,  history_script, NULL,            history_check },
+    { "keypad",   40,       boot_setup,     keypad_script,  NULL,            keypad_check },
+    { "repeat",   65,       boot_setup,     repeat_script,  NULL,            repeat_check },
+    { "events",   45,       events_setup,   events_script,  NULL,            events_check },
+    { "battery",  20 * 60,  boot_setup,     battery_script, NULL,            battery_check },
+    { "motor",    150,      events_setup,   motor_script,   NULL,            motor_check },
+    { "softstart", 15 * 60, softstart_setup, NULL,          NULL,            softstart_check },
+    { "panel",    150,      boot_setup,     panel_script,   NULL,            panel_check },
+    { "sag",      10 * 60,  sag_setup,      sag_script,     NULL,            sag_check },
+    { "effmap",   5210,     effmap_setup,   effmap_script,  NULL,            effmap_check },
+    { "standby",  3510,     standby_setup,  standby_script, NULL,            standby_check },
+    { "warm",     410,      warm_setup,     warm_script,    NULL,            warm_check },
+    { "cycles",   CYC_HOURS * 3600, cycles_setup,   cycles_script,  cycles_sample,   cycles_check },
+};
+#define NUM_SCENARIOS (sizeof(s_scenarios) / sizeof(s_scenarios[0]))
+
+// ── Runner ────────────────────────────────────────────────────────────────
+static int run_child(const scenario_t* sc) {
+    s_ok = true;
+    Sim_Init();
+    Plant_Init();
+    Panel_Init();
+    Link_Init();
+    sc->setup();
+
+    s_script_ev.fn = script_next;
+    s_step = sc->script;
+    script_next(NULL);
+    if (sc->sample) {
+        s_sample = sc->sample;
+        s_sample_ev.fn = sample;
+        Sim_Schedule(&s_sample_ev, SAMPLE_PERIOD);
+    }
+    if (s_verbose) {
+        s_log_ev.fn = log_minute;
+        Sim_Schedule(&s_log_ev, SIM_S(60));
+    }
+
+    clock_t t0 = clock();
+    Sim_Run(Firmware_Main, SIM_S(sc->seconds));
+    double host = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    printf("    %u s simulated in %.2f s host time, %llu firmware cycles\n",
+           sc->seconds, host, (unsigned long long)Sim_Cycles());
+    return sc->check() ? 0 : 1;
+}
+
+static bool run(const scenario_t* sc) {
+    printf("%-10s\n", sc->name);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        int rc = run_child(sc);
+        fflush(stdout);
+        _exit(rc);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    printf("%-10s %s\n", sc->name, ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int failed = 0, ran = 0;
+    int first = 1;
+    if (argc > 1 && strcmp(argv[1], "-v") == 0) {
+        s_verbose = true;
+        first = 2;
+    }
+    for (size_t i = 0; i < NUM_SCENARIOS; i++) {
+        bool wanted = first >= argc;
+        for (int a = first; a < argc; a++) {
+            if (strcmp(argv[a], s_scenarios[i].name) == 0) wanted = true;
+        }
+        if (!wanted) continue;
+        ran++;
+        if (!run(&s_scenarios[i])) failed++;
+    }
+    printf("%d of %d scenarios passed\n", ran - failed, ran);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,814 @@
+#include "xc.h"
+#include "sim.h"
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void INTERRUPT_InterruptManager(void);
+
+#define R(name)     s_reg[SFR_##name]
+#define B(name)     (*(name##bits_t*)&s_reg[SFR_##name])
+
+#define MAX_EVENTS      16
+#define MAX_LISTENERS   4
+#define NEVER           UINT64_MAX
+
+uint8_t sim_eeprom[SIM_EEPROM_SIZE];
+uint16_t sim_flash[SIM_FLASH_WORDS];
+uint32_t sim_eeprom_writes[SIM_EEPROM_SIZE];
+
+// ── Core state ────────────────────────────────────────────────────────────
+static uint8_t s_reg[SIM_NUM_SFRS];
+static uint64_t s_now;              // ns
+static uint64_t s_next;             // earliest armed event
+static uint64_t s_end;
+static uint64_t s_cycles;
+static uint32_t s_cyc_ns;           // one instruction cycle (4 Tosc)
+static bool s_in_isr;
+static bool s_sleeping;
+static jmp_buf* s_exit;
+#define JUMP_END    1               // s_exit values: the run is over
+#define JUMP_RESET  2               // the PIC was reset, see Sim_BrownOut()
+
+static int s_pending = -1;          // register handed out by the last access
+static uint8_t s_before;            // its value at that time
+
+static sim_event_t* s_events[MAX_EVENTS];
+static uint8_t s_numevents;
+
+static sim_pin_listener_t s_listeners[MAX_LISTENERS];
+static uint8_t s_numlisteners;
+static uint8_t s_ext[SIM_NUM_PORTS];
+static uint8_t s_level[SIM_NUM_PORTS];
+
+static sim_adc_source_t s_adc_source;
+static sim_uart_sink_t s_uart_sink;
+
+static void sim_commit(void);
+
+void Sim_Fail(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "sim: %.3f s: ", (double)s_now / 1e9);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    exit(2);
+}
+
+// ── Events ────────────────────────────────────────────────────────────────
+static void sim_find_next(void) {
+    s_next = s_end;
+    for (uint8_t i = 0; i < s_numevents; i++) {
+        if (s_events[i]->armed && s_events[i]->at < s_next) s_next = s_events[i]->at;
+    }
+}
+
+void Sim_Schedule(sim_event_t* ev, uint64_t at) {
+    bool later = ev->armed && at > ev->at && ev->at == s_next;
+    if (!ev->armed) {
+        uint8_t i;
+        for (i = 0; i < s_numevents && s_events[i] != ev; i++);
+        if (i == s_numevents) {
+            if (s_numevents == MAX_EVENTS) Sim_Fail("too many events");
+            s_events[s_numevents++] = ev;
+        }
+    }
+    ev->at = at;
+    ev->armed = true;
+    if (later) sim_find_next();
+    else if (at < s_next) s_next = at;
+}
+
+void Sim_Cancel(sim_event_t* ev) {
+    if (!ev->armed) return;
+    ev->armed = false;
+    sim_find_next();
+}
+
+static void sim_run_events(void) {
+    while (s_next <= s_now) {
+        if (s_next >= s_end && s_exit) longjmp(*s_exit, JUMP_END);
+        sim_event_t* ev = NULL;
+        for (uint8_t i = 0; i < s_numevents; i++) {
+            if (s_events[i]->armed && (!ev || s_events[i]->at < ev->at)) ev = s_events[i];
+        }
+        ev->armed = false;
+        ev->fn(ev);
+        sim_find_next();
+    }
+}
+
+// ── Clock ─────────────────────────────────────────────────────────────────
+static void sim_update_clock(void) {
+    // INTOSC only; IRCF selects the HF/MF/LF tap
+    static const uint32_t ircf_hz[16] = {
+        31000, 31000, 31250, 31250, 62500, 125000, 250000, 500000,
+        125000, 250000, 500000, 1000000, 2000000, 4000000, 8000000, 16000000
+    };
+    uint32_t hz = ircf_hz[B(OSCCON).IRCF];
+    if (B(OSCCON).IRCF == 14 && B(OSCCON).SPLLEN) hz = 32000000;
+    s_cyc_ns = (uint32_t)(4000000000ULL / hz);
+}
+
+// ── Interrupts ────────────────────────────────────────────────────────────
+static void sim_update_iocif(void) {
+    B(INTCON).IOCIF = (R(IOCAF) | R(IOCBF)) ? 1 : 0;
+}
+
+static bool sim_irq_flagged(void) {
+    uint8_t intcon = R(INTCON);
+    if ((intcon & 0x20) && (intcon & 0x04)) return true;    // TMR0
+    if ((intcon & 0x08) && (intcon & 0x01)) return true;    // IOC
+    if (intcon & 0x40) {                                    // PEIE
+        if (R(PIE1) & R(PIR1)) return true;
+        if (R(PIE2) & R(PIR2)) return true;
+    }
+    return false;
+}
+
+static void sim_interrupt(void) {
+    s_in_isr = true;
+    B(INTCON).GIE = 0;
+    s_now += 3 * (uint64_t)s_cyc_ns;    // vectoring + context save
+    INTERRUPT_InterruptManager();
+    sim_commit();
+    s_pending = -1;
+    B(INTCON).GIE = 1;                  // RETFIE
+    s_now += 2 * (uint64_t)s_cyc_ns;
+    s_in_isr = false;
+}
+
+static void sim_service(void) {
+    if (s_next <= s_now) sim_run_events();
+    while (!s_in_isr && B(INTCON).GIE && sim_irq_flagged()) {
+        sim_interrupt();
+        if (s_next <= s_now) sim_run_events();
+    }
+}
+
+// ── TMR0 ──────────────────────────────────────────────────────────────────
+static sim_event_t s_tmr0_ev;
+static uint64_t s_tmr0_base;
+
+static uint64_t tmr0_tick(void) {
+    if (B(OPTION_REG).TMR0CS) return 0;     // T0CKI is not wired
+    uint32_t ps = B(OPTION_REG).PSA ? 1 : (2u << B(OPTION_REG).PS);
+    return (uint64_t)s_cyc_ns * ps;
+}
+
+static void tmr0_sync(uint64_t t) {
+    uint64_t tick = tmr0_tick();
+    if (t <= s_tmr0_base) return;
+    if (!tick || s_sleeping) { s_tmr0_base = t; return; }
+    uint64_t n = (t - s_tmr0_base) / tick;
+    if (!n) return;
+    s_tmr0_base += n * tick;
+    uint64_t v = R(TMR0) + n;
+    if (v > 0xFF) B(INTCON).TMR0IF = 1;
+    R(TMR0) = (uint8_t)v;
+}
+
+static void tmr0_schedule(void) {
+    uint64_t tick = tmr0_tick();
+    if (!tick || s_sleeping) { Sim_Cancel(&s_tmr0_ev); return; }
+    Sim_Schedule(&s_tmr0_ev, s_tmr0_base + (256 - R(TMR0)) * tick);
+}
+
+static void tmr0_event(sim_event_t* ev) {
+    tmr0_sync(ev->at);
+    tmr0_schedule();
+}
+
+// ── TMR1 ──────────────────────────────────────────────────────────────────
+static sim_event_t s_tmr1_ev;
+static uint64_t s_tmr1_base;
+
+static uint64_t tmr1_tick(void) {
+    if (!B(T1CON).TMR1ON) return 0;
+    uint64_t src;
+    switch (B(T1CON).TMR1CS) {
+        case 0:  src = s_cyc_ns; break;         // Fosc/4
+        case 1:  src = s_cyc_ns / 4; break;     // Fosc
+        default: return 0;                      // T1CKI / SOSC not wired
+    }
+    return src << B(T1CON).T1CKPS;
+}
+
+static void tmr1_sync(uint64_t t) {
+    uint64_t tick = tmr1_tick();
+    if (t <= s_tmr1_base) return;
+    if (!tick || s_sleeping) { s_tmr1_base = t; return; }
+    uint64_t n = (t - s_tmr1_base) / tick;
+    if (!n) return;
+    s_tmr1_base += n * tick;
+    uint64_t v = ((uint32_t)R(TMR1H) << 8 | R(TMR1L)) + n;
+    if (v > 0xFFFF) B(PIR1).TMR1IF = 1;
+    R(TMR1H) = (uint8_t)(v >> 8);
+    R(TMR1L) = (uint8_t)v;
+}
+
+static void tmr1_schedule(void) {
+    uint64_t tick = tmr1_tick();
+    if (!tick || s_sleeping) { Sim_Cancel(&s_tmr1_ev); return; }
+    uint32_t v = (uint32_t)R(TMR1H) << 8 | R(TMR1L);
+    Sim_Schedule(&s_tmr1_ev, s_tmr1_base + (0x10000 - v) * tick);
+}
+
+static void tmr1_event(sim_event_t* ev) {
+    tmr1_sync(ev->at);
+    tmr1_schedule();
+}
+
+// ── TMR2 ──────────────────────────────────────────────────────────────────
+static sim_event_t s_tmr2_ev;
+static uint64_t s_tmr2_base;
+static uint8_t s_tmr2_post;
+
+static uint64_t tmr2_tick(void) {
+    static const uint8_t shift[4] = { 0, 2, 4, 6 };
+    if (!B(T2CON).TMR2ON) return 0;
+    return (uint64_t)s_cyc_ns << shift[B(T2CON).T2CKPS];
+}
+
+// Ticks until TMR2 next resets to zero, and whether that reset is a PR2 match
+static uint32_t tmr2_to_reset(bool* match) {
+    *match = R(TMR2) <= R(PR2);
+    return *match ? (uint32_t)(R(PR2) - R(TMR2) + 1) : (uint32_t)(256 - R(TMR2));
+}
+
+// Count k PR2 matches through the postscaler
+static void tmr2_matches(uint64_t k) {
+    uint64_t total = s_tmr2_post + k;
+    uint8_t outps = (uint8_t)(B(T2CON).T2OUTPS + 1);
+    if (total >= outps) B(PIR1).TMR2IF = 1;
+    s_tmr2_post = (uint8_t)(total % outps);
+}
+
+static void tmr2_sync(uint64_t t) {
+    uint64_t tick = tmr2_tick();
+    if (t <= s_tmr2_base) return;
+    if (!tick || s_sleeping) { s_tmr2_base = t; return; }
+    uint64_t n = (t - s_tmr2_base) / tick;
+    if (!n) return;
+    s_tmr2_base += n * tick;
+
+    bool match;
+    uint32_t left = tmr2_to_reset(&match);
+    if (n < left) {
+        R(TMR2) = (uint8_t)(R(TMR2) + n);
+        return;
+    }
+    n -= left;
+    if (match) tmr2_matches(1);
+    uint64_t period = (uint64_t)R(PR2) + 1;
+    if (n >= period) tmr2_matches(n / period);
+    R(TMR2) = (uint8_t)(n % period);
+}
+
+static void tmr2_schedule(void) {
+    uint64_t tick = tmr2_tick();
+    if (!tick || s_sleeping) { Sim_Cancel(&s_tmr2_ev); return; }
+    bool match;
+    uint32_t left = tmr2_to_reset(&match);
+    Sim_Schedule(&s_tmr2_ev, s_tmr2_base + left * tick);
+}
+
+static void tmr2_event(sim_event_t* ev) {
+    tmr2_sync(ev->at);
+    tmr2_schedule();
+}
+
+static void timers_sync(void) {
+    tmr0_sync(s_now);
+    tmr1_sync(s_now);
+    tmr2_sync(s_now);
+}
+
+static void timers_schedule(void) {
+    tmr0_schedule();
+    tmr1_schedule();
+    tmr2_schedule();
+}
+
+// ── ADC ───────────────────────────────────────────────────────────────────
+static sim_event_t s_adc_ev;
+
+static void adc_start(void) {
+    static const uint8_t tosc[8] = { 2, 8, 32, 0, 4, 16, 64, 0 };
+    uint8_t div = tosc[B(ADCON1).ADCS];
+    uint64_t tad = div ? (uint64_t)s_cyc_ns * div / 4 : 1600;  // FRC ~1.6 us
+    Sim_Schedule(&s_adc_ev, s_now + tad * 23 / 2);             // 11.5 TAD
+}
+
+static void adc_event(sim_event_t* ev) {
+    (void)ev;
+    if (!B(ADCON0).GO_nDONE) return;
+    uint16_t v = (B(ADCON0).ADON && s_adc_source) ? s_adc_source(B(ADCON0).CHS) : 0;
+    if (v > 1023) v = 1023;
+    if (B(ADCON1).ADFM) {
+        R(ADRESH) = (uint8_t)(v >> 8);
+        R(ADRESL) = (uint8_t)v;
+    } else {
+        R(ADRESH) = (uint8_t)(v >> 2);
+        R(ADRESL) = (uint8_t)(v << 6);
+    }
+    B(ADCON0).GO_nDONE = 0;
+    B(PIR1).ADIF = 1;
+}
+
+// ── EUSART ────────────────────────────────────────────────────────────────
+static sim_event_t s_uart_ev;
+static bool s_tsr_busy;
+static uint8_t s_tsr;
+static bool s_txreg_full;
+static uint8_t s_txreg;
+static uint8_t s_rxfifo[2];
+static uint8_t s_rxcount;
+
+uint64_t Sim_UartByteTime(void) {
+    uint32_t brg = B(BAUDCON).BRG16 ? ((uint32_t)R(SPBRGH) << 8 | R(SPBRGL)) : R(SPBRGL);
+    uint32_t div = B(BAUDCON).BRG16 ? (B(TXSTA).BRGH ? 4 : 16) : (B(TXSTA).BRGH ? 16 : 64);
+    return 10ULL * s_cyc_ns / 4 * div * (brg + 1);
+}
+
+static void uart_flags(void) {
+    B(PIR1).TXIF = (B(TXSTA).TXEN && !s_txreg_full) ? 1 : 0;
+    B(TXSTA).TRMT = s_tsr_busy ? 0 : 1;
+    B(PIR1).RCIF = s_rxcount ? 1 : 0;
+}
+
+static void uart_write(uint8_t data) {
+    if (!B(TXSTA).TXEN || !B(RCSTA).SPEN) return;
+    if (!s_tsr_busy) {
+        s_tsr = data;
+        s_tsr_busy = true;
+        Sim_Schedule(&s_uart_ev, s_now + Sim_UartByteTime());
+    } else {
+        s_txreg = data;
+        s_txreg_full = true;
+    }
+    uart_flags();
+}
+
+static void uart_event(sim_event_t* ev) {
+    if (s_uart_sink) s_uart_sink(s_tsr);
+    if (s_txreg_full) {
+        s_tsr = s_txreg;
+        s_txreg_full = false;
+        Sim_Schedule(&s_uart_ev, ev->at + Sim_UartByteTime());
+    } else {
+        s_tsr_busy = false;
+    }
+    uart_flags();
+}
+
+void Sim_UartReceive(uint8_t data) {
+    if (!B(RCSTA).SPEN || !B(RCSTA).CREN) return;
+    if (s_rxcount == sizeof(s_rxfifo)) {
+        B(RCSTA).OERR = 1;
+        return;
+    }
+    s_rxfifo[s_rxcount++] = data;
+    uart_flags();
+}
+
+static void uart_read(void) {
+    if (!s_rxcount) return;
+    s_rxfifo[0] = s_rxfifo[1];
+    s_rxcount--;
+    uart_flags();
+}
+
+// ── EEPROM / flash self-write ─────────────────────────────────────────────
+static sim_event_t s_ee_ev;
+static uint8_t s_ee_addr, s_ee_data;
+static uint16_t s_latch[32];
+
+static uint16_t ee_flash_addr(void) {
+    return (uint16_t)(((uint16_t)R(EEADRH) << 8 | R(EEADRL)) & (SIM_FLASH_WORDS - 1));
+}
+
+static void ee_event(sim_event_t* ev) {
+    (void)ev;
+    sim_eeprom[s_ee_addr] = s_ee_data;
+    sim_eeprom_writes[s_ee_addr]++;
+    B(EECON1).WR = 0;
+    B(PIR2).EEIF = 1;
+}
+
+static void ee_read(void) {
+    B(EECON1).RD = 0;
+    if (B(EECON1).CFGS) {
+        R(EEDATL) = R(EEDATH) = 0;
+    } else if (B(EECON1).EEPGD) {
+        uint16_t w = sim_flash[ee_flash_addr()];
+        R(EEDATL) = (uint8_t)w;
+        R(EEDATH) = (uint8_t)(w >> 8);
+    } else {
+        R(EEDATL) = sim_eeprom[R(EEADRL)];
+    }
+}
+
+static void ee_write(void) {
+    if (!B(EECON1).WREN || B(EECON1).CFGS) {
+        B(EECON1).WR = 0;
+        return;
+    }
+    if (!B(EECON1).EEPGD) {
+        // Data EEPROM: self-timed, CPU keeps running
+        s_ee_addr = R(EEADRL);
+        s_ee_data = R(EEDATL);
+        Sim_Schedule(&s_ee_ev, s_now + SIM_MS(4));
+        return;
+    }
+
+    // Program memory: the CPU stalls for the erase/write time
+    uint16_t addr = ee_flash_addr();
+    uint16_t row = addr & ~31u;
+    if (B(EECON1).FREE) {
+        for (uint8_t i = 0; i < 32; i++) sim_flash[row + i] = 0x3FFF;
+        s_now += SIM_MS(2);
+    } else {
+        s_latch[addr & 31] = (uint16_t)(((uint16_t)R(EEDATH) << 8 | R(EEDATL)) & 0x3FFF);
+        if (!B(EECON1).LWLO) {
+            for (uint8_t i = 0; i < 32; i++) {
+                sim_flash[row + i] &= s_latch[i];
+                s_latch[i] = 0x3FFF;
+            }
+            s_now += SIM_MS(2);
+        }
+    }
+    B(EECON1).WR = 0;
+}
+
+// ── Ports ─────────────────────────────────────────────────────────────────
+static const uint8_t s_lat_sfr[SIM_NUM_PORTS] = { SFR_LATA, SFR_LATB, SFR_LATC };
+static const uint8_t s_tris_sfr[SIM_NUM_PORTS] = { SFR_TRISA, SFR_TRISB, SFR_TRISC };
+static const uint8_t s_ansel_sfr[SIM_NUM_PORTS] = { SFR_ANSELA, SFR_ANSELB, SFR_ANSELC };
+static const uint8_t s_port_sfr[SIM_NUM_PORTS] = { SFR_PORTA, SFR_PORTB, SFR_PORTC };
+static const uint8_t s_port_mask[SIM_NUM_PORTS] = { 0x3F, 0xF0, 0xFF };
+
+static void ports_update(void) {
+    for (uint8_t p = 0; p < SIM_NUM_PORTS; p++) {
+        uint8_t level = (uint8_t)((s_reg[s_lat_sfr[p]] | s_reg[s_tris_sfr[p]]) & s_ext[p] & s_port_mask[p]);
+        uint8_t changed = level ^ s_level[p];
+        s_level[p] = level;
+        s_reg[s_port_sfr[p]] = level & (uint8_t)~s_reg[s_ansel_sfr[p]];
+        if (!changed) continue;
+
+        if (p == SIM_PORTA) {
+            R(IOCAF) |= (uint8_t)((changed & ~level & R(IOCAN)) | (changed & level & R(IOCAP)));
+        } else if (p == SIM_PORTB) {
+            R(IOCBF) |= (uint8_t)((changed & ~level & R(IOCBN)) | (changed & level & R(IOCBP)));
+        }
+        sim_update_iocif();
+        for (uint8_t i = 0; i < s_numlisteners; i++) s_listeners[i](p, level, changed);
+    }
+}
+
+void Sim_SetInput(uint8_t port, uint8_t bit, bool level) {
+    uint8_t mask = (uint8_t)(1u << bit);
+    uint8_t ext = level ? (s_ext[port] | mask) : (s_ext[port] & (uint8_t)~mask);
+    if (ext == s_ext[port]) return;
+    s_ext[port] = ext;
+    ports_update();
+}
+
+bool Sim_GetPin(uint8_t port, uint8_t bit) {
+    return (s_level[port] >> bit) & 1;
+}
+
+void Sim_AddPinListener(sim_pin_listener_t fn) {
+    if (s_numlisteners == MAX_LISTENERS) Sim_Fail("too many pin listeners");
+    s_listeners[s_numlisteners++] = fn;
+}
+
+void Sim_SetAdcSource(sim_adc_source_t fn) { s_adc_source = fn; }
+void Sim_SetUartSink(sim_uart_sink_t fn) { s_uart_sink = fn; }
+
+// ── Register access ───────────────────────────────────────────────────────
+// Bring the peripheral behind `sfr` up to date before the firmware sees it.
+static void sim_before(uint8_t sfr) {
+    switch (sfr) {
+        case SFR_TMR0: case SFR_OPTION_REG:
+            tmr0_sync(s_now);
+            break;
+        case SFR_TMR1L: case SFR_TMR1H: case SFR_T1CON:
+            tmr1_sync(s_now);
+            break;
+        case SFR_TMR2: case SFR_PR2: case SFR_T2CON:
+            tmr2_sync(s_now);
+            break;
+        case SFR_OSCCON:
+            timers_sync();
+            break;
+        case SFR_RCREG:
+            R(RCREG) = s_rxfifo[0];
+            break;
+        default:
+            break;
+    }
+}
+
+// React to what the firmware did with the register it was last handed.
+static void sim_commit(void) {
+    if (s_pending < 0) return;
+    uint8_t sfr = (uint8_t)s_pending;
+    uint8_t before = s_before;
+    uint8_t now = s_reg[sfr];
+    s_pending = -1;
+
+    // Access-triggered registers first; the rest only matter when changed
+    switch (sfr) {
+        case SFR_TXREG: uart_write(now); return;
+        case SFR_RCREG: uart_read(); return;
+        default: break;
+    }
+    if (now == before) return;
+
+    switch (sfr) {
+        case SFR_INTCON:
+            sim_update_iocif();             // IOCIF is read-only
+            break;
+        case SFR_PIR1:
+            uart_flags();                   // TXIF/RCIF are read-only
+            break;
+        case SFR_IOCAF: case SFR_IOCBF:
+            sim_update_iocif();
+            break;
+        case SFR_PORTA: case SFR_PORTB: case SFR_PORTC:
+            s_reg[s_lat_sfr[sfr - SFR_PORTA]] = now;    // writes go to the latch
+            ports_update();
+            break;
+        case SFR_LATA: case SFR_LATB: case SFR_LATC:
+        case SFR_TRISA: case SFR_TRISB: case SFR_TRISC:
+        case SFR_ANSELA: case SFR_ANSELB: case SFR_ANSELC:
+            ports_update();
+            break;
+        case SFR_TMR0:
+            s_tmr0_base = s_now;            // a write clears the prescaler
+            tmr0_schedule();
+            break;
+        case SFR_OPTION_REG:
+            tmr0_schedule();
+            break;
+        case SFR_TMR1L: case SFR_TMR1H:
+            s_tmr1_base = s_now;
+            tmr1_schedule();
+            break;
+        case SFR_T1CON:
+            tmr1_schedule();
+            break;
+        case SFR_TMR2:
+            s_tmr2_base = s_now;
+            tmr2_schedule();
+            break;
+        case SFR_T2CON:
+            if (B(T2CON).T2OUTPS != (before >> 3 & 0x0F)) s_tmr2_post = 0;
+            tmr2_schedule();
+            break;
+        case SFR_PR2:
+            tmr2_schedule();
+            break;
+        case SFR_OSCCON:
+            sim_update_clock();
+            timers_schedule();
+            break;
+        case SFR_ADCON0:
+            if (B(ADCON0).GO_nDONE && !(before & 0x02)) adc_start();
+            else if (!B(ADCON0).GO_nDONE) Sim_Cancel(&s_adc_ev);
+            break;
+        case SFR_TXSTA:
+            uart_flags();
+            break;
+        case SFR_RCSTA:
+            if (!B(RCSTA).CREN) B(RCSTA).OERR = 0;
+            break;
+        case SFR_EECON1:
+            if (B(EECON1).RD && !(before & 0x01)) ee_read();
+            if (B(EECON1).WR && !(before & 0x02)) ee_write();
+            break;
+        default:
+            break;
+    }
+}
+
+volatile uint8_t* Sim_Access(uint8_t sfr) {
+    sim_commit();
+    s_now += s_cyc_ns;
+    s_cycles++;
+    sim_service();
+    sim_before(sfr);
+    s_pending = sfr;
+    s_before = s_reg[sfr];
+    return &s_reg[sfr];
+}
+
+// ── Intrinsics ────────────────────────────────────────────────────────────
+void Sim_DelayCycles(uint32_t cycles) {
+    sim_commit();
+    uint64_t until = s_now + (uint64_t)cycles * s_cyc_ns;
+    s_cycles += cycles;
+    while (s_now < until) {
+        // Interrupts still run during a delay loop and stretch it
+        s_now = (s_next < until) ? s_next : until;
+        sim_service();
+    }
+}
+
+void Sim_Idle(void) {
+    sim_commit();
+    if (s_next > s_now) s_now = s_next;
+    sim_service();
+}
+
+// ── Watchdog ──────────────────────────────────────────────────────────────
+// Only modelled as the wake-up source from SLEEP; the period is the nominal
+// 1 ms << WDTPS of the 31 kHz LFINTOSC
+static sim_event_t s_wdt_ev;
+static bool s_wdt_fired;
+static uint64_t s_sleep_ns;         // total time spent in SLEEP
+
+static void wdt_event(sim_event_t* ev) {
+    (void)ev;
+    s_wdt_fired = true;
+}
+
+void Sim_ClearWdt(void) {
+    sim_commit();
+    B(STATUS).nPD = 1;
+    B(STATUS).nTO = 1;
+}
+
+void Sim_Sleep(void) {
+    // Fosc stops: the clocked timers freeze until an enabled interrupt
+    // source (GIE not required) or the watchdog wakes the core
+    sim_commit();
+    timers_sync();
+    s_sleeping = true;
+    timers_schedule();
+    uint64_t start = s_now;
+    B(STATUS).nPD = 0;
+    B(STATUS).nTO = 1;
+    s_wdt_fired = false;
+    if (B(WDTCON).SWDTEN) Sim_Schedule(&s_wdt_ev, s_now + (SIM_MS(1) << B(WDTCON).WDTPS));
+    while (!sim_irq_flagged() && !s_wdt_fired) {
+        s_now = s_next;
+        sim_run_events();
+    }
+    if (s_wdt_fired) B(STATUS).nTO = 0;
+    Sim_Cancel(&s_wdt_ev);
+    s_sleep_ns += s_now - start;
+    s_sleeping = false;
+    timers_sync();
+    timers_schedule();
+    sim_service();
+}
+
+void Sim_Reset(void) {
+    Sim_Fail("RESET instruction executed");
+}
+
+// ── Resets ────────────────────────────────────────────────────────────────
+// The firmware objects have their .data and .bss renamed to fw_data and
+// fw_bss (see the Makefile), so a reset can do what the C startup code
+// does: reload the initial values and clear the rest.  __persistent
+// variables sit in fw_persist and keep their contents, as on the PIC.
+extern uint8_t __start_fw_data[], __stop_fw_data[];
+extern uint8_t __start_fw_bss[], __stop_fw_bss[];
+static uint8_t* s_fw_image;         // fw_data as loaded
+static sim_event_t s_reset_ev;
+
+static void reset_event(sim_event_t* ev) {
+    (void)ev;
+    longjmp(*s_exit, JUMP_RESET);
+}
+
+void Sim_BrownOut(void) {
+    // Out of the firmware's way first: the caller may be a script step
+    Sim_Schedule(&s_reset_ev, s_now);
+}
+
+static void sim_registers(void);
+
+static void sim_restart(void) {
+    uint8_t pcon = R(PCON);
+    sim_registers();
+    R(PCON) = (uint8_t)((pcon & ~0x01) | 0x02);     // nBOR clear, nPOR as left
+    memcpy(__start_fw_data, s_fw_image, (size_t)(__stop_fw_data - __start_fw_data));
+    memset(__start_fw_bss, 0, (size_t)(__stop_fw_bss - __start_fw_bss));
+}
+
+// ── Run control ───────────────────────────────────────────────────────────
+uint64_t Sim_Now(void) { return s_now; }
+uint64_t Sim_Cycles(void) { return s_cycles; }
+uint64_t Sim_SleepTime(void) { return s_sleep_ns; }
+uint32_t Sim_ClockHz(void) { return (uint32_t)(4000000000ULL / s_cyc_ns); }
+
+// Power-on state of the core and its peripherals; time, the models'
+// events and pins and the non-volatile memories carry on
+static void sim_registers(void) {
+    memset(s_reg, 0, sizeof(s_reg));
+    // Power-on values that differ from zero
+    R(OPTION_REG) = 0xFF;
+    R(TRISA) = 0x3F;
+    R(TRISB) = 0xF0;
+    R(TRISC) = 0xFF;
+    R(ANSELA) = 0x17;
+    R(ANSELB) = 0x30;
+    R(ANSELC) = 0xCF;
+    R(WPUA) = 0x3F;
+    R(WPUB) = 0xF0;
+    R(WPUC) = 0xFF;
+    R(OSCCON) = 0x38;
+    R(PR2) = 0xFF;
+    R(TXSTA) = 0x02;
+    R(BAUDCON) = 0x01;
+    R(STATUS) = 0x18;
+    R(PCON) = 0x0C;
+    R(WDTCON) = 0x16;
+
+    s_pending = -1;
+    s_in_isr = s_sleeping = false;
+    s_tmr0_base = s_tmr1_base = s_tmr2_base = s_now;
+    s_tmr2_post = 0;
+    s_tsr_busy = s_txreg_full = false;
+    s_rxcount = 0;
+    Sim_Cancel(&s_tmr0_ev);
+    Sim_Cancel(&s_tmr1_ev);
+    Sim_Cancel(&s_tmr2_ev);
+    Sim_Cancel(&s_adc_ev);
+    Sim_Cancel(&s_uart_ev);
+    Sim_Cancel(&s_ee_ev);
+    Sim_Cancel(&s_wdt_ev);
+
+    sim_update_clock();
+    ports_update();
+    uart_flags();
+    timers_schedule();
+}
+
+void Sim_Init(void) {
+    s_now = 0;
+    s_end = NEVER;
+    s_next = NEVER;
+    s_cycles = 0;
+    s_numevents = 0;
+    s_numlisteners = 0;
+
+    memset(sim_eeprom, 0xFF, sizeof(sim_eeprom));
+    memset(sim_eeprom_writes, 0, sizeof(sim_eeprom_writes));
+    for (uint16_t i = 0; i < SIM_FLASH_WORDS; i++) sim_flash[i] = 0x3FFF;
+    for (uint8_t i = 0; i < 32; i++) s_latch[i] = 0x3FFF;
+
+    s_tmr0_ev.fn = tmr0_event;
+    s_tmr1_ev.fn = tmr1_event;
+    s_tmr2_ev.fn = tmr2_event;
+    s_adc_ev.fn = adc_event;
+    s_uart_ev.fn = uart_event;
+    s_ee_ev.fn = ee_event;
+    s_tmr0_ev.armed = s_tmr1_ev.armed = s_tmr2_ev.armed = false;
+    s_adc_ev.armed = s_uart_ev.armed = s_ee_ev.armed = false;
+    s_wdt_ev.fn = wdt_event;
+    s_wdt_ev.armed = false;
+    s_reset_ev.fn = reset_event;
+    s_reset_ev.armed = false;
+    s_sleep_ns = 0;
+
+    if (!s_fw_image) {
+        // Before the firmware has run, in the forked scenario child
+        size_t size = (size_t)(__stop_fw_data - __start_fw_data);
+        s_fw_image = malloc(size);
+        memcpy(s_fw_image, __start_fw_data, size);
+    }
+
+    memset(s_ext, 0xFF, sizeof(s_ext));
+    memset(s_level, 0, sizeof(s_level));
+    sim_registers();
+}
+
+void Sim_Run(void (*entry)(void), uint64_t duration) {
+    jmp_buf env;
+    s_end = s_now + duration;
+    sim_find_next();
+    s_exit = &env;
+    switch (setjmp(env)) {
+        case JUMP_RESET:
+            sim_restart();
+            // fall through
+        case 0:
+            entry();
+            Sim_Fail("firmware returned from main");
+            break;
+        default:
+            break;
+    }
+    s_exit = NULL;
+    s_pending = -1;
+    s_now = s_end;
+    s_end = NEVER;
+    sim_find_next();
+}
@@ -0,0 +1,71 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Virtual PIC16F1829 ────────────────────────────────────────────────────
+//
+// Virtual time is kept in nanoseconds.  The firmware advances it by one
+// instruction cycle per register access (see xc.h) and skips straight to the
+// next peripheral or model event from the scheduler idle hook, so hours of
+// operation run in seconds of host time.  Peripheral models cover TMR0,
+// TMR1, TMR2, the ADC, EUSART, data EEPROM / flash self-write, the port
+// latches, interrupt-on-change and the watchdog as a wake-up from SLEEP.
+// External hardware (NTC, supply, motor driver, display, ESP32) plugs in
+// through the hooks below.
+
+#define SIM_US(x)   ((uint64_t)(x) * 1000ULL)
+#define SIM_MS(x)   ((uint64_t)(x) * 1000000ULL)
+#define SIM_S(x)    ((uint64_t)(x) * 1000000000ULL)
+
+enum { SIM_PORTA = 0, SIM_PORTB, SIM_PORTC, SIM_NUM_PORTS };
+
+// ── Events ────────────────────────────────────────────────────────────────
+typedef struct sim_event {
+    uint64_t at;
+    void (*fn)(struct sim_event* ev);
+    void* ctx;
+    bool armed;
+} sim_event_t;
+
+void Sim_Schedule(sim_event_t* ev, uint64_t at);
+void Sim_Cancel(sim_event_t* ev);
+
+// ── Run control ───────────────────────────────────────────────────────────
+void Sim_Init(void);                                // power-on reset state
+void Sim_Run(void (*entry)(void), uint64_t duration);  // returns at Now + duration
+void Sim_Idle(void);                                // SCHEDULER_IDLE() hook
+uint64_t Sim_Now(void);
+uint64_t Sim_Cycles(void);                      // firmware cycles executed
+uint64_t Sim_SleepTime(void);                   // ns spent in SLEEP
+uint32_t Sim_ClockHz(void);                     // current Fosc
+void Sim_BrownOut(void);        // reset with nBOR; only __persistent RAM survives
+void Sim_Fail(const char* fmt, ...);
+
+// ── Pins ──────────────────────────────────────────────────────────────────
+// External side of a pin: 1 = released (pulled high), 0 = driven low.
+// The pin level is the wired-AND of the PIC driver and the external side.
+void Sim_SetInput(uint8_t port, uint8_t bit, bool level);
+bool Sim_GetPin(uint8_t port, uint8_t bit);
+typedef void (*sim_pin_listener_t)(uint8_t port, uint8_t level, uint8_t changed);
+void Sim_AddPinListener(sim_pin_listener_t fn);
+
+// ── Analog inputs ─────────────────────────────────────────────────────────
+typedef uint16_t (*sim_adc_source_t)(uint8_t chs);  // 10-bit result for CHS
+void Sim_SetAdcSource(sim_adc_source_t fn);
+
+// ── EUSART ────────────────────────────────────────────────────────────────
+typedef void (*sim_uart_sink_t)(uint8_t data);      // byte left the TX pin
+void Sim_SetUartSink(sim_uart_sink_t fn);
+void Sim_UartReceive(uint8_t data);                 // byte arrived on RX
+uint64_t Sim_UartByteTime(void);                    // at the current baud rate
+
+// ── Non-volatile memory ───────────────────────────────────────────────────
+#define SIM_EEPROM_SIZE     256
+#define SIM_FLASH_WORDS     0x2000
+extern uint8_t sim_eeprom[SIM_EEPROM_SIZE];
+extern uint16_t sim_flash[SIM_FLASH_WORDS];
+extern uint32_t sim_eeprom_writes[SIM_EEPROM_SIZE];  // per-cell write count
+
+#endif // SIM_H
@@ -0,0 +1,200 @@
+#ifndef SIM_XC_H
+#define SIM_XC_H
+
+// ── Host stand-in for the XC8 device header (PIC16F1829) ─────────────────
+//
+// Every special function register is a byte in the simulator's register
+// file.  Each access goes through Sim_Access(), which charges one
+// instruction cycle of virtual time, lets the peripheral models catch up
+// (timers, ADC, EUSART, EEPROM, pins) and delivers pending interrupts before
+// the firmware touches the register.  The firmware sources compile
+// unchanged; only this header, the -I order and a few -D hooks differ.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_SFR_LIST(X) \
+    X(INTCON) X(OPTION_REG) X(STATUS) X(PCON) \
+    X(PIE1) X(PIR1) X(PIE2) X(PIR2) \
+    X(PORTA) X(PORTB) X(PORTC) X(LATA) X(LATB) X(LATC) \
+    X(TRISA) X(TRISB) X(TRISC) X(ANSELA) X(ANSELB) X(ANSELC) \
+    X(WPUA) X(WPUB) X(WPUC) X(IOCAF) X(IOCAN) X(IOCAP) \
+    X(IOCBF) X(IOCBN) X(IOCBP) X(APFCON0) X(APFCON1) \
+    X(OSCCON) X(OSCTUNE) X(BORCON) X(WDTCON) \
+    X(TMR0) X(TMR1L) X(TMR1H) X(T1CON) X(T1GCON) X(TMR2) X(PR2) X(T2CON) \
+    X(ADCON0) X(ADCON1) X(ADRESL) X(ADRESH) \
+    X(TXSTA) X(RCSTA) X(BAUDCON) X(SPBRGL) X(SPBRGH) X(TXREG) X(RCREG) \
+    X(EEADRL) X(EEADRH) X(EEDATL) X(EEDATH) X(EECON1) X(EECON2)
+
+#define SIM_SFR_ENUM(name) SFR_##name,
+enum { SIM_SFR_LIST(SIM_SFR_ENUM) SIM_NUM_SFRS };
+#undef SIM_SFR_ENUM
+
+volatile uint8_t* Sim_Access(uint8_t sfr);
+
+#define SIM_SFR(name)       (*Sim_Access(SFR_##name))
+#define SIM_SFRBITS(name)   (*(volatile name##bits_t*)Sim_Access(SFR_##name))
+
+// ── Bit layouts (LSB first, as in the datasheet) ─────────────────────────
+typedef struct { uint8_t IOCIF:1, INTF:1, TMR0IF:1, IOCIE:1, INTE:1, TMR0IE:1, PEIE:1, GIE:1; } INTCONbits_t;
+typedef struct { uint8_t PS:3, PSA:1, TMR0SE:1, TMR0CS:1, INTEDG:1, nWPUEN:1; } OPTION_REGbits_t;
+typedef struct { uint8_t C:1, DC:1, Z:1, nPD:1, nTO:1, :3; } STATUSbits_t;
+typedef struct { uint8_t nBOR:1, nPOR:1, nRI:1, nRMCLR:1, nRWDT:1, :1, STKUNF:1, STKOVF:1; } PCONbits_t;
+typedef struct { uint8_t TMR1IE:1, TMR2IE:1, CCP1IE:1, SSP1IE:1, TXIE:1, RCIE:1, ADIE:1, TMR1GIE:1; } PIE1bits_t;
+typedef struct { uint8_t TMR1IF:1, TMR2IF:1, CCP1IF:1, SSP1IF:1, TXIF:1, RCIF:1, ADIF:1, TMR1GIF:1; } PIR1bits_t;
+typedef struct { uint8_t CCP2IE:1, :2, BCL1IE:1, EEIE:1, C1IE:1, C2IE:1, OSFIE:1; } PIE2bits_t;
+typedef struct { uint8_t CCP2IF:1, :2, BCL1IF:1, EEIF:1, C1IF:1, C2IF:1, OSFIF:1; } PIR2bits_t;
+typedef struct { uint8_t RA0:1, RA1:1, RA2:1, RA3:1, RA4:1, RA5:1, :2; } PORTAbits_t;
+typedef struct { uint8_t :4, RB4:1, RB5:1, RB6:1, RB7:1; } PORTBbits_t;
+typedef struct { uint8_t RC0:1, RC1:1, RC2:1, RC3:1, RC4:1, RC5:1, RC6:1, RC7:1; } PORTCbits_t;
+typedef struct { uint8_t LATA0:1, LATA1:1, LATA2:1, LATA3:1, LATA4:1, LATA5:1, :2; } LATAbits_t;
+typedef struct { uint8_t :4, LATB4:1, LATB5:1, LATB6:1, LATB7:1; } LATBbits_t;
+typedef struct { uint8_t LATC0:1, LATC1:1, LATC2:1, LATC3:1, LATC4:1, LATC5:1, LATC6:1, LATC7:1; } LATCbits_t;
+typedef struct { uint8_t TRISA0:1, TRISA1:1, TRISA2:1, TRISA3:1, TRISA4:1, TRISA5:1, :2; } TRISAbits_t;
+typedef struct { uint8_t :4, TRISB4:1, TRISB5:1, TRISB6:1, TRISB7:1; } TRISBbits_t;
+typedef struct { uint8_t TRISC0:1, TRISC1:1, TRISC2:1, TRISC3:1, TRISC4:1, TRISC5:1, TRISC6:1, TRISC7:1; } TRISCbits_t;
+typedef struct { uint8_t ANSA0:1, ANSA1:1, ANSA2:1, :1, ANSA4:1, :3; } ANSELAbits_t;
+typedef struct { uint8_t :4, ANSB4:1, ANSB5:1, :2; } ANSELBbits_t;
+typedef struct { uint8_t ANSC0:1, ANSC1:1, ANSC2:1, ANSC3:1, :2, ANSC6:1, ANSC7:1; } ANSELCbits_t;
+typedef struct { uint8_t WPUA0:1, WPUA1:1, WPUA2:1, WPUA3:1, WPUA4:1, WPUA5:1, :2; } WPUAbits_t;
+typedef struct { uint8_t :4, WPUB4:1, WPUB5:1, WPUB6:1, WPUB7:1; } WPUBbits_t;
+typedef struct { uint8_t WPUC0:1, WPUC1:1, WPUC2:1, WPUC3:1, WPUC4:1, WPUC5:1, WPUC6:1, WPUC7:1; } WPUCbits_t;
+typedef struct { uint8_t IOCAF0:1, IOCAF1:1, IOCAF2:1, IOCAF3:1, IOCAF4:1, IOCAF5:1, :2; } IOCAFbits_t;
+typedef struct { uint8_t IOCAN0:1, IOCAN1:1, IOCAN2:1, IOCAN3:1, IOCAN4:1, IOCAN5:1, :2; } IOCANbits_t;
+typedef struct { uint8_t IOCAP0:1, IOCAP1:1, IOCAP2:1, IOCAP3:1, IOCAP4:1, IOCAP5:1, :2; } IOCAPbits_t;
+typedef struct { uint8_t :4, IOCBF4:1, IOCBF5:1, IOCBF6:1, IOCBF7:1; } IOCBFbits_t;
+typedef struct { uint8_t :4, IOCBN4:1, IOCBN5:1, IOCBN6:1, IOCBN7:1; } IOCBNbits_t;
+typedef struct { uint8_t :4, IOCBP4:1, IOCBP5:1, IOCBP6:1, IOCBP7:1; } IOCBPbits_t;
+typedef struct { uint8_t SCS:2, :1, IRCF:4, SPLLEN:1; } OSCCONbits_t;
+typedef struct { uint8_t SWDTEN:1, WDTPS:5, :2; } WDTCONbits_t;
+typedef struct { uint8_t TMR1ON:1, :1, nT1SYNC:1, T1OSCEN:1, T1CKPS:2, TMR1CS:2; } T1CONbits_t;
+typedef struct { uint8_t T1GSS:2, T1GVAL:1, T1GGO:1, T1GSPM:1, T1GTM:1, T1GPOL:1, TMR1GE:1; } T1GCONbits_t;
+typedef struct { uint8_t T2CKPS:2, TMR2ON:1, T2OUTPS:4, :1; } T2CONbits_t;
+typedef struct { uint8_t ADON:1, GO_nDONE:1, CHS:5, :1; } ADCON0bits_t;
+typedef struct { uint8_t ADPREF:2, ADNREF:1, :1, ADCS:3, ADFM:1; } ADCON1bits_t;
+typedef struct { uint8_t TX9D:1, TRMT:1, BRGH:1, SENDB:1, SYNC:1, TXEN:1, TX9:1, CSRC:1; } TXSTAbits_t;
+typedef struct { uint8_t RX9D:1, OERR:1, FERR:1, ADDEN:1, CREN:1, SREN:1, RX9:1, SPEN:1; } RCSTAbits_t;
+typedef struct { uint8_t ABDEN:1, WUE:1, :1, BRG16:1, SCKP:1, :1, RCIDL:1, ABDOVF:1; } BAUDCONbits_t;
+typedef struct { uint8_t RD:1, WR:1, WREN:1, WRERR:1, FREE:1, LWLO:1, CFGS:1, EEPGD:1; } EECON1bits_t;
+
+// ── Register names ───────────────────────────────────────────────────────
+#define INTCON          SIM_SFR(INTCON)
+#define INTCONbits      SIM_SFRBITS(INTCON)
+#define OPTION_REG      SIM_SFR(OPTION_REG)
+#define OPTION_REGbits  SIM_SFRBITS(OPTION_REG)
+#define STATUS          SIM_SFR(STATUS)
+#define STATUSbits      SIM_SFRBITS(STATUS)
+#define PCON            SIM_SFR(PCON)
+#define PCONbits        SIM_SFRBITS(PCON)
+#define PIE1            SIM_SFR(PIE1)
+#define PIE1bits        SIM_SFRBITS(PIE1)
+#define PIR1            SIM_SFR(PIR1)
+#define PIR1bits        SIM_SFRBITS(PIR1)
+#define PIE2            SIM_SFR(PIE2)
+#define PIE2bits        SIM_SFRBITS(PIE2)
+#define PIR2            SIM_SFR(PIR2)
+#define PIR2bits        SIM_SFRBITS(PIR2)
+#define PORTA           SIM_SFR(PORTA)
+#define PORTAbits       SIM_SFRBITS(PORTA)
+#define PORTB           SIM_SFR(PORTB)
+#define PORTBbits       SIM_SFRBITS(PORTB)
+#define PORTC           SIM_SFR(PORTC)
+#define PORTCbits       SIM_SFRBITS(PORTC)
+#define LATA            SIM_SFR(LATA)
+#define LATAbits        SIM_SFRBITS(LATA)
+#define LATB            SIM_SFR(LATB)
+#define LATBbits        SIM_SFRBITS(LATB)
+#define LATC            SIM_SFR(LATC)
+#define LATCbits        SIM_SFRBITS(LATC)
+#define TRISA           SIM_SFR(TRISA)
+#define TRISAbits       SIM_SFRBITS(TRISA)
+#define TRISB           SIM_SFR(TRISB)
+#define TRISBbits       SIM_SFRBITS(TRISB)
+#define TRISC           SIM_SFR(TRISC)
+#define TRISCbits       SIM_SFRBITS(TRISC)
+#define ANSELA          SIM_SFR(ANSELA)
+#define ANSELAbits      SIM_SFRBITS(ANSELA)
+#define ANSELB          SIM_SFR(ANSELB)
+#define ANSELBbits      SIM_SFRBITS(ANSELB)
+#define ANSELC          SIM_SFR(ANSELC)
+#define ANSELCbits      SIM_SFRBITS(ANSELC)
+#define WPUA            SIM_SFR(WPUA)
+#define WPUAbits        SIM_SFRBITS(WPUA)
+#define WPUB            SIM_SFR(WPUB)
+#define WPUBbits        SIM_SFRBITS(WPUB)
+#define WPUC            SIM_SFR(WPUC)
+#define WPUCbits        SIM_SFRBITS(WPUC)
+#define IOCAF           SIM_SFR(IOCAF)
+#define IOCAFbits       SIM_SFRBITS(IOCAF)
+#define IOCAN           SIM_SFR(IOCAN)
+#define IOCANbits       SIM_SFRBITS(IOCAN)
+#define IOCAP           SIM_SFR(IOCAP)
+#define IOCAPbits       SIM_SFRBITS(IOCAP)
+#define IOCBF           SIM_SFR(IOCBF)
+#define IOCBFbits       SIM_SFRBITS(IOCBF)
+#define IOCBN           SIM_SFR(IOCBN)
+#define IOCBNbits       SIM_SFRBITS(IOCBN)
+#define IOCBP           SIM_SFR(IOCBP)
+#define IOCBPbits       SIM_SFRBITS(IOCBP)
+#define APFCON0         SIM_SFR(APFCON0)
+#define APFCON1         SIM_SFR(APFCON1)
+#define OSCCON          SIM_SFR(OSCCON)
+#define OSCCONbits      SIM_SFRBITS(OSCCON)
+#define OSCTUNE         SIM_SFR(OSCTUNE)
+#define BORCON          SIM_SFR(BORCON)
+#define WDTCON          SIM_SFR(WDTCON)
+#define WDTCONbits      SIM_SFRBITS(WDTCON)
+#define TMR0            SIM_SFR(TMR0)
+#define TMR1L           SIM_SFR(TMR1L)
+#define TMR1H           SIM_SFR(TMR1H)
+#define T1CON           SIM_SFR(T1CON)
+#define T1CONbits       SIM_SFRBITS(T1CON)
+#define T1GCON          SIM_SFR(T1GCON)
+#define T1GCONbits      SIM_SFRBITS(T1GCON)
+#define TMR2            SIM_SFR(TMR2)
+#define PR2             SIM_SFR(PR2)
+#define T2CON           SIM_SFR(T2CON)
+#define T2CONbits       SIM_SFRBITS(T2CON)
+#define ADCON0          SIM_SFR(ADCON0)
+#define ADCON0bits      SIM_SFRBITS(ADCON0)
+#define ADCON1          SIM_SFR(ADCON1)
+#define ADCON1bits      SIM_SFRBITS(ADCON1)
+#define ADRESL          SIM_SFR(ADRESL)
+#define ADRESH          SIM_SFR(ADRESH)
+#define TXSTA           SIM_SFR(TXSTA)
+#define TXSTAbits       SIM_SFRBITS(TXSTA)
+#define RCSTA           SIM_SFR(RCSTA)
+#define RCSTAbits       SIM_SFRBITS(RCSTA)
+#define BAUDCON         SIM_SFR(BAUDCON)
+#define BAUDCONbits     SIM_SFRBITS(BAUDCON)
+#define SPBRGL          SIM_SFR(SPBRGL)
+#define SPBRGH          SIM_SFR(SPBRGH)
+#define TXREG           SIM_SFR(TXREG)
+#define RCREG           SIM_SFR(RCREG)
+#define EEADRL          SIM_SFR(EEADRL)
+#define EEADRH          SIM_SFR(EEADRH)
+#define EEDATL          SIM_SFR(EEDATL)
+#define EEDATH          SIM_SFR(EEDATH)
+#define EECON1          SIM_SFR(EECON1)
+#define EECON1bits      SIM_SFRBITS(EECON1)
+#define EECON2          SIM_SFR(EECON2)
+
+// ── Compiler intrinsics ──────────────────────────────────────────────────
+void Sim_DelayCycles(uint32_t cycles);
+void Sim_ClearWdt(void);
+void Sim_Sleep(void);
+void Sim_Reset(void);
+void Sim_Idle(void);     // SCHEDULER_IDLE() in the host build
+
+#define __interrupt(...)
+#define __persistent    __attribute__((section("fw_persist")))    // see Sim_BrownOut()
+#define NOP()           Sim_DelayCycles(1)
+#define CLRWDT()        Sim_ClearWdt()
+#define SLEEP()         Sim_Sleep()
+#define RESET()         Sim_Reset()
+#define di()            (INTCONbits.GIE = 0)
+#define ei()            (INTCONbits.GIE = 1)
+#define __delay_us(x)   Sim_DelayCycles((uint32_t)((x) * (_XTAL_FREQ / 4000000.0)))
+#define __delay_ms(x)   Sim_DelayCycles((uint32_t)((x) * (_XTAL_FREQ / 4000.0)))
+
+#endif // SIM_XC_H
@@ -0,0 +1,38 @@
+#include "standby.h"
+#include "analog.h"
+#include "comms.h"
+#include "irmcf183.h"
+#include "tm1620b.h"
+#include "mcc_generated_files/mcc.h"
+
+void Standby_Enter(void) {
+    Compressor_OnOff(false, false, 0);  // DC/DC, fan and motor drive supply
+    IO_LightEna_SetLow();
+    TM1620B_SetBrightness(false, 0);
+    TMR1_StopTimer();
+}
+
+standby_wake_t Standby_Sleep(void) {
+    AnalogSuspend();
+    for (uint8_t wakes = 0;;) {
+        WDTCONbits.WDTPS = STANDBY_WDTPS;
+        WDTCONbits.SWDTEN = 1;
+        SLEEP();
+        NOP();
+        WDTCONbits.SWDTEN = 0;
+
+        // Whatever woke the core has been serviced by now
+        if (!Comms_Idle()) return STANDBY_WAKE_LINK;
+        if (TM1620B_GetKeys()) return STANDBY_WAKE_KEY;
+        if (++wakes == STANDBY_SAMPLE_WAKES) {
+            AnalogResume();
+            return STANDBY_WAKE_SAMPLE;
+        }
+    }
+}
+
+void Standby_Leave(void) {
+    AnalogResume();
+    TMR1_StartTimer();
+    TM1620B_Invalidate();
+}
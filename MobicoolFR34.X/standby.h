@@ -0,0 +1,40 @@
+#ifndef STANDBY_H
+#define STANDBY_H
+
+#include <stdint.h>
+
+// ── Deep standby ──────────────────────────────────────────────────────────
+//
+// With the cooler switched off and left alone, main() hands the PIC over to
+// Standby_Sleep() between two scheduler passes.  The 12 V DC/DC, fan, motor
+// drive supply and light are off, the panel is blanked, TMR1 (the scheduler
+// tick) and the analog pacing are stopped, and the core sleeps with the
+// watchdog as its alarm clock:
+//
+//  - the single-wire link wakes it through the RA0 interrupt-on-change that
+//    already catches start bits, so the request is received as usual
+//  - the TM1620B has no key interrupt output, so the keypad is read on each
+//    watchdog wake-up, every STANDBY_WDTPS period
+//  - every STANDBY_SAMPLE_WAKES wake-ups one analog round is taken, so the
+//    cabinet temperature and supply stay current for the companion
+
+#define STANDBY_WDTPS           8   // 1:8192 of the 31 kHz LFINTOSC, ~256 ms
+#define STANDBY_SAMPLE_WAKES    32  // ~8 s
+
+typedef enum {
+    STANDBY_WAKE_KEY = 0,   // A key is down
+    STANDBY_WAKE_LINK,      // A frame is arriving
+    STANDBY_WAKE_SAMPLE     // An analog round is being taken
+} standby_wake_t;
+
+// Power everything down but the PIC and the panel chip
+void Standby_Enter(void);
+
+// Sleep until one of the above; on STANDBY_WAKE_SAMPLE the analog round runs
+// until AnalogUpdate() publishes it and the next call stops it again
+standby_wake_t Standby_Sleep(void);
+
+// Back to normal operation; the panel stays blank until a key is pressed
+void Standby_Leave(void);
+
+#endif /* STANDBY_H */
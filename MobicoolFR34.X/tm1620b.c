@@ -93,15 +93,26 @@ const uint8_t hexdigits[] = { 0b01111101, 0b00101000, 0b11011100, 0b10111100, //
 
 #define TM_A_DISPADDR(x) (x & 0xf)
 
-// No additional delays are needed here because of the slow CPU speed
+// The TM1620B wants CLK high and low for at least 400 ns each.  Up to 8 MHz
+// (500 ns per instruction) the port writes are slow enough on their own;
+// faster clocks pad each half period.
+#if _XTAL_FREQ >= 32000000
+#define TM_CLK_WAIT() do { NOP(); NOP(); NOP(); } while (0)
+#elif _XTAL_FREQ >= 16000000
+#define TM_CLK_WAIT() NOP()
+#else
+#define TM_CLK_WAIT()
+#endif
 
 static uint8_t TM1620B_Recv(bool stbhigh) {
     uint8_t data = 0;
     for (uint8_t b = 0; b < 8; b++) {
         IO_CLK_SetLow();
+        TM_CLK_WAIT();
         data >>= 1;
         data |= (IO_DIO_PORT << 7);
         IO_CLK_SetHigh();
+        TM_CLK_WAIT();
     }
 
     if (stbhigh) {
@@ -117,7 +128,9 @@ static void TM1620B_Send(uint8_t data, bool stbhigh) {
         IO_DIO_LAT = data & 1;
         data >>= 1;
         IO_CLK_SetLow();
+        TM_CLK_WAIT();
         IO_CLK_SetHigh();
+        TM_CLK_WAIT();
     }
 
     if (stbhigh) {
@@ -125,13 +138,50 @@ static void TM1620B_Send(uint8_t data, bool stbhigh) {
     }
 }
 
+// Display RAM as last written, in chip address order (two per grid), so
+// an update only sends what changed.  Rewritten in full every
+// TM_REFRESH_UPDATES updates in case the chip lost its RAM to a glitch.
+#define TM_ADDRS 10
+#define TM_REFRESH_UPDATES 100
+static uint8_t s_shadow[TM_ADDRS];
+static uint8_t s_refresh; // Updates to the next full write, 0 = due now
+
+void TM1620B_Invalidate(void) {
+    s_refresh = 0;
+}
+
 void TM1620B_Update(uint8_t* buf) {
-    TM1620B_Send(TM_ADDR | TM_A_DISPADDR(0), true);
-    TM1620B_Send(TM_DATA | TM_D_WRITE | TM_D_ADDR_INCR, false);
-    for (int8_t i = 4; i >= 0; i--) {
-        uint8_t tmp = buf[i];
-        TM1620B_Send(tmp & 0x3f, false); // Seg 1-6 (bit 0-5)
-        TM1620B_Send((tmp & 0xc0) >> 3, i == 0); // Seg 12-13 (bit 6-7)
+    uint8_t ram[TM_ADDRS];
+    uint8_t changed = 0;
+    for (uint8_t a = 0; a < TM_ADDRS; a += 2) {
+        uint8_t tmp = buf[4 - a / 2];
+        ram[a] = tmp & 0x3f;            // Seg 1-6 (bit 0-5)
+        ram[a + 1] = (tmp & 0xc0) >> 3; // Seg 12-13 (bit 6-7)
+        if (ram[a] != s_shadow[a]) changed++;
+        if (ram[a + 1] != s_shadow[a + 1]) changed++;
+    }
+
+    if (s_refresh == 0 || changed * 2 + 1 >= TM_ADDRS + 2) {
+        // Auto-increment from address 0: one command plus every byte
+        TM1620B_Send(TM_DATA | TM_D_WRITE | TM_D_ADDR_INCR, true);
+        TM1620B_Send(TM_ADDR | TM_A_DISPADDR(0), false);
+        for (uint8_t a = 0; a < TM_ADDRS; a++) {
+            TM1620B_Send(ram[a], a == TM_ADDRS - 1);
+            s_shadow[a] = ram[a];
+        }
+        s_refresh = TM_REFRESH_UPDATES;
+        return;
+    }
+    s_refresh--;
+    if (changed == 0) return;
+
+    // Fixed address: an address command and a byte per changed address
+    TM1620B_Send(TM_DATA | TM_D_WRITE | TM_D_ADDR_FIXED, true);
+    for (uint8_t a = 0; a < TM_ADDRS; a++) {
+        if (ram[a] == s_shadow[a]) continue;
+        TM1620B_Send(TM_ADDR | TM_A_DISPADDR(a), false);
+        TM1620B_Send(ram[a], true);
+        s_shadow[a] = ram[a];
     }
 }
 
@@ -159,6 +209,7 @@ void TM1620B_Init(void) {
     __delay_us(10);
     TM1620B_Send(TM_DISPMODE | TM_DM_5X8, true);
     TM1620B_Send(TM_DISPCTRL | TM_DC_ENABLE | TM_DC_BRIGHTNESS(4), true);
+    TM1620B_Invalidate();
 }
 
 uint8_t FormatDigits(uint8_t* outbuf, int16_t inum, uint8_t mindigits) {
@@ -38,7 +38,10 @@ extern const uint8_t hexdigits[];
 #define KEY_PLUS (1 << 1)
 #define KEY_MINUS (1 << 0)
 
+// Sends only the display addresses that changed since the last update,
+// with a full rewrite every few seconds
 void TM1620B_Update(uint8_t* buf);
+void TM1620B_Invalidate(void); // Rewrite everything on the next update
 uint8_t TM1620B_GetKeys(void);
 void TM1620B_SetBrightness(bool on, uint8_t brightness);
 void TM1620B_Init(void);
@@ -0,0 +1,44 @@
+#include "warmstart.h"
+#include "crc8.h"
+#include <string.h>
+#include <xc.h>
+
+#define WARMSTART_ID    0x52    // CRC seed
+
+static __persistent warmstart_t s_snap;
+static __persistent uint8_t s_crc;
+
+static uint8_t snap_crc(void) {
+    const uint8_t* p = (const uint8_t*)&s_snap;
+    uint8_t crc = WARMSTART_ID;
+    for (uint8_t i = 0; i < sizeof(s_snap); i++) crc = Crc8(crc, p[i]);
+    return crc;
+}
+
+bool WarmStart_Load(warmstart_t* snap) {
+    // A power-on reset clears nPOR, a brown-out only nBOR; set both again so
+    // the next reset can be told apart
+    bool brownout = PCONbits.nPOR && !PCONbits.nBOR;
+    PCONbits.nPOR = 1;
+    PCONbits.nBOR = 1;
+
+    memset(snap, 0, sizeof(*snap));
+    if (!brownout || snap_crc() != s_crc) return false;
+
+    uint8_t resumes = s_snap.uptime - s_snap.resumed_at < WARMSTART_WINDOW ? s_snap.resumes : 0;
+    snap->uptime = s_snap.uptime;
+    snap->resumed_at = s_snap.resumed_at;
+    snap->resumes = resumes;
+    if (resumes >= WARMSTART_MAX_RESUMES) return false;
+
+    *snap = s_snap;
+    snap->resumes = (uint8_t)(resumes + 1);
+    snap->resumed_at = s_snap.uptime;
+    return true;
+}
+
+void WarmStart_Save(const warmstart_t* snap) {
+    // Torn by a brown-out halfway, the CRC fails and the next boot is cold
+    s_snap = *snap;
+    s_crc = snap_crc();
+}
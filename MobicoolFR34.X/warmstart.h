@@ -0,0 +1,45 @@
+#ifndef WARMSTART_H
+#define WARMSTART_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ── Warm restart after a brown-out ────────────────────────────────────────
+//
+// Cranking the engine can pull the supply low enough for a brown-out reset.
+// Data RAM survives one, so once a second main() copies the compressor's run
+// state into a snapshot that the C startup code leaves alone (__persistent),
+// CRC-8 checked and stamped with the seconds since the last cold start.  At
+// boot WarmStart_Load() only hands the snapshot back when PCON says the
+// reset was a brown-out and the CRC holds; anything else is a cold start
+// with the full power-up lockout.
+//
+// Resuming skips that lockout, so it is rationed: a warm restart less than
+// WARMSTART_WINDOW after the previous one counts towards
+// WARMSTART_MAX_RESUMES.  A supply that browns the board out every time the
+// compressor starts gets the cold start's lockout after that.  Snapshots
+// live in RAM, not EEPROM, as one a second would wear the EEPROM out in days.
+
+#define WARMSTART_MAX_RESUMES   3
+#define WARMSTART_WINDOW        120     // s
+
+typedef struct {
+    uint32_t uptime;        // s since the last cold start
+    uint32_t resumed_at;    // uptime at the last warm restart
+    uint8_t resumes;        // warm restarts in a row, see WARMSTART_WINDOW
+    uint8_t state;          // comp_state_t
+    uint8_t timer;          // Compressor state timer, s
+    uint8_t fanspin;
+    uint8_t pmode;          // pmode_t
+    int16_t temperature10;  // Averaged cabinet temperature
+} warmstart_t;
+
+// At boot, before anything else touches PCON.  True, with *snap filled in,
+// to resume.  False for a cold start; *snap is cleared but for the
+// timestamp and resume count when only the rationing said no.
+bool WarmStart_Load(warmstart_t* snap);
+
+// Once a second
+void WarmStart_Save(const warmstart_t* snap);
+
+#endif /* WARMSTART_H */
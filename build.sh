@@ -7,10 +7,15 @@
 # -----
 #   ./build.sh                      # uses XC8_VERSION default (3.10)
 #   XC8_VERSION=3.10 ./build.sh     # select a specific XC8 version
+#   XTAL_FREQ=32000000 ./build.sh   # 32 MHz clock, for a faster ESP32 link
+#   FEATURES="history effmap cycles" ./build.sh
+#                                   # optional modules to build in (Makefile)
 
 set -euo pipefail
 
 XC8_VERSION="${XC8_VERSION:-3.10}"
+XTAL_FREQ="${XTAL_FREQ:-}"
+FEATURES="${FEATURES:-}"
 IMAGE="mobicool-fr34-builder:xc8-${XC8_VERSION}"
 
 SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
@@ -27,7 +32,7 @@ echo ">>> Compiling firmware…"
 docker run --rm \
     -v "${SCRIPT_DIR}/MobicoolFR34.X:/src" \
     "${IMAGE}" \
-    make
+    make ${XTAL_FREQ:+XTAL_FREQ=${XTAL_FREQ}} ${FEATURES:+"FEATURES=${FEATURES}"}
 
 # ── 3. Report result ──────────────────────────────────────────────────────────
 HEX="${SCRIPT_DIR}/MobicoolFR34.X/dist/default/production/MobicoolFR34.X.production.hex"
@@ -10,6 +10,9 @@ void CommsMaster::begin(int pin, uint32_t baud) {
     // automatically enables half-duplex single-wire mode (open-drain).
     // ESP32-C3 only has UART0 (Serial) and UART1 (Serial1); Serial1 is used here.
     Serial1.begin(baud, SERIAL_8N1, pin, pin);
+    _baud = baud;
+    _stepProfile = 0;   // a reset PIC is back at 9600
+    _holding = false;
 
     // Explicitly enable the internal pullup (~45kΩ) on this pin using ESP-IDF.
     // We use gpio_pullup_en() instead of pinMode() because pinMode() would
@@ -19,35 +22,149 @@ void CommsMaster::begin(int pin, uint32_t baud) {
     // Flush any power-on noise from the wire
     delay(5);
     while (Serial1.available()) Serial1.read();
+
+    negotiate();
 }
 
-// ── CRC8: XOR of all bytes (must match PIC comms.c) ──────────────────────
+// ── CRC8: XOR of all bytes (v1, must match PIC comms.c) ─────────────────
 uint8_t CommsMaster::crc8(const uint8_t* buf, uint8_t len) {
     uint8_t crc = 0;
     while (len--) crc ^= *buf++;
     return crc;
 }
 
+// ── CRC-8 polynomial 0x07 (v2, must match PIC crc8.c) ────────────────────
+uint8_t CommsMaster::crc8v2(const uint8_t* buf, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *buf++;
+        for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+bool CommsMaster::negotiate() {
+    _v2 = true;
+    uint8_t resp[3];
+    if (!transact(COMMS_CMD_VERSION, nullptr, 0, resp, 3) || resp[0] < 2) _v2 = false;
+    if (_v2 && _baud == 9600) stepUp();
+    return _v2;
+}
+
+// ── Link speed ────────────────────────────────────────────────────────────
+static const uint32_t kBauds[COMMS_BAUD_COUNT] = { 9600, 19200, 38400, 57600 };
+#define BAUD_VERIFY_POLLS 5
+
+void CommsMaster::setBaud(uint32_t baud) {
+    Serial1.updateBaudRate(baud);
+    _baud = baud;
+    while (Serial1.available()) Serial1.read();
+}
+
+bool CommsMaster::stepUp() {
+    uint8_t mask;
+    if (!transact(COMMS_CMD_SET_BAUD, nullptr, 0, &mask, 1)) return false;  // older PIC firmware
+    _stepMask = mask;
+    _stepProfile = COMMS_BAUD_COUNT - 1;
+    return tryStep();
+}
+
+bool CommsMaster::tryStep() {
+    while (_stepProfile > 0) {
+        uint8_t profile = _stepProfile--;
+        if (!(_stepMask & (1 << profile))) continue;
+
+        // The PIC ACKs at 9600 and switches after the ACK's stop bit.  With
+        // no answer it may or may not have switched; the fallback sorts it.
+        uint8_t ack;
+        bool acked = transact(COMMS_CMD_SET_BAUD, &profile, 1, &ack, 1) && ack == COMMS_ACK;
+        if (acked) {
+            setBaud(kBauds[profile]);
+            bool good = true;
+            uint8_t resp[3];
+            for (uint8_t i = 0; i < BAUD_VERIFY_POLLS && good; i++) {
+                good = transact(COMMS_CMD_VERSION, nullptr, 0, resp, 3);
+            }
+            if (good) {
+                _stepProfile = 0;
+                _failures = 0;
+                return true;
+            }
+            setBaud(9600);
+        }
+
+        // Until the PIC is back at 9600; service() carries on from there
+        _holding = true;
+        _holdUntil = millis() + COMMS_BAUD_FALLBACK_MS + 200;
+        return false;
+    }
+    return false;
+}
+
+void CommsMaster::service() {
+    if (_holding && (int32_t)(millis() - _holdUntil) >= 0) _holding = false;
+    if (!_holding && _stepProfile > 0) tryStep();
+}
+
+bool CommsMaster::readByte(uint8_t* b, uint32_t timeoutMs) {
+    uint32_t start = millis();
+    while (!Serial1.available()) {
+        if (millis() - start > timeoutMs) return false;
+    }
+    *b = Serial1.read();
+    return true;
+}
+
 // ── Full request/response transaction ────────────────────────────────────
-// Request frame:  [SYNC=0xAA] [cmd] [len] [payload×len] [crc8]
-// Response frame: [len] [payload×len] [crc8]
 bool CommsMaster::transact(uint8_t cmd,
                             const uint8_t* txPayload, uint8_t txLen,
-                            uint8_t* rxPayload,       uint8_t expectedRxLen)
+                            uint8_t* rxPayload,       uint8_t expectedRxLen,
+                            uint8_t* rxLen)
+{
+    if (_pin < 0 || _holding) return false;
+    if (!_v2) return exchange(0, cmd, txPayload, txLen, rxPayload, expectedRxLen, rxLen);
+
+    uint8_t seq = ++_seq;
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        if (exchange(seq, cmd, txPayload, txLen, rxPayload, expectedRxLen, rxLen)) {
+            _failures = 0;
+            return true;
+        }
+    }
+
+    // A PIC that reset, or gave up on a faster link, is listening at 9600
+    if (_baud != 9600 && ++_failures >= 3) {
+        setBaud(9600);
+        _failures = 0;
+        _dropped = true;
+    }
+    return false;
+}
+
+// v1 request:  [SYNC=0xAA] [cmd] [len] [payload×len] [xor]
+// v1 response: [len] [payload×len] [xor]
+// v2 request:  [SYNC=0xA5] [seq] [cmd] [len] [payload×len] [crc8]
+// v2 response: [SYNC=0xA5] [seq] [flags] [len] [payload×len] [crc8]
+bool CommsMaster::exchange(uint8_t seq, uint8_t cmd,
+                            const uint8_t* txPayload, uint8_t txLen,
+                            uint8_t* rxPayload,       uint8_t expectedRxLen,
+                            uint8_t* rxLen)
 {
-    if (_pin < 0) return false;
+    if (txLen > (_v2 ? COMMS_MAX_PAYLOAD : COMMS_V1_MAX_PAYLOAD)) return false;
 
     // 1. Flush any stale bytes that may have arrived unexpectedly
     while (Serial1.available()) Serial1.read();
 
     // 2. Build the request frame
-    uint8_t reqLen = 4 + txLen;
-    uint8_t frame[16];
-    frame[0] = COMMS_SYNC;
-    frame[1] = cmd;
-    frame[2] = txLen;
-    for (uint8_t i = 0; i < txLen; i++) frame[3 + i] = txPayload[i];
-    frame[3 + txLen] = crc8(frame, 3 + txLen);
+    uint8_t frame[5 + COMMS_MAX_PAYLOAD];
+    uint8_t n = 0;
+    frame[n++] = _v2 ? COMMS_SYNC_V2 : COMMS_SYNC;
+    if (_v2) frame[n++] = seq;
+    frame[n++] = cmd;
+    frame[n++] = txLen;
+    for (uint8_t i = 0; i < txLen; i++) frame[n++] = txPayload[i];
+    frame[n] = _v2 ? crc8v2(frame, n) : crc8(frame, n);
+    uint8_t reqLen = n + 1;
 
     // 3. Transmit (zero CPU blocking thanks to hardware UART)
     Serial1.write(frame, reqLen);
@@ -65,51 +182,91 @@ bool CommsMaster::transact(uint8_t cmd,
         if (millis() - start > 100) return false; // Timeout reading our own echo
     }
 
-    // 5. Receive the PIC's response length (with a slightly longer 200ms turnaround timeout)
-    start = millis();
-    while (!Serial1.available()) {
-        if (millis() - start > 200) return false; 
-    }
-    uint8_t respLen = Serial1.read();
-    
-    if (respLen != expectedRxLen) return false;
-
-    // 6. Receive the response payload
-    uint8_t respPayload[11]; // large enough for GET_TELEMETRY (11 bytes)
-    for (uint8_t i = 0; i < respLen; i++) {
-        start = millis();
-        while (!Serial1.available()) {
-            if (millis() - start > 50) return false;
-        }
-        respPayload[i] = Serial1.read();
+    // 5. Receive the response header (with a slightly longer 200ms turnaround timeout)
+    uint8_t head[4];
+    uint8_t headLen = _v2 ? 4 : 1;
+    for (uint8_t i = 0; i < headLen; i++) {
+        if (!readByte(&head[i], i ? 50 : 200)) return false;
     }
+    uint8_t respLen = head[headLen - 1];
+    if (_v2 && (head[0] != COMMS_SYNC_V2 || head[1] != seq)) return false;
+    if (_v2) _eventsPending = head[2] & COMMS_FLAG_EVENT;
+    if (rxLen ? respLen > expectedRxLen : respLen != expectedRxLen) return false;
+    if (respLen > COMMS_MAX_RESPONSE) return false;
 
-    // 7. Receive response CRC
-    start = millis();
-    while (!Serial1.available()) {
-        if (millis() - start > 50) return false;
+    // 6. Receive the response payload and CRC
+    uint8_t resp[4 + COMMS_MAX_RESPONSE + 1];
+    memcpy(resp, head, headLen);
+    for (uint8_t i = 0; i <= respLen; i++) {
+        if (!readByte(&resp[headLen + i], 50)) return false;
     }
-    uint8_t rxCrc = Serial1.read();
 
-    // 8. Validate CRC: XOR of [LEN] + [PAYLOAD...]
-    uint8_t crc_buf[11];
-    crc_buf[0] = respLen;
-    for (uint8_t i = 0; i < respLen; i++) crc_buf[1 + i] = respPayload[i];
-    if (crc8(crc_buf, 1 + respLen) != rxCrc) return false;
+    // 7. Validate the CRC over everything before it
+    uint8_t crcLen = headLen + respLen;
+    uint8_t crc = _v2 ? crc8v2(resp, crcLen) : crc8(resp, crcLen);
+    if (crc != resp[crcLen]) return false;
 
-    // 9. Deliver payload to caller
-    if (rxPayload) {
-        for (uint8_t i = 0; i < respLen; i++) rxPayload[i] = respPayload[i];
-    }
+    // 8. Deliver payload to caller
+    if (rxPayload) memcpy(rxPayload, &resp[headLen], respLen);
+    if (rxLen) *rxLen = respLen;
     return true;
 }
 
 // ── Public commands ───────────────────────────────────────────────────────
 bool CommsMaster::readAll(CoolerState& state) {
     state.valid = false;
+    _deltaAck = 0;  // state no longer matches any delta snapshot
     uint8_t resp[11];
     if (!transact(COMMS_CMD_GET, nullptr, 0, resp, 11)) return false;
+    parseTelemetry(resp, state);
+    return true;
+}
+
+bool CommsMaster::readDelta(CoolerState& state) {
+    if (_noDelta || !_v2) return readAll(state);  // v1 firmware ignores unknown commands
+
+    // Deadbands ride along with every full-snapshot request, so a PIC that
+    // reset is set up again without a separate step
+    uint8_t req[4] = { state.valid ? _deltaAck : (uint8_t)0, DELTA_TEMP_DB, DELTA_VOLT_DB, DELTA_FAN_DB };
+    uint8_t reqLen = req[0] ? 1 : 4;
+    uint8_t resp[2 + 11];
+    uint8_t len;
+    if (!transact(COMMS_CMD_GET_DELTA, req, reqLen, resp, sizeof(resp), &len)) {
+        state.valid = false;
+        _deltaAck = 0;
+        return false;
+    }
+    if (len == 1 && resp[0] == COMMS_NAK) {  // older PIC firmware
+        _noDelta = true;
+        return readAll(state);
+    }
+
+    // Expand the flagged fields into a full GET payload over the old values
+    static const uint8_t fieldAt[8] = { 0, 2, 4, 6, 8, 9, 10, 11 };
+    uint8_t full[11];
+    full[0]  = (uint8_t)state.currentTemp10;    full[1] = (uint8_t)((uint16_t)state.currentTemp10 >> 8);
+    full[2]  = (uint8_t)state.targetTemp10;     full[3] = (uint8_t)((uint16_t)state.targetTemp10 >> 8);
+    full[4]  = (uint8_t)state.voltageMilliV;    full[5] = (uint8_t)(state.voltageMilliV >> 8);
+    full[6]  = (uint8_t)state.fanCurrentMilliA; full[7] = (uint8_t)(state.fanCurrentMilliA >> 8);
+    full[8]  = state.compPower;
+    full[9]  = state.compPowerMax;
+    full[10] = state.pmode;
+    uint8_t map = resp[1];
+    uint8_t n = 2;
+    for (uint8_t f = 0; f < 7; f++) {
+        if (!(map & (1 << f))) continue;
+        for (uint8_t at = fieldAt[f]; at < fieldAt[f + 1]; at++) {
+            if (n >= len) { state.valid = false; _deltaAck = 0; return false; }
+            full[at] = resp[n++];
+        }
+    }
+    if (!state.valid && map != 0x7F) { _deltaAck = 0; return false; }
+    parseTelemetry(full, state);
+    _deltaAck = resp[0];
+    return true;
+}
 
+void CommsMaster::parseTelemetry(const uint8_t* resp, CoolerState& state) {
     state.currentTemp10    = (int16_t)((uint16_t)resp[0] | ((uint16_t)resp[1] << 8));
     state.targetTemp10     = (int16_t)((uint16_t)resp[2] | ((uint16_t)resp[3] << 8));
     state.voltageMilliV    = (uint16_t)resp[4] | ((uint16_t)resp[5] << 8);
@@ -118,6 +275,76 @@ bool CommsMaster::readAll(CoolerState& state) {
     state.compPowerMax     = resp[9];
     state.pmode            = resp[10];
     state.valid            = true;
+}
+
+bool CommsMaster::applySettings(const SettingItem* items, uint8_t count, CoolerState& state) {
+    if (!_v2) {
+        // PMAX first: the PIC refuses a POWER above the PMAX it has
+        bool ok = true;
+        for (uint8_t pass = 0; pass < 2; pass++) {
+            for (uint8_t i = 0; i < count; i++) {
+                const SettingItem& it = items[i];
+                if ((it.tag == COMMS_CMD_SET_PMAX) != (pass == 0)) continue;
+                switch (it.tag) {
+                    case COMMS_CMD_SET_TEMP:  ok &= setTargetTemp(it.value);             break;
+                    case COMMS_CMD_SET_POWER: ok &= setCompPower((uint8_t)it.value);     break;
+                    case COMMS_CMD_SET_PMAX:  ok &= setCompPowerMax((uint8_t)it.value);  break;
+                    case COMMS_CMD_SET_PMODE: ok &= setPowerMode((uint8_t)it.value);     break;
+                    default:                  ok = false;                                break;
+                }
+            }
+        }
+        return readAll(state) && ok;
+    }
+
+    uint8_t tlv[COMMS_MAX_PAYLOAD];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const SettingItem& it = items[i];
+        uint8_t size = it.tag == COMMS_CMD_SET_TEMP ? 2 : 1;
+        if (n + 2 + size > sizeof(tlv)) return false;
+        tlv[n++] = it.tag;
+        tlv[n++] = size;
+        tlv[n++] = (uint8_t)it.value;
+        if (size == 2) tlv[n++] = (uint8_t)((uint16_t)it.value >> 8);
+    }
+    uint8_t resp[11];
+    _deltaAck = 0;  // state no longer matches any delta snapshot
+    if (!transact(COMMS_CMD_SET, tlv, n, resp, 11)) return false;
+    parseTelemetry(resp, state);
+    return true;
+}
+
+static uint32_t le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool CommsMaster::readEnergy(CoolerState& state) {
+    state.energyValid = false;
+    uint8_t resp[16];
+    if (!transact(COMMS_CMD_GET_ENERGY, nullptr, 0, resp, 16)) return false;
+
+    state.compWh      = le32(&resp[0]);
+    state.totalWh     = le32(&resp[4]);
+    state.runSeconds  = le32(&resp[8]);
+    state.starts      = le32(&resp[12]);
+    state.energyValid = true;
+    return true;
+}
+
+bool CommsMaster::readCycles(CoolerState& state) {
+    state.cyclesValid = false;
+    uint8_t resp[CYCLES_STATUS_SIZE];
+    if (!transact(COMMS_CMD_GET_CYCLES, nullptr, 0, resp, CYCLES_STATUS_SIZE)) return false;
+
+    state.lastOnS         = (uint16_t)(resp[0] | (resp[1] << 8));
+    state.lastOffS        = (uint16_t)(resp[2] | (resp[3] << 8));
+    state.startsPerHour   = resp[7];
+    state.targetPerHour   = resp[8];
+    state.restartOffset10 = resp[9];
+    state.speedTrim       = resp[10];
+    state.undershoot10    = resp[11];
+    state.cyclesValid     = true;
     return true;
 }
 
@@ -148,3 +375,80 @@ bool CommsMaster::setPowerMode(uint8_t mode) {
     if (!transact(COMMS_CMD_SET_PMODE, &mode, 1, resp, 1)) return false;
     return resp[0] == COMMS_ACK;
 }
+
+static uint16_t le16(const uint8_t* p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+static void parseStat(const uint8_t* p, PerfStat& stat) {
+    stat.lastUs = le16(&p[0]);
+    stat.minUs  = le16(&p[2]);
+    stat.avgUs  = le16(&p[4]);
+    stat.maxUs  = le16(&p[6]);
+}
+
+bool CommsMaster::readPerf(CoolerPerf& perf) {
+    perf.valid = false;
+    uint8_t page = COMMS_PERF_LOOP;
+    uint8_t resp[COMMS_MAX_RESPONSE];
+
+    if (!transact(COMMS_CMD_GET_PERF, &page, 1, resp, 10)) return false;
+    perf.numTasks  = resp[0];
+    perf.numProbes = resp[1];
+    parseStat(&resp[2], perf.loop);
+    perf.loop.misses = 0;
+
+    page = COMMS_PERF_HIST;
+    if (!transact(COMMS_CMD_GET_PERF, &page, 1, resp, 2 * PERF_HIST_BUCKETS)) return false;
+    for (uint8_t i = 0; i < PERF_HIST_BUCKETS; i++) perf.hist[i] = le16(&resp[2 * i]);
+
+    uint8_t stages = perf.numTasks + perf.numProbes;
+    if (stages > PERF_MAX_STAGES) stages = PERF_MAX_STAGES;
+    for (uint8_t i = 0; i < stages; i++) {
+        page = COMMS_PERF_TASKS + i;
+        if (!transact(COMMS_CMD_GET_PERF, &page, 1, resp, 9)) return false;
+        parseStat(resp, perf.stages[i]);
+        perf.stages[i].misses = resp[8];
+    }
+    perf.valid = true;
+    return true;
+}
+
+bool CommsMaster::readHistoryPage(uint8_t page, HistoryPage& out) {
+    uint8_t resp[3 + HISTORY_PAGE_ENTRIES * HISTORY_ENTRY_SIZE];
+    if (!transact(COMMS_CMD_GET_HISTORY, &page, 1, resp, sizeof(resp))) return false;
+
+    out.newest = le16(&resp[0]);
+    out.held   = resp[2];
+    out.count  = 0;
+    for (uint8_t i = 0; i < HISTORY_PAGE_ENTRIES; i++) {
+        uint8_t back = page * HISTORY_PAGE_ENTRIES + i;
+        if (back >= out.held) break;
+        const uint8_t* e = &resp[3 + i * HISTORY_ENTRY_SIZE];
+        HistoryEntry& h = out.entries[out.count++];
+        h.number   = out.newest - back;
+        h.tempAvg2 = (int8_t)e[0];
+        h.tempMin2 = (int8_t)(h.tempAvg2 - (e[1] & 0x0F));
+        h.tempMax2 = (int8_t)(h.tempAvg2 + (e[1] >> 4));
+        h.duty     = e[2];
+        h.powerW   = e[3];
+        h.voltage5 = e[4];
+    }
+    return true;
+}
+
+bool CommsMaster::readEvents(CoolerEvent* out, uint8_t& count, uint8_t& lost) {
+    count = lost = 0;
+    if (!_v2) return false;
+    uint8_t resp[2 + 2 * EVENTS_PER_RESPONSE];
+    uint8_t len;
+    if (!transact(COMMS_CMD_GET_EVENTS, nullptr, 0, resp, sizeof(resp), &len) || len < 2) return false;
+
+    lost = resp[1];
+    for (uint8_t i = 2; i + 1 < len; i += 2) {
+        out[count].type = resp[i];
+        out[count].arg  = resp[i + 1];
+        count++;
+    }
+    return true;
+}
@@ -3,14 +3,39 @@
 
 // ── Protocol constants (must match PIC comms.h) ───────────────────────────
 #define COMMS_SYNC          0xAA
+#define COMMS_SYNC_V2       0xA5
 #define COMMS_ACK           0x06
 #define COMMS_NAK           0x15
 
+#define COMMS_V1_MAX_PAYLOAD 4
+#define COMMS_MAX_PAYLOAD   32    // v2 request payload
+
+#define COMMS_FLAG_ERR      0x01  // v2 response FLAGS: request rejected
+#define COMMS_FLAG_DUP      0x02  // v2 response FLAGS: answer to a retried SEQ
+#define COMMS_FLAG_EVENT    0x04  // v2 response FLAGS: events queued, fetch with GET_EVENTS
+
 #define COMMS_CMD_GET       0x01
 #define COMMS_CMD_SET_TEMP  0x02
 #define COMMS_CMD_SET_POWER 0x03
 #define COMMS_CMD_SET_PMAX  0x04
 #define COMMS_CMD_SET_PMODE 0x05
+#define COMMS_CMD_GET_PERF  0x06
+#define COMMS_CMD_GET_ENERGY 0x07
+#define COMMS_CMD_GET_HISTORY 0x08
+#define COMMS_CMD_VERSION   0x09
+#define COMMS_CMD_SET       0x0A  // v2: TLV items, tag = single-setting command
+#define COMMS_CMD_SET_BAUD  0x0B  // no payload: profile mask; uint8 profile: ACK, then switch
+#define COMMS_CMD_GET_DELTA 0x0C  // [ack] [deadbands×3]: GET fields changed since snapshot ack
+#define COMMS_CMD_GET_EVENTS 0x0D // v2: [still queued] [lost] [type arg]×n, oldest first
+#define COMMS_CMD_EFFMAP    0x0E  // uint8 op: 0 status, 1 start sweep, 2 abort, 3 map, 4 clear
+#define COMMS_CMD_GET_CYCLES 0x0F // compressor on/off cycle statistics
+
+// Link speed profiles, bit n of the SET_BAUD mask.  The PIC drops back to
+// 9600 after COMMS_BAUD_FALLBACK_MS without a valid frame.
+#define COMMS_BAUD_COUNT    4
+#define COMMS_BAUD_FALLBACK_MS 3000
+
+#define COMMS_MAX_RESPONSE  COMMS_MAX_PAYLOAD  // longest response payload
 
 // GET response layout (11 payload bytes, little-endian signed/unsigned)
 //   [0-1] current temp  int16  tenths °C
@@ -21,6 +46,63 @@
 //   [9]   comp pmax     uint8  0-100 %
 //  [10]   pmode         uint8  0=Eco 1=Normal 2=Hi
 
+// GET_DELTA (see PIC comms.h)
+//   request  [0] ID of the last delta applied, 0 for everything
+//            [1-3] deadbands: temp 0.1 °C, voltage 10 mV, fan current 10 mA
+//   response [0] ID (never 0) [1] bitmap, bit n = GET field n in the order
+//            above, [2..] the flagged fields in their GET encoding
+#define DELTA_TEMP_DB       2     // 0.2 °C
+#define DELTA_VOLT_DB       5     // 50 mV
+#define DELTA_FAN_DB        2     // 20 mA
+
+// Event types (GET_EVENTS, PIC events.h)
+#define EVENT_SETPOINT      1     // set on the keypad, arg = whole °C (int8)
+#define EVENT_POWER         2     // switched on the keypad, arg 1 = on
+#define EVENT_BATTLOW       3     // battery cut-out, arg 1 = tripped, 0 = cleared
+#define EVENT_COMPRESSOR    4     // arg 0 lockout, 1 off, 2 starting, 3 running
+#define EVENT_KEYS          5     // keys went down, arg = bitmap (0 -, 1 +, 2 SET, 3 ON/OFF)
+#define EVENT_MOTOR         6     // IRMCF183 link, arg 0 OK, 1 no replies, 2 garbled replies
+#define EVENT_SUPPLY_R      7     // supply resistance estimate moved, arg = 10 mOhm
+#define EVENTS_PER_RESPONSE ((COMMS_MAX_RESPONSE - 2) / 2)
+
+// GET_ENERGY response layout (16 payload bytes, uint32 little-endian)
+//   [0-3] compressor Wh  [4-7] total Wh (compressor + fan)
+//   [8-11] compressor run time s  [12-15] compressor starts
+
+// GET_CYCLES response layout (12 payload bytes, little-endian)
+//   [0-1] last on-cycle s  [2-3] last off-cycle s  [4-5] current cycle so far s
+//   [6] bit 0 running, bit 1 counts towards the rate  [7] starts in the last hour
+//   [8] target starts per hour  [9] restart offset 0.1 °C  [10] speed trim
+//   [11] undershoot below the setpoint 0.1 °C
+#define CYCLES_STATUS_SIZE  12
+
+// GET_HISTORY pages (payload: uint8 page; 28 payload bytes, NAK past the end)
+//   [0-1]  number of the newest entry, uint16 LE (entries recorded since PIC reset)
+//   [2]    entries held by the PIC, up to 48 (4 hours)
+//   [3-27] 5 entries from entry page × 5 back from the newest, older ones next:
+//          temp avg (int8 0.5 °C), temp span (max above avg in bits 7-4, min
+//          below in bits 3-0, 0.5 °C), duty (%), power (W), voltage (0.2 V)
+#define HISTORY_PAGE_ENTRIES 5
+#define HISTORY_ENTRY_SIZE   5
+#define HISTORY_PERIOD_S     300
+
+// GET_PERF pages (payload: uint8 page; times in µs, little-endian)
+//   page 0   loop summary (10): [0] task count [1] probe count
+//                               [2-9] busy time per scheduler pass: last, min, avg, max
+//   page 1   loop histogram (16): 8 × uint16 pass counts, bucket n < 256 << n µs
+//   page 2.. tasks in table order, then probes (9): [0-7] last, min, avg, max [8] misses
+#define COMMS_PERF_LOOP     0
+#define COMMS_PERF_HIST     1
+#define COMMS_PERF_TASKS    2
+#define PERF_HIST_BUCKETS   8
+#define PERF_MAX_STAGES     8
+
+// Frames (see PIC comms.h)
+//   v1 request  [0xAA] [CMD] [LEN] [PAYLOAD] [XOR]
+//   v1 response [LEN] [PAYLOAD] [XOR]
+//   v2 request  [0xA5] [SEQ] [CMD] [LEN] [PAYLOAD] [CRC-8 0x07]
+//   v2 response [0xA5] [SEQ] [FLAGS] [LEN] [PAYLOAD] [CRC-8 0x07]
+
 // ── State snapshot ────────────────────────────────────────────────────────
 struct CoolerState {
     int16_t  currentTemp10;    // tenths of °C  (e.g.  123 = 12.3 °C)
@@ -31,6 +113,71 @@ struct CoolerState {
     uint8_t  compPowerMax;     // 0-100 % hard cap
     uint8_t  pmode;            // 0=Eco 1=Normal 2=Hi
     bool     valid;            // true if last poll succeeded
+
+    // Energy counters, refreshed by readEnergy() on their own slower cadence
+    uint32_t compWh;           // compressor energy
+    uint32_t totalWh;          // compressor + fan energy
+    uint32_t runSeconds;       // compressor run time
+    uint32_t starts;           // compressor starts
+    bool     energyValid;
+
+    // Compressor cycling, refreshed by readCycles() along with the energy
+    uint16_t lastOnS;          // last complete on-cycle
+    uint16_t lastOffS;         // last complete off-cycle
+    uint8_t  startsPerHour;    // starts in the last hour
+    uint8_t  targetPerHour;    // what the PIC adapts towards
+    uint8_t  restartOffset10;  // tenths of °C above the setpoint
+    uint8_t  speedTrim;        // speed steps taken off the run ceiling
+    uint8_t  undershoot10;     // tenths of °C runs go on below the setpoint
+    bool     cyclesValid;
+};
+
+// ── Firmware timing snapshot ──────────────────────────────────────────────
+struct PerfStat {
+    uint16_t lastUs;
+    uint16_t minUs;
+    uint16_t avgUs;
+    uint16_t maxUs;
+    uint8_t  misses;           // deadline misses (tasks only)
+};
+
+struct CoolerPerf {
+    uint8_t  numTasks;
+    uint8_t  numProbes;
+    PerfStat loop;                      // busy time per scheduler tick
+    uint16_t hist[PERF_HIST_BUCKETS];   // loop busy-time histogram
+    PerfStat stages[PERF_MAX_STAGES];   // tasks, then probes
+    bool     valid;
+};
+
+// ── Telemetry history ─────────────────────────────────────────────────────
+// One entry per HISTORY_PERIOD_S, aggregated by the PIC
+struct HistoryEntry {
+    uint16_t number;           // PIC entry number, consecutive entries differ by 1
+    int8_t   tempMin2;         // half °C
+    int8_t   tempAvg2;
+    int8_t   tempMax2;
+    uint8_t  duty;             // compressor on, % of the period
+    uint8_t  powerW;           // compressor power averaged over the period
+    uint8_t  voltage5;         // fifths of a volt
+};
+
+struct HistoryPage {
+    uint16_t     newest;       // number of the newest entry the PIC holds
+    uint8_t      held;         // entries the PIC holds
+    uint8_t      count;        // entries on this page, newest first
+    HistoryEntry entries[HISTORY_PAGE_ENTRIES];
+};
+
+struct CoolerEvent {
+    uint8_t type;              // EVENT_*
+    uint8_t arg;
+};
+
+// One item of a batched settings write; tag is the single-setting command
+struct SettingItem {
+    uint8_t tag;               // COMMS_CMD_SET_TEMP, _SET_POWER, _SET_PMAX, _SET_PMODE
+    int16_t value;             // tenths of °C for the setpoint, else 0-100 / pmode
 };
 
 // ── Single-wire half-duplex master ────────────────────────────────────────
@@ -42,31 +189,106 @@ class CommsMaster {
 public:
     // pin  : GPIO wired to PIC RA0/ICSPDAT (PIC pin 19, J2 header)
     // baud : must match PIC firmware (default 9600)
+    // Asks the PIC for protocol v2 and stays on v1 if it does not answer.
     void begin(int pin, uint32_t baud = 9600);
 
+    // Try v2 again, e.g. after the PIC has been reflashed, then step the link
+    // up to the fastest speed both ends manage; true if v2 is in use
+    bool negotiate();
+    bool isV2() const { return _v2; }
+    uint32_t baud() const { return _baud; }
+
+    // Call from loop().  After a speed profile fails, the PIC needs
+    // COMMS_BAUD_FALLBACK_MS to drop back to 9600; meanwhile busy() is true,
+    // requests fail at once, and service() tries the next slower profile
+    // once the wait is over, without holding up the caller.
+    void service();
+    bool busy() const { return _holding || _stepProfile > 0; }
+
+    // True once after a faster link stopped answering and was dropped back
+    // to 9600; negotiate() again to step up once the PIC talks again
+    bool linkDropped() { bool d = _dropped; _dropped = false; return d; }
+
     // Read all telemetry in one shot; returns true on success.
     bool readAll(CoolerState& state);
 
+    // Update state with the telemetry fields that changed since the last
+    // call (GET_DELTA); falls back to readAll() on v1 links and on PIC
+    // firmware without it.
+    bool readDelta(CoolerState& state);
+
+    // Fill the energy fields of state (GET_ENERGY)
+    bool readEnergy(CoolerState& state);
+
+    // Fill the cycle fields of state (GET_CYCLES)
+    bool readCycles(CoolerState& state);
+
+    // Apply several settings at once and refresh state from the same answer.
+    // v2: one atomic SET transaction.  v1: one command each, then readAll().
+    bool applySettings(const SettingItem* items, uint8_t count, CoolerState& state);
+
     // Write commands; return true on ACK from PIC.
     bool setTargetTemp(int16_t temp10);      // tenths of °C
     bool setCompPower(uint8_t power);        // 0-100 %
     bool setCompPowerMax(uint8_t powerMax);  // 0-100 %
     bool setPowerMode(uint8_t mode);         // 0=Eco 1=Normal 2=Hi
 
+    // Read every GET_PERF page; returns true if all of them arrived.
+    bool readPerf(CoolerPerf& perf);
+
+    // Read one GET_HISTORY page; false past the oldest entry or on error.
+    bool readHistoryPage(uint8_t page, HistoryPage& out);
+
+    // The last v2 response said events are waiting on the PIC
+    bool eventsPending() const { return _eventsPending; }
+
+    // Fetch up to EVENTS_PER_RESPONSE queued events, oldest first; lost
+    // counts those the PIC had to drop.  Call again while eventsPending().
+    bool readEvents(CoolerEvent* out, uint8_t& count, uint8_t& lost);
+
 private:
     int      _pin    = -1;
     uint32_t _bitUs  = 104;  // µs per bit at 9600 baud
+    uint32_t _baud   = 9600;
+    bool     _v2     = false;
+    bool     _dropped = false;
+    uint8_t  _seq    = 0;
+    uint8_t  _failures = 0;  // transactions in a row without an answer
+    uint8_t  _deltaAck = 0;  // ID of the delta state holds, 0 for none
+    bool     _noDelta  = false;
+    bool     _eventsPending = false;
+    uint8_t  _stepMask = 0;      // SET_BAUD mask of the PIC
+    uint8_t  _stepProfile = 0;   // next profile to try, 0 = not stepping
+    bool     _holding = false;   // waiting out the PIC's fallback to 9600
+    uint32_t _holdUntil = 0;
+
+    // Switch to the fastest profile in the PIC's mask that passes a few
+    // polls; false if the link is still at 9600, which it may leave later
+    // through service()
+    bool stepUp();
+    bool tryStep();     // next profile from _stepProfile down
+    void setBaud(uint32_t baud);
 
     // Low-level open-drain bit-bang
     void     txByte(uint8_t data);
     bool     rxByte(uint8_t* data, uint32_t timeoutUs);
 
-    // Frame send/receive
-    // request:  [SYNC] [cmd] [len] [payload...] [crc8]
-    // response: [len] [payload...] [crc8]
+    // Frame send/receive in the negotiated version.  v2 requests that get no
+    // valid answer are sent once more with the same SEQ, which the PIC
+    // recognises and answers without applying the command twice.
+    // With rxLen given, expectedRxLen is the longest answer accepted and
+    // rxLen returns the actual length.
     bool transact(uint8_t cmd,
                   const uint8_t* txPayload, uint8_t txLen,
-                  uint8_t* rxPayload,       uint8_t expectedRxLen);
+                  uint8_t* rxPayload,       uint8_t expectedRxLen,
+                  uint8_t* rxLen = nullptr);
+    bool exchange(uint8_t seq, uint8_t cmd,
+                  const uint8_t* txPayload, uint8_t txLen,
+                  uint8_t* rxPayload,       uint8_t expectedRxLen,
+                  uint8_t* rxLen);
+    bool readByte(uint8_t* b, uint32_t timeoutMs);
 
-    static uint8_t crc8(const uint8_t* buf, uint8_t len);
+    static uint8_t crc8(const uint8_t* buf, uint8_t len);    // v1 XOR
+    static uint8_t crc8v2(const uint8_t* buf, uint8_t len);  // polynomial 0x07
+    static void    parseTelemetry(const uint8_t* resp, CoolerState& state);
 };
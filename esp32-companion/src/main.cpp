@@ -51,13 +51,66 @@ static constexpr int      ICSP_CLK_PIN    = 6;    // new wire → J2 pin 5 (ICSP
 static constexpr int      ICSP_MCLR_PIN   = 5;    // new wire → J2 pin 1 (MCLR/VPP), open-drain
 static constexpr uint32_t COMMS_BAUD      = 9600;
 static constexpr uint32_t POLL_MS         = 1000;
+static constexpr uint32_t PERF_POLL_MS    = 10000;
+static constexpr uint32_t ENERGY_POLL_MS  = 10000;
+static constexpr uint32_t HISTORY_POLL_MS = HISTORY_PERIOD_S * 1000UL;
+static constexpr uint16_t HISTORY_KEEP    = 12 * 3600 / HISTORY_PERIOD_S;  // entries kept here, 12 h
 
 // ── Common globals ─────────────────────────────────────────────────────────
 CommsMaster  comms;
 CoolerState  coolerState;
+CoolerPerf   coolerPerf;
 PicProgrammer picProg;
 static uint32_t lastPoll     = 0;
+static uint32_t lastPerfPoll = 0;
+static uint32_t lastEnergyPoll = 0;
+static uint32_t lastHistoryPoll = 0;
 static bool     flashBusy    = false;
+static bool     protocolChecked = false; // negotiated again after the first good poll
+
+// History backfilled from the PIC, oldest first in a ring
+static HistoryEntry history[HISTORY_KEEP];
+static uint16_t historyHead  = 0;       // slot of the oldest entry
+static uint16_t historyCount = 0;
+static bool     historySynced = false;  // lastHistoryNumber is valid
+static uint16_t lastHistoryNumber = 0;  // newest entry stored
+
+// ── History backfill ───────────────────────────────────────────────────────
+static void historyStore(const HistoryEntry& e) {
+    if (historyCount < HISTORY_KEEP) {
+        history[(historyHead + historyCount++) % HISTORY_KEEP] = e;
+    } else {
+        history[historyHead] = e;
+        historyHead = (historyHead + 1) % HISTORY_KEEP;
+    }
+    lastHistoryNumber = e.number;
+    historySynced = true;
+}
+
+// Fetch whatever the PIC recorded since the last sync: one round trip when
+// nothing is missing, up to held / HISTORY_PAGE_ENTRIES after an outage.
+static void historySync() {
+    HistoryPage page;
+    if (!comms.readHistoryPage(0, page) || page.held == 0) return;
+
+    uint16_t missing = page.newest - lastHistoryNumber;
+    // First sync, or the PIC restarted and its numbering with it
+    if (!historySynced || missing > page.held) missing = page.held;
+    if (missing == 0) return;
+
+    static constexpr uint16_t FETCH_MAX = 128;
+    HistoryEntry fetched[FETCH_MAX];
+    if (missing > FETCH_MAX) missing = FETCH_MAX;
+    uint16_t n = 0;
+    for (uint8_t p = 0; n < missing; ) {
+        for (uint8_t i = 0; i < page.count && n < missing; i++) fetched[n++] = page.entries[i];
+        if (n == missing || page.count < HISTORY_PAGE_ENTRIES) break;
+        if (!comms.readHistoryPage(++p, page)) return;      // try again next time
+        if (page.newest != fetched[0].number) return;       // a new entry landed meanwhile
+    }
+    Serial.printf("[FR34] History: %u new entries, newest #%u\n", n, fetched[0].number);
+    while (n) historyStore(fetched[--n]);
+}
 
 // ══════════════════════════════════════════════════════════════════════════════
 // WiFi transport
@@ -80,6 +133,23 @@ static String buildJson(const CoolerState& s) {
         doc["compPower"]    = s.compPower;
         doc["compPowerMax"] = s.compPowerMax;
         doc["pmode"]        = s.pmode;
+        if (s.energyValid) {
+            JsonObject e = doc["energy"].to<JsonObject>();
+            e["compWh"]   = s.compWh;
+            e["totalWh"]  = s.totalWh;
+            e["runHours"] = s.runSeconds / 3600.0f;
+            e["starts"]   = s.starts;
+        }
+        if (s.cyclesValid) {
+            JsonObject c = doc["cycles"].to<JsonObject>();
+            c["lastOnS"]       = s.lastOnS;
+            c["lastOffS"]      = s.lastOffS;
+            c["startsPerHour"] = s.startsPerHour;
+            c["targetPerHour"] = s.targetPerHour;
+            c["restartOffset"] = s.restartOffset10 / 10.0f;
+            c["speedTrim"]     = s.speedTrim;
+            c["undershoot"]    = s.undershoot10 / 10.0f;
+        }
     } else {
         doc["error"] = "comms_fail";
     }
@@ -88,6 +158,60 @@ static String buildJson(const CoolerState& s) {
     return out;
 }
 
+static void perfStatJson(JsonObject o, const PerfStat& st) {
+    o["last"] = st.lastUs;
+    o["min"]  = st.minUs;
+    o["avg"]  = st.avgUs;
+    o["max"]  = st.maxUs;
+}
+
+static String buildPerfJson(const CoolerPerf& p) {
+    JsonDocument doc;
+    JsonObject perf = doc["perf"].to<JsonObject>();
+    if (p.valid) {
+        perf["tasks"]  = p.numTasks;
+        perf["probes"] = p.numProbes;
+        perfStatJson(perf["loop"].to<JsonObject>(), p.loop);
+        JsonArray hist = perf["hist"].to<JsonArray>();
+        for (uint8_t i = 0; i < PERF_HIST_BUCKETS; i++) hist.add(p.hist[i]);
+        JsonArray stages = perf["stages"].to<JsonArray>();
+        uint8_t n = p.numTasks + p.numProbes;
+        if (n > PERF_MAX_STAGES) n = PERF_MAX_STAGES;
+        for (uint8_t i = 0; i < n; i++) {
+            JsonObject o = stages.add<JsonObject>();
+            perfStatJson(o, p.stages[i]);
+            o["misses"] = p.stages[i].misses;
+        }
+    } else {
+        perf["error"] = "comms_fail";
+    }
+    String out;
+    serializeJson(doc, out);
+    return out;
+}
+
+// Entries newer than ?since=<number>, or all of them; oldest first
+static String buildHistoryJson(int32_t since) {
+    JsonDocument doc;
+    doc["period"] = HISTORY_PERIOD_S;
+    JsonArray arr = doc["history"].to<JsonArray>();
+    for (uint16_t i = 0; i < historyCount; i++) {
+        const HistoryEntry& e = history[(historyHead + i) % HISTORY_KEEP];
+        if (since >= 0 && (int16_t)(e.number - (uint16_t)since) <= 0) continue;
+        JsonObject o = arr.add<JsonObject>();
+        o["n"]       = e.number;
+        o["tempMin"] = e.tempMin2 / 2.0f;
+        o["temp"]    = e.tempAvg2 / 2.0f;
+        o["tempMax"] = e.tempMax2 / 2.0f;
+        o["duty"]    = e.duty;
+        o["power"]   = e.powerW;
+        o["voltage"] = e.voltage5 / 5.0f;
+    }
+    String out;
+    serializeJson(doc, out);
+    return out;
+}
+
 static void onWsEvent(AsyncWebSocket*, AsyncWebSocketClient*,
                       AwsEventType type, void* arg,
                       uint8_t* data, size_t len)
@@ -103,12 +227,23 @@ static void onWsEvent(AsyncWebSocket*, AsyncWebSocketClient*,
     const char* cmd = doc["cmd"] | "";
     int16_t     val = doc["value"] | 0;
 
-    if      (strcmp(cmd, "setTemp")     == 0) comms.setTargetTemp((int16_t)val);
-    else if (strcmp(cmd, "setPower")    == 0) comms.setCompPower((uint8_t)constrain(val, 0, 100));
-    else if (strcmp(cmd, "setPowerMax") == 0) comms.setCompPowerMax((uint8_t)constrain(val, 0, 100));
-    else if (strcmp(cmd, "setPMode")    == 0) comms.setPowerMode((uint8_t)constrain(val, 0, 2));
+    // Single settings, or {"cmd":"set", "temp":..., "power":..., "powerMax":..., "pmode":...}
+    SettingItem items[4];
+    uint8_t n = 0;
+    if      (strcmp(cmd, "setTemp")     == 0) items[n++] = { COMMS_CMD_SET_TEMP,  val };
+    else if (strcmp(cmd, "setPower")    == 0) items[n++] = { COMMS_CMD_SET_POWER, (int16_t)constrain(val, 0, 100) };
+    else if (strcmp(cmd, "setPowerMax") == 0) items[n++] = { COMMS_CMD_SET_PMAX,  (int16_t)constrain(val, 0, 100) };
+    else if (strcmp(cmd, "setPMode")    == 0) items[n++] = { COMMS_CMD_SET_PMODE, (int16_t)constrain(val, 0, 2) };
+    else if (strcmp(cmd, "set")         == 0) {
+        if (doc["temp"].is<int>())     items[n++] = { COMMS_CMD_SET_TEMP,  (int16_t)doc["temp"].as<int>() };
+        if (doc["power"].is<int>())    items[n++] = { COMMS_CMD_SET_POWER, (int16_t)constrain(doc["power"].as<int>(), 0, 100) };
+        if (doc["powerMax"].is<int>()) items[n++] = { COMMS_CMD_SET_PMAX,  (int16_t)constrain(doc["powerMax"].as<int>(), 0, 100) };
+        if (doc["pmode"].is<int>())    items[n++] = { COMMS_CMD_SET_PMODE, (int16_t)constrain(doc["pmode"].as<int>(), 0, 2) };
+    }
+    if (n == 0 || flashBusy) return;
 
-    if (!flashBusy && comms.readAll(coolerState)) ws.textAll(buildJson(coolerState));
+    // With protocol v2 the write and the fresh telemetry are one transaction
+    if (comms.applySettings(items, n, coolerState)) ws.textAll(buildJson(coolerState));
 }
 
 static void wifiSetup() {
@@ -129,6 +264,13 @@ static void wifiSetup() {
     server.on("/api/state", HTTP_GET, [](AsyncWebServerRequest* req) {
         req->send(200, "application/json", buildJson(coolerState));
     });
+    server.on("/api/perf", HTTP_GET, [](AsyncWebServerRequest* req) {
+        req->send(200, "application/json", buildPerfJson(coolerPerf));
+    });
+    server.on("/api/history", HTTP_GET, [](AsyncWebServerRequest* req) {
+        int32_t since = req->hasParam("since") ? req->getParam("since")->value().toInt() : -1;
+        req->send(200, "application/json", buildHistoryJson(since));
+    });
 
     // Flash endpoint: POST /api/flash with raw Intel HEX body (text/plain or
     // application/octet-stream). Maximum accepted body: 48 KB (covers the full
@@ -175,6 +317,7 @@ static void wifiSetup() {
 
             // Re-initialise comms after programmer released the bus
             comms.begin(COMMS_DATA_PIN, COMMS_BAUD);
+            protocolChecked = false;     // the new firmware may speak another version
 
             // Free HEX buffer
             free(job->buf);
@@ -242,6 +385,26 @@ static inline void wifiNotify(const CoolerState& s) {
     if (ws.count() > 0) ws.textAll(buildJson(s));
 }
 
+static inline void wifiNotifyPerf(const CoolerPerf& p) {
+    if (ws.count() > 0) ws.textAll(buildPerfJson(p));
+}
+
+static void wifiNotifyEvents(const CoolerEvent* ev, uint8_t count, uint8_t lost) {
+    static const char* const names[] = { "", "setpoint", "power", "battlow", "compressor", "keys", "motor", "supply_r" };
+    if (ws.count() == 0) return;
+    JsonDocument doc;
+    JsonArray arr = doc["events"].to<JsonArray>();
+    for (uint8_t i = 0; i < count; i++) {
+        JsonObject o = arr.add<JsonObject>();
+        o["type"] = ev[i].type < sizeof(names) / sizeof(names[0]) ? names[ev[i].type] : "unknown";
+        o["value"] = ev[i].type == EVENT_SETPOINT ? (int)(int8_t)ev[i].arg : (int)ev[i].arg;
+    }
+    if (lost) doc["lost"] = lost;
+    String out;
+    serializeJson(doc, out);
+    ws.textAll(out);
+}
+
 #endif  // TRANSPORT_WIFI
 
 // ══════════════════════════════════════════════════════════════════════════════
@@ -265,12 +428,16 @@ static inline void wifiNotify(const CoolerState& s) {
 #define BLE_CMD_PWR_UUID   "beb54840-36e1-4688-b7f5-ea07361b26a8"  // uint8 (0-100)
 #define BLE_CMD_PMAX_UUID  "beb54841-36e1-4688-b7f5-ea07361b26a8"  // uint8 (0-100)
 #define BLE_CMD_PMODE_UUID "beb54842-36e1-4688-b7f5-ea07361b26a8"  // uint8 (0-2)
+// Energy characteristic (READ + NOTIFY): 16-byte little-endian payload
+//   [0-3] uint32 compWh  [4-7] uint32 totalWh  [8-11] uint32 runSeconds  [12-15] uint32 starts
+#define BLE_ENERGY_UUID    "beb54843-36e1-4688-b7f5-ea07361b26a8"
 
 static NimBLECharacteristic* bleStatusChar    = nullptr;
 static NimBLECharacteristic* bleCmdTempChar   = nullptr;
 static NimBLECharacteristic* bleCmdPwrChar    = nullptr;
 static NimBLECharacteristic* bleCmdPMaxChar   = nullptr;
 static NimBLECharacteristic* bleCmdPModeChar  = nullptr;
+static NimBLECharacteristic* bleEnergyChar    = nullptr;
 
 static void blePackAndNotify(const CoolerState& s) {
     if (!s.valid || !bleStatusChar) return;
@@ -286,20 +453,34 @@ static void blePackAndNotify(const CoolerState& s) {
     bleStatusChar->notify();
 }
 
+static void blePackAndNotifyEnergy(const CoolerState& s) {
+    if (!s.energyValid || !bleEnergyChar) return;
+    uint8_t buf[16];
+    memcpy(buf + 0,  &s.compWh,     4);
+    memcpy(buf + 4,  &s.totalWh,    4);
+    memcpy(buf + 8,  &s.runSeconds, 4);
+    memcpy(buf + 12, &s.starts,     4);
+    bleEnergyChar->setValue(buf, sizeof(buf));
+    bleEnergyChar->notify();
+}
+
 class BleCmdCallback : public NimBLECharacteristicCallbacks {
     void onWrite(NimBLECharacteristic* pChar, NimBLEConnInfo&) override {
         auto val = pChar->getValue();
+        SettingItem item;
         if (pChar == bleCmdTempChar && val.size() >= 2) {
             int16_t v; memcpy(&v, val.data(), 2);
-            comms.setTargetTemp(v);
+            item = { COMMS_CMD_SET_TEMP, v };
         } else if (pChar == bleCmdPwrChar && val.size() >= 1) {
-            comms.setCompPower((uint8_t)constrain((int)val[0], 0, 100));
+            item = { COMMS_CMD_SET_POWER, (int16_t)constrain((int)val[0], 0, 100) };
         } else if (pChar == bleCmdPMaxChar && val.size() >= 1) {
-            comms.setCompPowerMax((uint8_t)constrain((int)val[0], 0, 100));
+            item = { COMMS_CMD_SET_PMAX, (int16_t)constrain((int)val[0], 0, 100) };
         } else if (pChar == bleCmdPModeChar && val.size() >= 1) {
-            comms.setPowerMode((uint8_t)constrain((int)val[0], 0, 2));
+            item = { COMMS_CMD_SET_PMODE, (int16_t)constrain((int)val[0], 0, 2) };
+        } else {
+            return;
         }
-        if (comms.readAll(coolerState)) blePackAndNotify(coolerState);
+        if (comms.applySettings(&item, 1, coolerState)) blePackAndNotify(coolerState);
     }
 };
 static BleCmdCallback bleCmdCb;
@@ -342,6 +523,9 @@ static void bleSetup() {
         NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR);
     bleCmdPModeChar->setCallbacks(&bleCmdCb);
 
+    bleEnergyChar = pSvc->createCharacteristic(BLE_ENERGY_UUID,
+        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
+
     pSvc->start();
 
     NimBLEAdvertising* pAdv = NimBLEDevice::getAdvertising();
@@ -353,6 +537,25 @@ static void bleSetup() {
 
 #endif  // TRANSPORT_BLE
 
+// ── PIC events ─────────────────────────────────────────────────────────────
+// Any v2 answer flags queued events; fetch them straight away so keypad
+// changes, battery cut-outs and compressor transitions go out with the poll
+// that noticed them.  The state push that follows carries their effect.
+static void eventsSync() {
+    CoolerEvent ev[EVENTS_PER_RESPONSE];
+    uint8_t count, lost;
+    for (uint8_t round = 0; round < 4 && comms.eventsPending(); round++) {
+        if (!comms.readEvents(ev, count, lost)) return;
+        for (uint8_t i = 0; i < count; i++) {
+            Serial.printf("[FR34] Event %u, %u\n", ev[i].type, ev[i].arg);
+        }
+        if (lost) Serial.printf("[FR34] %u events lost\n", lost);
+#ifdef TRANSPORT_WIFI
+        wifiNotifyEvents(ev, count, lost);
+#endif
+    }
+}
+
 // ── Arduino setup / loop ───────────────────────────────────────────────────
 void setup() {
     Serial.begin(115200);
@@ -384,10 +587,20 @@ void loop() {
     ws.cleanupClients();
 #endif
 
+    comms.service();
     uint32_t now = millis();
-    if (!flashBusy && now - lastPoll >= POLL_MS) {
+    if (!flashBusy && !comms.busy() && now - lastPoll >= POLL_MS) {
         lastPoll = now;
-        if (comms.readAll(coolerState)) {
+        if (comms.readDelta(coolerState)) {
+            // begin() may have asked before the PIC was listening; a faster
+            // link that was lost is stepped up again once the PIC answers
+            if (!protocolChecked || comms.linkDropped()) {
+                protocolChecked = true;
+                if (!comms.isV2() || comms.baud() == COMMS_BAUD) comms.negotiate();
+                Serial.printf("[FR34] Link protocol v%u, %lu baud\n",
+                              comms.isV2() ? 2 : 1, (unsigned long)comms.baud());
+            }
+            if (comms.eventsPending()) eventsSync();
 #ifdef TRANSPORT_WIFI
             wifiNotify(coolerState);
 #endif
@@ -402,4 +615,34 @@ void loop() {
 #endif
         }
     }
+
+    // Energy counters move by whole Wh; the next status push carries them
+    if (!flashBusy && coolerState.valid && now - lastEnergyPoll >= ENERGY_POLL_MS) {
+        lastEnergyPoll = now;
+        if (comms.readEnergy(coolerState)) {
+#ifdef TRANSPORT_BLE
+            blePackAndNotifyEnergy(coolerState);
+#endif
+        }
+        comms.readCycles(coolerState);
+    }
+
+    // The PIC aggregates per 5 minutes; after an outage one sync backfills its ring
+    if (!flashBusy && coolerState.valid && now - lastHistoryPoll >= HISTORY_POLL_MS) {
+        lastHistoryPoll = now;
+        historySync();
+    }
+
+    // Firmware timing is slow-moving and costs up to 10 round trips: poll it
+    // rarely, and only while the link is otherwise healthy.
+    if (!flashBusy && coolerState.valid && now - lastPerfPoll >= PERF_POLL_MS) {
+        lastPerfPoll = now;
+        if (comms.readPerf(coolerPerf)) {
+            Serial.printf("[FR34] Loop busy avg %u us, max %u us\n",
+                          coolerPerf.loop.avgUs, coolerPerf.loop.maxUs);
+        }
+#ifdef TRANSPORT_WIFI
+        wifiNotifyPerf(coolerPerf);
+#endif
+    }
 }
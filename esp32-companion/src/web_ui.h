@@ -186,6 +186,20 @@ body{margin:0}
       </p>
     </div>
 
+    <!-- Energy -->
+    <div class="card rounded-xl p-5" v-if="state.energy">
+      <div class="flex items-center justify-between mb-3">
+        <span class="font-semibold">Energy</span>
+        <span class="text-sm text-slate-400">since first boot</span>
+      </div>
+      <div class="grid grid-cols-2 gap-3 text-sm">
+        <div><div class="text-slate-400 text-xs">Compressor</div>{{ state.energy.compWh }} Wh</div>
+        <div><div class="text-slate-400 text-xs">Total</div>{{ state.energy.totalWh }} Wh</div>
+        <div><div class="text-slate-400 text-xs">Run time</div>{{ fmt1(state.energy.runHours) }} h</div>
+        <div><div class="text-slate-400 text-xs">Starts</div>{{ state.energy.starts }}</div>
+      </div>
+    </div>
+
     <!-- Power Mode -->
     <div class="card rounded-xl p-5">
       <div class="flex items-center justify-between mb-3">
@@ -203,6 +217,41 @@ body{margin:0}
       </p>
     </div>
 
+    <!-- Firmware Timing -->
+    <div class="card rounded-xl p-5">
+      <div class="flex items-center justify-between mb-3">
+        <span class="font-semibold">Firmware Timing</span>
+        <span class="text-sm text-slate-400" v-if="perf">
+          loop {{ perf.loop.avg }} / {{ perf.loop.max }} &micro;s
+        </span>
+      </div>
+      <div v-if="perf">
+        <div class="flex items-end gap-1 h-12 mb-1">
+          <div v-for="(n, i) in perf.hist" :key="i" class="flex-1 bg-sky-500 rounded-t"
+               :style="{ height: histHeight(n) + '%' }" :title="histLabel(i) + ': ' + n"></div>
+        </div>
+        <div class="flex gap-1 text-[10px] text-slate-500 mb-3">
+          <span v-for="(n, i) in perf.hist" :key="i" class="flex-1 text-center">{{ histLabel(i) }}</span>
+        </div>
+        <table class="w-full text-xs">
+          <tr class="text-slate-500">
+            <th class="text-left font-normal">Stage</th>
+            <th class="text-right font-normal">avg</th>
+            <th class="text-right font-normal">max</th>
+            <th class="text-right font-normal">misses</th>
+          </tr>
+          <tr v-for="(s, i) in perf.stages" :key="i">
+            <td>{{ stageName(i) }}</td>
+            <td class="text-right">{{ s.avg }}</td>
+            <td class="text-right">{{ s.max }}</td>
+            <td class="text-right">{{ i < perf.tasks ? s.misses : '' }}</td>
+          </tr>
+        </table>
+        <p class="text-xs text-slate-500 mt-2">Times in &micro;s, refreshed every 10 s.</p>
+      </div>
+      <p v-else class="text-xs text-slate-500">Waiting for timing data&hellip;</p>
+    </div>
+
     <!-- Flash Firmware -->
     <div class="card rounded-xl p-5">
       <div class="flex items-center justify-between mb-3">
@@ -272,7 +321,8 @@ createApp({
       temp: null, setpoint: null,
       voltage: null, fanCurrent: null,
       compPower: null, compPowerMax: null,
-      pmode: null
+      pmode: null,
+      energy: null
     });
 
     const connected   = ref(false);
@@ -290,6 +340,17 @@ createApp({
     const flashPct    = ref(0);
     const flashError  = ref('');
 
+    // ── Firmware timing ──────────────────────────────────────────────────
+    // Stage order follows the task table in main.c, then the probes
+    const STAGE_NAMES = ['comms', 'analog', 'keys', 'control', 'display', 'panel', 'motor ack'];
+    const perf = ref(null);
+    const stageName  = (i) => STAGE_NAMES[i] ?? ('stage ' + i);
+    const histLabel  = (i) => i === 7 ? '16+ms' : ('<' + ((256 << i) / 1000).toFixed(i < 2 ? 1 : 0) + 'ms');
+    const histHeight = (n) => {
+      const peak = Math.max(...perf.value.hist, 1);
+      return n ? Math.max(4, Math.round(100 * n / peak)) : 0;
+    };
+
     // ── WebSocket ─────────────────────────────────────────────────────────
     let ws = null;
     let reconnectTimer = null;
@@ -318,6 +379,12 @@ createApp({
             return;
           }
 
+          // Timing snapshot, sent every PERF_POLL_MS
+          if (d.perf) {
+            perf.value = d.perf.error ? null : d.perf;
+            return;
+          }
+
           // temperatures come as tenths of °C from ESP32
           state.value.temp       = d.temp      ?? null;
           state.value.setpoint   = d.setpoint  ?? null;
@@ -326,6 +393,7 @@ createApp({
           state.value.compPower  = d.compPower ?? null;
           state.value.compPowerMax = d.compPowerMax ?? null;
           state.value.pmode      = d.pmode ?? null;
+          state.value.energy     = d.energy ?? state.value.energy;
 
           // Sync sliders only when the server sends fresh values
           // (avoid overwriting while the user is dragging)
@@ -475,7 +543,9 @@ createApp({
       hexFileName, hexFileData, hexInput,
       flashState, flashPct, flashError,
       flashBtnLabel, flashBtnClass, flashStatusLabel,
-      onHexFile, flashPic
+      onHexFile, flashPic,
+      // timing
+      perf, stageName, histLabel, histHeight
     };
   }
 }).mount('#app');